@@ -0,0 +1,1030 @@
+#include "PostgresLibpq.h"
+#include <QByteArray>
+#include <QDate>
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QStringList>
+#include <QTime>
+#include <QTimeZone>
+#include <QUuid>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+namespace Sofa::Addons::Postgres {
+namespace {
+
+// Built-in type OIDs (see pg_type.dat); stable across server versions.
+constexpr Oid kBoolOid = 16;
+constexpr Oid kByteaOid = 17;
+constexpr Oid kCharOid = 18;
+constexpr Oid kNameOid = 19;
+constexpr Oid kInt8Oid = 20;
+constexpr Oid kInt2Oid = 21;
+constexpr Oid kInt4Oid = 23;
+constexpr Oid kTextOid = 25;
+constexpr Oid kOidOid = 26;
+constexpr Oid kXidOid = 28;
+constexpr Oid kCidOid = 29;
+constexpr Oid kJsonOid = 114;
+constexpr Oid kXmlOid = 142;
+constexpr Oid kJsonArrayOid = 199;
+constexpr Oid kCidrOid = 650;
+constexpr Oid kFloat4Oid = 700;
+constexpr Oid kFloat8Oid = 701;
+constexpr Oid kUnknownOid = 705;
+constexpr Oid kMoneyOid = 790;
+constexpr Oid kInetOid = 869;
+constexpr Oid kBoolArrayOid = 1000;
+constexpr Oid kInt2ArrayOid = 1005;
+constexpr Oid kInt4ArrayOid = 1007;
+constexpr Oid kTextArrayOid = 1009;
+constexpr Oid kVarcharArrayOid = 1015;
+constexpr Oid kInt8ArrayOid = 1016;
+constexpr Oid kFloat4ArrayOid = 1021;
+constexpr Oid kFloat8ArrayOid = 1022;
+constexpr Oid kBpcharOid = 1042;
+constexpr Oid kVarcharOid = 1043;
+constexpr Oid kDateOid = 1082;
+constexpr Oid kTimeOid = 1083;
+constexpr Oid kTimestampOid = 1114;
+constexpr Oid kTimestamptzOid = 1184;
+constexpr Oid kIntervalOid = 1186;
+constexpr Oid kNumericArrayOid = 1231;
+constexpr Oid kTimetzOid = 1266;
+constexpr Oid kNumericOid = 1700;
+constexpr Oid kUuidOid = 2950;
+constexpr Oid kUuidArrayOid = 2951;
+constexpr Oid kJsonbOid = 3802;
+constexpr Oid kJsonbArrayOid = 3807;
+
+// Postgres binary dates/timestamps count from 2000-01-01.
+constexpr qint64 kPostgresEpochMsecs = 946684800000LL;
+constexpr qint64 kMicrosPerDay = 86400000000LL;
+
+template <typename T>
+T readBigEndian(const char* data)
+{
+    return qFromBigEndian<T>(reinterpret_cast<const uchar*>(data));
+}
+
+QVariant decodeBool(const char* data, int length)
+{
+    return length > 0 ? QVariant(data[0] != 0) : QVariant();
+}
+
+QVariant decodeBytea(const char* data, int length)
+{
+    return QByteArray(data, length);
+}
+
+QVariant decodeText(const char* data, int length)
+{
+    return QString::fromUtf8(data, length);
+}
+
+QVariant decodeChar(const char* data, int length)
+{
+    return length > 0 ? QString(QLatin1Char(data[0])) : QString();
+}
+
+QVariant decodeJsonb(const char* data, int length)
+{
+    // jsonb binary format is a version byte (1) followed by the text form.
+    if (length < 1) return QString();
+    return QString::fromUtf8(data + 1, length - 1);
+}
+
+QVariant decodeInt2(const char* data, int length)
+{
+    if (length != 2) return QVariant();
+    return static_cast<int>(readBigEndian<qint16>(data));
+}
+
+QVariant decodeInt4(const char* data, int length)
+{
+    if (length != 4) return QVariant();
+    return static_cast<int>(readBigEndian<qint32>(data));
+}
+
+QVariant decodeInt8(const char* data, int length)
+{
+    if (length != 8) return QVariant();
+    return static_cast<qlonglong>(readBigEndian<qint64>(data));
+}
+
+QVariant decodeUInt4(const char* data, int length)
+{
+    if (length != 4) return QVariant();
+    return static_cast<uint>(readBigEndian<quint32>(data));
+}
+
+QVariant decodeFloat4(const char* data, int length)
+{
+    if (length != 4) return QVariant();
+    const quint32 bits = readBigEndian<quint32>(data);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return static_cast<double>(value);
+}
+
+QVariant decodeFloat8(const char* data, int length)
+{
+    if (length != 8) return QVariant();
+    const quint64 bits = readBigEndian<quint64>(data);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+QVariant decodeDate(const char* data, int length)
+{
+    if (length != 4) return QVariant();
+    const qint32 days = readBigEndian<qint32>(data);
+    if (days == std::numeric_limits<qint32>::max()) return QStringLiteral("infinity");
+    if (days == std::numeric_limits<qint32>::min()) return QStringLiteral("-infinity");
+    return QDate(2000, 1, 1).addDays(days);
+}
+
+QVariant decodeTime(const char* data, int length)
+{
+    // time is 8 bytes of microseconds; timetz appends a 4-byte zone offset we ignore like QPSQL does.
+    if (length != 8 && length != 12) return QVariant();
+    const qint64 micros = readBigEndian<qint64>(data);
+    return QTime::fromMSecsSinceStartOfDay(static_cast<int>(micros / 1000));
+}
+
+bool decodeTimestampParts(const char* data, int length, qint64* micros, QVariant* special)
+{
+    if (length != 8) {
+        *special = QVariant();
+        return false;
+    }
+    *micros = readBigEndian<qint64>(data);
+    if (*micros == std::numeric_limits<qint64>::max()) {
+        *special = QStringLiteral("infinity");
+        return false;
+    }
+    if (*micros == std::numeric_limits<qint64>::min()) {
+        *special = QStringLiteral("-infinity");
+        return false;
+    }
+    return true;
+}
+
+QVariant decodeTimestamp(const char* data, int length)
+{
+    // Wall-clock value: keep the fields as-is in local time, as QPSQL does.
+    qint64 micros = 0;
+    QVariant special;
+    if (!decodeTimestampParts(data, length, &micros, &special)) return special;
+    qint64 days = micros / kMicrosPerDay;
+    qint64 rem = micros % kMicrosPerDay;
+    if (rem < 0) {
+        rem += kMicrosPerDay;
+        days -= 1;
+    }
+    return QDateTime(QDate(2000, 1, 1).addDays(days), QTime::fromMSecsSinceStartOfDay(static_cast<int>(rem / 1000)));
+}
+
+QVariant decodeTimestamptz(const char* data, int length)
+{
+    qint64 micros = 0;
+    QVariant special;
+    if (!decodeTimestampParts(data, length, &micros, &special)) return special;
+    // Local time, as QPSQL returns timestamptz values.
+    return QDateTime::fromMSecsSinceEpoch(kPostgresEpochMsecs + micros / 1000, QTimeZone::utc()).toLocalTime();
+}
+
+QVariant decodeInterval(const char* data, int length)
+{
+    if (length != 16) return QVariant();
+    qint64 micros = readBigEndian<qint64>(data);
+    const qint32 days = readBigEndian<qint32>(data + 8);
+    const qint32 months = readBigEndian<qint32>(data + 12);
+
+    // Mirrors the server's default "postgres" IntervalStyle.
+    QStringList parts;
+    const qint32 years = months / 12;
+    const qint32 mons = months % 12;
+    if (years != 0) parts << QString("%1 year%2").arg(years).arg(qAbs(years) == 1 ? "" : "s");
+    if (mons != 0) parts << QString("%1 mon%2").arg(mons).arg(qAbs(mons) == 1 ? "" : "s");
+    if (days != 0) parts << QString("%1 day%2").arg(days).arg(qAbs(days) == 1 ? "" : "s");
+    if (micros != 0 || parts.isEmpty()) {
+        const bool negative = micros < 0;
+        if (negative) micros = -micros;
+        const qint64 hours = micros / 3600000000LL;
+        const qint64 minutes = (micros / 60000000LL) % 60;
+        const qint64 seconds = (micros / 1000000LL) % 60;
+        const qint64 fraction = micros % 1000000LL;
+        QString time = QString("%1%2:%3:%4")
+                           .arg(negative ? "-" : "")
+                           .arg(hours, 2, 10, QLatin1Char('0'))
+                           .arg(minutes, 2, 10, QLatin1Char('0'))
+                           .arg(seconds, 2, 10, QLatin1Char('0'));
+        if (fraction != 0) {
+            QString frac = QString("%1").arg(fraction, 6, 10, QLatin1Char('0'));
+            while (frac.endsWith('0')) frac.chop(1);
+            time += "." + frac;
+        }
+        parts << time;
+    }
+    return parts.join(' ');
+}
+
+QVariant decodeNumeric(const char* data, int length)
+{
+    if (length < 8) return QVariant();
+    const int ndigits = readBigEndian<qint16>(data);
+    const int weight = readBigEndian<qint16>(data + 2);
+    const quint16 sign = readBigEndian<quint16>(data + 4);
+    const int dscale = readBigEndian<qint16>(data + 6);
+    if (sign == 0xC000) return QStringLiteral("NaN");
+    if (sign == 0xD000) return QStringLiteral("Infinity");
+    if (sign == 0xF000) return QStringLiteral("-Infinity");
+    if (length < 8 + ndigits * 2) return QVariant();
+
+    auto digitAt = [&](int index) -> int {
+        if (index < 0 || index >= ndigits) return 0;
+        return readBigEndian<qint16>(data + 8 + index * 2);
+    };
+
+    // Kept as text so values wider than a double survive the round trip.
+    QString out;
+    if (sign == 0x4000) out += '-';
+    if (weight < 0) {
+        out += '0';
+    } else {
+        for (int d = 0; d <= weight; ++d) {
+            const int dig = digitAt(d);
+            if (d == 0) {
+                out += QString::number(dig);
+            } else {
+                out += QString("%1").arg(dig, 4, 10, QLatin1Char('0'));
+            }
+        }
+    }
+    if (dscale > 0) {
+        QString fraction;
+        for (int d = weight + 1; fraction.size() < dscale; ++d) {
+            fraction += QString("%1").arg(digitAt(d), 4, 10, QLatin1Char('0'));
+        }
+        out += '.';
+        out += fraction.left(dscale);
+    }
+    return out;
+}
+
+QVariant decodeMoney(const char* data, int length)
+{
+    // Assumes the common two-fraction-digit lc_monetary.
+    if (length != 8) return QVariant();
+    const qint64 cents = readBigEndian<qint64>(data);
+    const qint64 absCents = cents < 0 ? -cents : cents;
+    return QString("%1%2.%3").arg(cents < 0 ? "-" : "").arg(absCents / 100).arg(absCents % 100, 2, 10, QLatin1Char('0'));
+}
+
+QVariant decodeUuid(const char* data, int length)
+{
+    if (length != 16) return QVariant();
+    return QUuid::fromRfc4122(QByteArray::fromRawData(data, length)).toString(QUuid::WithoutBraces);
+}
+
+QVariant decodeInet(const char* data, int length)
+{
+    // family, bits, is_cidr, address length, address bytes.
+    if (length < 4) return QVariant();
+    const int family = static_cast<uchar>(data[0]);
+    const int bits = static_cast<uchar>(data[1]);
+    const bool isCidr = data[2] != 0;
+    const int addrLength = static_cast<uchar>(data[3]);
+    if (length < 4 + addrLength) return QVariant();
+    const uchar* addr = reinterpret_cast<const uchar*>(data + 4);
+
+    QString text;
+    if (addrLength == 4) {
+        text = QString("%1.%2.%3.%4").arg(addr[0]).arg(addr[1]).arg(addr[2]).arg(addr[3]);
+    } else {
+        QStringList groups;
+        for (int i = 0; i + 1 < addrLength; i += 2) {
+            groups << QString::number((addr[i] << 8) | addr[i + 1], 16);
+        }
+        text = groups.join(':');
+    }
+    const int maxBits = addrLength * 8;
+    Q_UNUSED(family);
+    if (isCidr || bits != maxBits) {
+        text += "/" + QString::number(bits);
+    }
+    return text;
+}
+
+QString quoteArrayElement(const QString& value)
+{
+    if (value.isEmpty() || value.compare("NULL", Qt::CaseInsensitive) == 0) {
+        return "\"" + value + "\"";
+    }
+    static const QString special = QStringLiteral("{},\"\\ \t\n\r");
+    for (const QChar ch : value) {
+        if (special.contains(ch)) {
+            QString escaped = value;
+            escaped.replace("\\", "\\\\").replace("\"", "\\\"");
+            return "\"" + escaped + "\"";
+        }
+    }
+    return value;
+}
+
+QVariant decodeArray(const char* data, int length)
+{
+    // Rendered in the server's text form ({a,b}) since that is what QPSQL returns.
+    if (length < 12) return QVariant();
+    const int ndim = readBigEndian<qint32>(data);
+    const Oid elementType = readBigEndian<quint32>(data + 8);
+    if (ndim == 0) return QStringLiteral("{}");
+    if (ndim < 0 || ndim > 6 || length < 12 + ndim * 8) return QVariant();
+
+    std::vector<int> dims(ndim);
+    qint64 total = 1;
+    for (int i = 0; i < ndim; ++i) {
+        dims[i] = readBigEndian<qint32>(data + 12 + i * 8);
+        total *= dims[i];
+    }
+
+    const ValueDecoder elementDecoder = binaryDecoderFor(elementType);
+    const char* cursor = data + 12 + ndim * 8;
+    const char* end = data + length;
+    QStringList elements;
+    elements.reserve(static_cast<int>(total));
+    for (qint64 i = 0; i < total; ++i) {
+        if (cursor + 4 > end) return QVariant();
+        const qint32 elementLength = readBigEndian<qint32>(cursor);
+        cursor += 4;
+        if (elementLength < 0) {
+            elements << QStringLiteral("NULL");
+            continue;
+        }
+        if (cursor + elementLength > end) return QVariant();
+        const QVariant value = elementDecoder(cursor, elementLength);
+        cursor += elementLength;
+        QString text;
+        if (value.typeId() == QMetaType::Bool) {
+            text = value.toBool() ? "t" : "f";
+        } else {
+            text = value.toString();
+        }
+        elements << quoteArrayElement(text);
+    }
+
+    // Fold the flat element list back into nested braces, innermost dimension first.
+    for (int dim = ndim - 1; dim >= 0; --dim) {
+        QStringList grouped;
+        const int size = dims[dim];
+        for (int i = 0; i < elements.size(); i += size) {
+            grouped << "{" + elements.mid(i, size).join(',') + "}";
+        }
+        elements = grouped;
+    }
+    return elements.value(0);
+}
+
+QVariant decodeFallback(const char* data, int length)
+{
+    // Types without a dedicated decoder (enums, citext, ...) usually send text.
+    const QByteArray raw = QByteArray::fromRawData(data, length);
+    QString text = QString::fromUtf8(raw);
+    bool printable = !text.contains(QChar::ReplacementCharacter);
+    for (int i = 0; printable && i < text.size(); ++i) {
+        const QChar ch = text.at(i);
+        printable = !(ch.unicode() < 0x20 && ch != '\n' && ch != '\r' && ch != '\t');
+    }
+    if (printable) {
+        return text;
+    }
+    return QString("\\x") + QString::fromLatin1(raw.toHex());
+}
+
+
+// --- Text format ---
+
+QVariant textOrString(const char* data, int length, const QVariant& parsed, bool ok)
+{
+    return ok ? parsed : QVariant(QString::fromUtf8(data, length));
+}
+
+QVariant decodeTextBool(const char* data, int length)
+{
+    return length > 0 ? QVariant(data[0] == 't') : QVariant();
+}
+
+QVariant decodeTextInt(const char* data, int length)
+{
+    bool ok = false;
+    const int value = QByteArray::fromRawData(data, length).toInt(&ok);
+    return textOrString(data, length, value, ok);
+}
+
+QVariant decodeTextInt8(const char* data, int length)
+{
+    bool ok = false;
+    const qlonglong value = QByteArray::fromRawData(data, length).toLongLong(&ok);
+    return textOrString(data, length, value, ok);
+}
+
+QVariant decodeTextUInt(const char* data, int length)
+{
+    bool ok = false;
+    const uint value = QByteArray::fromRawData(data, length).toUInt(&ok);
+    return textOrString(data, length, value, ok);
+}
+
+QVariant decodeTextDouble(const char* data, int length)
+{
+    bool ok = false;
+    const double value = QByteArray::fromRawData(data, length).toDouble(&ok);
+    return textOrString(data, length, value, ok);
+}
+
+QVariant decodeTextBytea(const char* data, int length)
+{
+    // bytea_output = hex: "\x" followed by two hex digits per byte.
+    if (length >= 2 && data[0] == '\\' && data[1] == 'x') {
+        return QByteArray::fromHex(QByteArray::fromRawData(data + 2, length - 2));
+    }
+    return QByteArray(data, length);
+}
+
+QVariant decodeTextDate(const char* data, int length)
+{
+    const QString text = QString::fromUtf8(data, length);
+    const QDate date = QDate::fromString(text, Qt::ISODate);
+    return date.isValid() ? QVariant(date) : QVariant(text);
+}
+
+QVariant decodeTextTime(const char* data, int length)
+{
+    QString text = QString::fromUtf8(data, length);
+    static const QRegularExpression zoneOffset("[+-]");
+    const int zone = text.indexOf(zoneOffset);
+    if (zone > 0) text.truncate(zone);
+    const QTime time = QTime::fromString(text, Qt::ISODateWithMs);
+    return time.isValid() ? QVariant(time) : QVariant(QString::fromUtf8(data, length));
+}
+
+QVariant decodeTextTimestamp(const char* data, int length)
+{
+    // ISO DateStyle: "2024-01-31 10:00:00.123+00"; Qt wants 'T' and a full "+HH:MM" offset.
+    const QString text = QString::fromUtf8(data, length);
+    QString iso = text;
+    iso.replace(' ', 'T');
+    static const QRegularExpression shortOffset("[+-]\\d\\d$");
+    if (shortOffset.match(iso).hasMatch()) {
+        iso += ":00";
+    }
+    const QDateTime value = QDateTime::fromString(iso, Qt::ISODateWithMs);
+    if (!value.isValid()) {
+        return text;
+    }
+    // timestamptz (it carries an offset) in local time, like the binary path and QPSQL.
+    return value.timeSpec() == Qt::OffsetFromUTC || value.timeSpec() == Qt::UTC ? QVariant(value.toLocalTime()) : QVariant(value);
+}
+
+
+// --- Columnar appenders ---
+
+void appendBinaryBool(ColumnData& column, const char* data, int length)
+{
+    if (length < 1) {
+        column.appendNull();
+    } else {
+        column.appendBool(data[0] != 0);
+    }
+}
+
+void appendBinaryInt2(ColumnData& column, const char* data, int length)
+{
+    if (length != 2) {
+        column.appendNull();
+    } else {
+        column.appendInt64(readBigEndian<qint16>(data));
+    }
+}
+
+void appendBinaryInt4(ColumnData& column, const char* data, int length)
+{
+    if (length != 4) {
+        column.appendNull();
+    } else {
+        column.appendInt64(readBigEndian<qint32>(data));
+    }
+}
+
+void appendBinaryInt8(ColumnData& column, const char* data, int length)
+{
+    if (length != 8) {
+        column.appendNull();
+    } else {
+        column.appendInt64(readBigEndian<qint64>(data));
+    }
+}
+
+void appendBinaryUInt4(ColumnData& column, const char* data, int length)
+{
+    if (length != 4) {
+        column.appendNull();
+    } else {
+        column.appendInt64(readBigEndian<quint32>(data));
+    }
+}
+
+void appendBinaryFloat4(ColumnData& column, const char* data, int length)
+{
+    if (length != 4) {
+        column.appendNull();
+        return;
+    }
+    const quint32 bits = readBigEndian<quint32>(data);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    column.appendDouble(value);
+}
+
+void appendBinaryFloat8(ColumnData& column, const char* data, int length)
+{
+    if (length != 8) {
+        column.appendNull();
+        return;
+    }
+    const quint64 bits = readBigEndian<quint64>(data);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    column.appendDouble(value);
+}
+
+void appendUtf8(ColumnData& column, const char* data, int length)
+{
+    column.appendUtf8(data, length);
+}
+
+void appendBinaryJsonb(ColumnData& column, const char* data, int length)
+{
+    // Version byte first, as in decodeJsonb.
+    column.appendUtf8(data + (length > 0 ? 1 : 0), length > 0 ? length - 1 : 0);
+}
+
+void appendTextBool(ColumnData& column, const char* data, int length)
+{
+    if (length < 1) {
+        column.appendNull();
+    } else {
+        column.appendBool(data[0] == 't');
+    }
+}
+
+void appendTextInt(ColumnData& column, const char* data, int length)
+{
+    bool ok = false;
+    const qlonglong value = QByteArray::fromRawData(data, length).toLongLong(&ok);
+    if (ok) {
+        column.appendInt64(value);
+    } else {
+        // Kept as text like textOrString(); the column falls back to QVariants.
+        column.appendValue(QString::fromUtf8(data, length));
+    }
+}
+
+void appendTextDouble(ColumnData& column, const char* data, int length)
+{
+    bool ok = false;
+    const double value = QByteArray::fromRawData(data, length).toDouble(&ok);
+    if (ok) {
+        column.appendDouble(value);
+    } else {
+        column.appendValue(QString::fromUtf8(data, length));
+    }
+}
+
+}
+
+PGconn* nativeHandle(const QString& connectionName)
+{
+    if (connectionName.isEmpty()) return nullptr;
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    if (!db.isOpen() || !db.driver()) return nullptr;
+    const QVariant handle = db.driver()->handle();
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "PGconn*") != 0) return nullptr;
+    return *static_cast<PGconn* const*>(handle.constData());
+}
+
+PGconn* idleHandle(const QString& connectionName)
+{
+    PGconn* conn = nativeHandle(connectionName);
+    if (conn && PQtransactionStatus(conn) == PQTRANS_ACTIVE) {
+        while (PGresult* result = PQgetResult(conn)) {
+            PQclear(result);
+        }
+    }
+    return conn;
+}
+
+ValueDecoder binaryDecoderFor(Oid type)
+{
+    switch (type) {
+    case kBoolOid: return decodeBool;
+    case kByteaOid: return decodeBytea;
+    case kCharOid: return decodeChar;
+    case kNameOid:
+    case kTextOid:
+    case kJsonOid:
+    case kXmlOid:
+    case kUnknownOid:
+    case kBpcharOid:
+    case kVarcharOid: return decodeText;
+    case kJsonbOid: return decodeJsonb;
+    case kInt2Oid: return decodeInt2;
+    case kInt4Oid: return decodeInt4;
+    case kInt8Oid: return decodeInt8;
+    case kOidOid:
+    case kXidOid:
+    case kCidOid: return decodeUInt4;
+    case kFloat4Oid: return decodeFloat4;
+    case kFloat8Oid: return decodeFloat8;
+    case kDateOid: return decodeDate;
+    case kTimeOid:
+    case kTimetzOid: return decodeTime;
+    case kTimestampOid: return decodeTimestamp;
+    case kTimestamptzOid: return decodeTimestamptz;
+    case kIntervalOid: return decodeInterval;
+    case kNumericOid: return decodeNumeric;
+    case kMoneyOid: return decodeMoney;
+    case kUuidOid: return decodeUuid;
+    case kInetOid:
+    case kCidrOid: return decodeInet;
+    case kJsonArrayOid:
+    case kBoolArrayOid:
+    case kInt2ArrayOid:
+    case kInt4ArrayOid:
+    case kTextArrayOid:
+    case kVarcharArrayOid:
+    case kInt8ArrayOid:
+    case kFloat4ArrayOid:
+    case kFloat8ArrayOid:
+    case kNumericArrayOid:
+    case kUuidArrayOid:
+    case kJsonbArrayOid: return decodeArray;
+    default: return decodeFallback;
+    }
+}
+
+QVariant decodeBinaryValue(Oid type, const char* data, int length)
+{
+    return binaryDecoderFor(type)(data, length);
+}
+
+bool hasBinaryDecoder(Oid type)
+{
+    return binaryDecoderFor(type) != decodeFallback;
+}
+
+bool prepareUnnamed(PGconn* conn, const QByteArray& sql, bool* binarySafe, PgResultPtr* failure)
+{
+    PgResultPtr prepared(PQprepare(conn, "", sql.constData(), 0, nullptr));
+    if (PQresultStatus(prepared.get()) != PGRES_COMMAND_OK) {
+        if (failure) *failure = std::move(prepared);
+        return false;
+    }
+    PgResultPtr description(PQdescribePrepared(conn, ""));
+    if (PQresultStatus(description.get()) != PGRES_COMMAND_OK) {
+        if (failure) *failure = std::move(description);
+        return false;
+    }
+    bool safe = true;
+    for (int c = 0; safe && c < PQnfields(description.get()); ++c) {
+        safe = hasBinaryDecoder(PQftype(description.get(), c));
+    }
+    *binarySafe = safe;
+    return true;
+}
+
+ValueDecoder textDecoderFor(Oid type)
+{
+    switch (type) {
+    case kBoolOid: return decodeTextBool;
+    case kByteaOid: return decodeTextBytea;
+    case kInt2Oid:
+    case kInt4Oid: return decodeTextInt;
+    case kInt8Oid: return decodeTextInt8;
+    case kOidOid:
+    case kXidOid:
+    case kCidOid: return decodeTextUInt;
+    case kFloat4Oid:
+    case kFloat8Oid: return decodeTextDouble;
+    case kDateOid: return decodeTextDate;
+    case kTimeOid:
+    case kTimetzOid: return decodeTextTime;
+    case kTimestampOid:
+    case kTimestamptzOid: return decodeTextTimestamp;
+    default: return decodeText;
+    }
+}
+
+ColumnReader columnReaderFor(Oid type, bool binary)
+{
+    using Storage = ColumnData::Storage;
+    if (binary) {
+        switch (type) {
+        case kBoolOid: return { Storage::Bool, appendBinaryBool, nullptr };
+        case kInt2Oid: return { Storage::Int64, appendBinaryInt2, nullptr };
+        case kInt4Oid: return { Storage::Int64, appendBinaryInt4, nullptr };
+        case kInt8Oid: return { Storage::Int64, appendBinaryInt8, nullptr };
+        case kOidOid:
+        case kXidOid:
+        case kCidOid: return { Storage::Int64, appendBinaryUInt4, nullptr };
+        case kFloat4Oid: return { Storage::Double, appendBinaryFloat4, nullptr };
+        case kFloat8Oid: return { Storage::Double, appendBinaryFloat8, nullptr };
+        case kNameOid:
+        case kTextOid:
+        case kJsonOid:
+        case kXmlOid:
+        case kUnknownOid:
+        case kBpcharOid:
+        case kVarcharOid: return { Storage::Text, appendUtf8, nullptr };
+        case kJsonbOid: return { Storage::Text, appendBinaryJsonb, nullptr };
+        case kByteaOid:
+        case kDateOid:
+        case kTimeOid:
+        case kTimetzOid:
+        case kTimestampOid:
+        case kTimestamptzOid: return { Storage::Variant, nullptr, binaryDecoderFor(type) };
+        // The remaining decoders (numeric, uuid, arrays, ...) all produce strings.
+        default: return { Storage::Text, nullptr, binaryDecoderFor(type) };
+        }
+    }
+    switch (type) {
+    case kBoolOid: return { Storage::Bool, appendTextBool, nullptr };
+    case kInt2Oid:
+    case kInt4Oid:
+    case kInt8Oid:
+    case kOidOid:
+    case kXidOid:
+    case kCidOid: return { Storage::Int64, appendTextInt, nullptr };
+    case kFloat4Oid:
+    case kFloat8Oid: return { Storage::Double, appendTextDouble, nullptr };
+    case kByteaOid:
+    case kDateOid:
+    case kTimeOid:
+    case kTimetzOid:
+    case kTimestampOid:
+    case kTimestamptzOid: return { Storage::Variant, nullptr, textDecoderFor(type) };
+    default: return { Storage::Text, appendUtf8, nullptr };
+    }
+}
+
+QString postgresTypeName(Oid type)
+{
+    switch (type) {
+    case kBoolOid: return QStringLiteral("bool");
+    case kByteaOid: return QStringLiteral("bytea");
+    case kCharOid: return QStringLiteral("char");
+    case kNameOid: return QStringLiteral("name");
+    case kInt8Oid: return QStringLiteral("int8");
+    case kInt2Oid: return QStringLiteral("int2");
+    case kInt4Oid: return QStringLiteral("int4");
+    case kTextOid: return QStringLiteral("text");
+    case kOidOid: return QStringLiteral("oid");
+    case kXidOid: return QStringLiteral("xid");
+    case kCidOid: return QStringLiteral("cid");
+    case kJsonOid: return QStringLiteral("json");
+    case kXmlOid: return QStringLiteral("xml");
+    case kCidrOid: return QStringLiteral("cidr");
+    case kFloat4Oid: return QStringLiteral("float4");
+    case kFloat8Oid: return QStringLiteral("float8");
+    case kUnknownOid: return QStringLiteral("unknown");
+    case kMoneyOid: return QStringLiteral("money");
+    case kInetOid: return QStringLiteral("inet");
+    case kBpcharOid: return QStringLiteral("bpchar");
+    case kVarcharOid: return QStringLiteral("varchar");
+    case kDateOid: return QStringLiteral("date");
+    case kTimeOid: return QStringLiteral("time");
+    case kTimestampOid: return QStringLiteral("timestamp");
+    case kTimestamptzOid: return QStringLiteral("timestamptz");
+    case kIntervalOid: return QStringLiteral("interval");
+    case kTimetzOid: return QStringLiteral("timetz");
+    case kNumericOid: return QStringLiteral("numeric");
+    case kUuidOid: return QStringLiteral("uuid");
+    case kJsonbOid: return QStringLiteral("jsonb");
+    case kJsonArrayOid: return QStringLiteral("_json");
+    case kBoolArrayOid: return QStringLiteral("_bool");
+    case kInt2ArrayOid: return QStringLiteral("_int2");
+    case kInt4ArrayOid: return QStringLiteral("_int4");
+    case kTextArrayOid: return QStringLiteral("_text");
+    case kVarcharArrayOid: return QStringLiteral("_varchar");
+    case kInt8ArrayOid: return QStringLiteral("_int8");
+    case kFloat4ArrayOid: return QStringLiteral("_float4");
+    case kFloat8ArrayOid: return QStringLiteral("_float8");
+    case kNumericArrayOid: return QStringLiteral("_numeric");
+    case kUuidArrayOid: return QStringLiteral("_uuid");
+    case kJsonbArrayOid: return QStringLiteral("_jsonb");
+    default: return QString();
+    }
+}
+
+DataType dataTypeForOid(Oid type)
+{
+    switch (type) {
+    case kInt2Oid:
+    case kInt4Oid:
+    case kInt8Oid:
+    case kOidOid: return DataType::Integer;
+    case kFloat4Oid:
+    case kFloat8Oid:
+    case kNumericOid: return DataType::Real;
+    case kBoolOid: return DataType::Boolean;
+    case kDateOid: return DataType::Date;
+    case kTimestampOid:
+    case kTimestamptzOid: return DataType::DateTime;
+    case kByteaOid: return DataType::Blob;
+    default: return DataType::Text;
+    }
+}
+
+std::vector<Column> columnsFromResult(const PGresult* result)
+{
+    std::vector<Column> columns;
+    const int count = PQnfields(result);
+    columns.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const Oid type = PQftype(result, i);
+        Column col;
+        col.name = QString::fromUtf8(PQfname(result, i));
+        col.type = dataTypeForOid(type);
+        col.rawType = postgresTypeName(type);
+        col.isNumeric = (col.type == DataType::Integer || col.type == DataType::Real || type == kMoneyOid);
+        columns.push_back(col);
+    }
+    return columns;
+}
+
+QString resultErrorMessage(const PGresult* result, PGconn* conn)
+{
+    QString message;
+    if (result) {
+        message = QString::fromUtf8(PQresultErrorMessage(result)).trimmed();
+    }
+    if (message.isEmpty() && conn) {
+        message = QString::fromUtf8(PQerrorMessage(conn)).trimmed();
+    }
+    return message;
+}
+
+QString resultSqlState(const PGresult* result)
+{
+    if (!result) return QString();
+    const char* state = PQresultErrorField(result, PG_DIAG_SQLSTATE);
+    return state ? QString::fromLatin1(state) : QString();
+}
+
+DatasetPage datasetFromResult(const PGresult* result, int limit, bool binaryResults, const QueryLimits& limits)
+{
+    DatasetPage page;
+    page.columns = columnsFromResult(result);
+    const int columnCount = static_cast<int>(page.columns.size());
+
+    limit = limit > 0 ? limit : 100;
+    const int totalRows = PQntuples(result);
+    const int rowCount = qMin(totalRows, limit);
+    page.hasMore = totalRows > limit;
+
+    std::vector<ColumnReader> readers;
+    readers.reserve(columnCount);
+    page.columnData.reserve(columnCount);
+    for (int c = 0; c < columnCount; ++c) {
+        readers.push_back(columnReaderFor(PQftype(result, c), binaryResults));
+        page.columnData.emplace_back(readers.back().storage);
+        page.columnData.back().reserve(rowCount);
+    }
+
+    // The PGresult is already in memory; the limits bound the decoded copy.
+    long long bytes = 0;
+    for (int r = 0; r < rowCount; ++r) {
+        if (limits.maxRows > 0 && r >= limits.maxRows) {
+            page.warning = QString("Stopped after %1 rows: max rows limit (%2) reached").arg(r).arg(limits.maxRows);
+            page.hasMore = true;
+            break;
+        }
+        if (limits.maxBytes > 0 && bytes >= limits.maxBytes) {
+            page.warning = QString("Stopped after %1 rows: max bytes limit (%2 MB) reached")
+                               .arg(r)
+                               .arg(limits.maxBytes / (1024.0 * 1024.0), 0, 'f', 1);
+            page.hasMore = true;
+            break;
+        }
+        for (int c = 0; c < columnCount; ++c) {
+            if (PQgetisnull(result, r, c)) {
+                page.columnData[c].appendNull();
+            } else {
+                const int length = PQgetlength(result, r, c);
+                bytes += length;
+                readers[c].read(page.columnData[c], PQgetvalue(result, r, c), length);
+            }
+        }
+    }
+    return page;
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+namespace {
+
+// Leaves pipeline mode after a failure so the connection can be used again.
+// Results still queued are read up to the sync (sent here when the failure
+// came before it); two NULLs in a row mean nothing is pending any more.
+void abandonPipeline(PGconn* conn, bool syncSent)
+{
+    if (!syncSent && !PQpipelineSync(conn)) {
+        PQexitPipelineMode(conn);
+        return;
+    }
+    bool previousWasNull = false;
+    while (PQstatus(conn) == CONNECTION_OK) {
+        PGresult* result = PQgetResult(conn);
+        if (!result) {
+            if (previousWasNull) break;
+            previousWasNull = true;
+            continue;
+        }
+        previousWasNull = false;
+        const bool sync = PQresultStatus(result) == PGRES_PIPELINE_SYNC;
+        PQclear(result);
+        if (sync) break;
+    }
+    PQexitPipelineMode(conn);
+}
+
+}
+#endif
+
+bool runPipeline(PGconn* conn, const std::vector<PipelineStatement>& statements, std::vector<PgResultPtr>* results, QString* error)
+{
+    results->clear();
+#ifdef LIBPQ_HAS_PIPELINING
+    if (PQpipelineStatus(conn) != PQ_PIPELINE_OFF || !PQenterPipelineMode(conn)) {
+        if (error) *error = QString::fromUtf8(PQerrorMessage(conn)).trimmed();
+        return false;
+    }
+
+    for (const auto& statement : statements) {
+        std::vector<const char*> values;
+        values.reserve(statement.params.size());
+        for (const QByteArray& param : statement.params) {
+            values.push_back(param.constData());
+        }
+        if (!PQsendQueryParams(conn, statement.sql.constData(), static_cast<int>(values.size()), nullptr,
+                               values.data(), nullptr, nullptr, statement.binaryResult ? 1 : 0)) {
+            if (error) *error = QString::fromUtf8(PQerrorMessage(conn)).trimmed();
+            abandonPipeline(conn, false);
+            return false;
+        }
+    }
+    if (!PQpipelineSync(conn)) {
+        if (error) *error = QString::fromUtf8(PQerrorMessage(conn)).trimmed();
+        PQexitPipelineMode(conn);
+        return false;
+    }
+
+    // Each statement yields its result followed by a NULL; the sync comes last.
+    for (size_t i = 0; i < statements.size(); ++i) {
+        PgResultPtr result(PQgetResult(conn));
+        if (!result) {
+            if (error) *error = QString::fromUtf8(PQerrorMessage(conn)).trimmed();
+            results->clear();
+            abandonPipeline(conn, true);
+            return false;
+        }
+        while (PGresult* trailing = PQgetResult(conn)) {
+            PQclear(trailing);
+        }
+        results->push_back(std::move(result));
+    }
+    PgResultPtr sync(PQgetResult(conn));
+    if (!sync || PQresultStatus(sync.get()) != PGRES_PIPELINE_SYNC) {
+        if (error) *error = QString::fromUtf8(PQerrorMessage(conn)).trimmed();
+        results->clear();
+        abandonPipeline(conn, true);
+        return false;
+    }
+    if (!PQexitPipelineMode(conn)) {
+        if (error) *error = QString::fromUtf8(PQerrorMessage(conn)).trimmed();
+        return false;
+    }
+    return true;
+#else
+    Q_UNUSED(conn);
+    Q_UNUSED(statements);
+    if (error) *error = "libpq was built without pipeline mode";
+    return false;
+#endif
+}
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "udm/UDM.h"
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <memory>
+#include <vector>
+#include <libpq-fe.h>
+
+namespace Sofa::Addons::Postgres {
+
+using namespace Sofa::Core;
+
+// Raw libpq access for the QPSQL sessions opened by PostgresConnection.
+// QtSql exposes the underlying PGconn through QSqlDriver::handle(), so the
+// same authenticated backend can be driven directly when QSqlQuery is too slow.
+PGconn* nativeHandle(const QString& connectionName);
+// Same, for callers about to send raw commands: results QPSQL left unread
+// (a single-row query that wasn't read to the end) are drained first, so the
+// connection is idle. Not for handles used while a command runs (cancel).
+PGconn* idleHandle(const QString& connectionName);
+
+struct PgResultDeleter {
+    void operator()(PGresult* result) const { PQclear(result); }
+};
+using PgResultPtr = std::unique_ptr<PGresult, PgResultDeleter>;
+
+using ValueDecoder = QVariant (*)(const char* data, int length);
+
+// Picks the binary wire-format decoder for a type OID once per column.
+ValueDecoder binaryDecoderFor(Oid type);
+QVariant decodeBinaryValue(Oid type, const char* data, int length);
+// False for types without a binary decoder (composites, ranges, geometry,
+// date arrays, ...): their binary form is unreadable, so they must be asked
+// for in text format.
+bool hasBinaryDecoder(Oid type);
+// Same for text-format results, producing the QVariant types QPSQL would.
+ValueDecoder textDecoderFor(Oid type);
+
+using ValueAppender = void (*)(ColumnData& column, const char* data, int length);
+
+// How one result column lands in a columnar page: straight into its typed
+// buffer when the format allows (integers, floats, booleans, text), otherwise
+// through the column's ValueDecoder.
+struct ColumnReader {
+    ColumnData::Storage storage = ColumnData::Storage::Variant;
+    ValueAppender append = nullptr;
+    ValueDecoder decode = nullptr;
+
+    void read(ColumnData& column, const char* data, int length) const
+    {
+        if (append) {
+            append(column, data, length);
+        } else {
+            column.appendValue(decode(data, length));
+        }
+    }
+};
+
+ColumnReader columnReaderFor(Oid type, bool binary);
+
+QString postgresTypeName(Oid type);
+DataType dataTypeForOid(Oid type);
+
+// Builds UDM columns from a result's row description.
+std::vector<Column> columnsFromResult(const PGresult* result);
+
+// Decodes at most limit rows of a PGRES_TUPLES_OK result into a columnar
+// page (DatasetPage::columnData); hasMore is set when the result holds more.
+DatasetPage datasetFromResult(const PGresult* result, int limit, bool binaryResults, const QueryLimits& limits = QueryLimits());
+
+QString resultErrorMessage(const PGresult* result, PGconn* conn);
+QString resultSqlState(const PGresult* result);
+
+// One statement sent through runPipeline(); params are text-format values for $1..$n.
+struct PipelineStatement {
+    QByteArray sql;
+    QList<QByteArray> params;
+    bool binaryResult = false;
+};
+
+// Prepares sql as the unnamed statement and describes it, so the result format
+// can be chosen before it runs: binarySafe is true when every result column
+// has a binary decoder. Returns false when sql can't be prepared (a syntax
+// error, or a multi-statement script); failure then holds the server's result.
+bool prepareUnnamed(PGconn* conn, const QByteArray& sql, bool* binarySafe, PgResultPtr* failure);
+
+// Sends every statement in libpq pipeline mode and waits for a single sync, so
+// the whole batch costs one round trip. results gets one entry per statement;
+// after a failure the following ones are PGRES_PIPELINE_ABORTED.
+// Returns false when the pipeline could not run (libpq older than 14, or the
+// connection broke); error then says why.
+bool runPipeline(PGconn* conn, const std::vector<PipelineStatement>& statements, std::vector<PgResultPtr>* results, QString* error);
+
+}
@@ -1,4 +1,5 @@
 #include "SofaAddonPostgres.h"
+#include "PostgresLibpq.h"
 #include <QUuid>
 #include <QSqlQuery>
 #include <QSqlRecord>
@@ -6,8 +7,12 @@
 #include <QDebug>
 #include <QDateTime>
 #include <QHash>
-#include <QSet>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
 #include <QRegularExpression>
+#include <limits>
 
 namespace Sofa::Addons::Postgres {
 namespace {
@@ -70,6 +75,70 @@ bool isMultilineInputPostgresType(const QString& rawType)
         || t.startsWith("_");
 }
 
+QString quoteIdentifier(const QString& identifier)
+{
+    return QString("\"%1\"").arg(QString(identifier).replace("\"", "\"\""));
+}
+
+}
+
+QString encodeKeysetCursor(const DatasetRequest& request, const QStringList& keyColumns, const QStringList& values)
+{
+    QJsonObject token;
+    token["sort"] = request.hasSort ? request.sortColumn : QString();
+    token["asc"] = !request.hasSort || request.sortAscending;
+    token["cols"] = QJsonArray::fromStringList(keyColumns);
+    token["vals"] = QJsonArray::fromStringList(values);
+    return QString::fromLatin1(QJsonDocument(token).toJson(QJsonDocument::Compact)
+                                   .toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
+
+QStringList decodeKeysetCursor(const QString& cursor, const DatasetRequest& request, const QStringList& keyColumns)
+{
+    if (cursor.isEmpty()) return {};
+    const QByteArray json = QByteArray::fromBase64(cursor.toLatin1(), QByteArray::Base64UrlEncoding);
+    const QJsonObject token = QJsonDocument::fromJson(json).object();
+    if (token.value("sort").toString() != (request.hasSort ? request.sortColumn : QString())) return {};
+    if (token.value("asc").toBool() != (!request.hasSort || request.sortAscending)) return {};
+
+    QStringList columns;
+    for (const auto& value : token.value("cols").toArray()) columns << value.toString();
+    if (columns != keyColumns) return {};
+
+    QStringList values;
+    for (const auto& value : token.value("vals").toArray()) values << value.toString();
+    if (values.size() != keyColumns.size()) return {};
+    return values;
+}
+
+namespace {
+QString filteredCountSql(const QString& schema, const QString& table, const QString& filter)
+{
+    QString sql = QString("SELECT COUNT(*) FROM %1.%2").arg(quoteIdentifier(schema), quoteIdentifier(table));
+    if (!filter.trimmed().isEmpty()) {
+        sql += QString(" WHERE %1").arg(filter.trimmed());
+    }
+    return sql;
+}
+
+// Planner estimate for the filtered table; reads no rows.
+QString explainCountSql(const QString& schema, const QString& table, const QString& filter)
+{
+    QString sql = QString("EXPLAIN (FORMAT JSON) SELECT 1 FROM %1.%2").arg(quoteIdentifier(schema), quoteIdentifier(table));
+    if (!filter.trimmed().isEmpty()) {
+        sql += QString(" WHERE %1").arg(filter.trimmed());
+    }
+    return sql;
+}
+
+long long planRowsFromExplain(const QByteArray& json)
+{
+    const QJsonArray plans = QJsonDocument::fromJson(json).array();
+    if (plans.isEmpty()) return -1;
+    const QJsonValue rows = plans.first().toObject().value("Plan").toObject().value("Plan Rows");
+    return rows.isDouble() ? static_cast<long long>(rows.toDouble()) : -1;
+}
+
 QString extractAdvancedTailFromIndexDef(const QString& definitionSql)
 {
     const QString def = definitionSql.trimmed();
@@ -91,11 +160,253 @@ QString extractAdvancedTailFromIndexDef(const QString& definitionSql)
 
     return tokens.join(' ');
 }
+
+// Per-table statements (count) share the cache, so it is bounded.
+constexpr size_t kMaxCachedStatements = 64;
+
+// Column metadata behind getDataset/openPager in one query: type (a domain
+// reports its base type), nullability, default and position in the primary
+// key (NULL when not part of it). $1 is the quoted relation name.
+constexpr const char* kTableMetadataSql =
+    "SELECT a.attname, coalesce(bt.typname, t.typname), NOT a.attnotnull, "
+    "       pg_get_expr(d.adbin, d.adrelid), array_position(pk.conkey, a.attnum), a.atttypid "
+    "FROM pg_catalog.pg_attribute a "
+    "JOIN pg_catalog.pg_type t ON t.oid = a.atttypid "
+    "LEFT JOIN pg_catalog.pg_type bt ON t.typtype = 'd' AND bt.oid = t.typbasetype "
+    "LEFT JOIN pg_catalog.pg_attrdef d ON d.adrelid = a.attrelid AND d.adnum = a.attnum "
+    "LEFT JOIN pg_catalog.pg_constraint pk ON pk.conrelid = a.attrelid AND pk.contype = 'p' "
+    "WHERE a.attrelid = to_regclass($1) AND a.attnum > 0 AND NOT a.attisdropped "
+    "ORDER BY a.attnum";
+
+// The table's catalog version: any ALTER TABLE rewrites its pg_class or
+// pg_attribute rows, and adding or dropping a constraint moves the count or
+// newest xmin of its pg_constraint rows. One index lookup per catalog; $1 is
+// the quoted relation name. No row when the table is gone.
+constexpr const char* kTableVersionSql =
+    "SELECT c.oid, concat_ws('.', c.xmin, "
+    "  (SELECT max(a.xmin::text::bigint) FROM pg_catalog.pg_attribute a WHERE a.attrelid = c.oid), "
+    "  (SELECT count(*) || ':' || coalesce(max(x.xmin::text::bigint), 0) "
+    "     FROM pg_catalog.pg_constraint x WHERE x.conrelid = c.oid)) "
+    "FROM pg_catalog.pg_class c WHERE c.oid = to_regclass($1)";
+
+// Row estimate kept by VACUUM/ANALYZE. -1 (PG14+) means never analyzed; $1 is
+// the quoted relation name.
+constexpr const char* kRelTuplesSql =
+    "SELECT c.reltuples::bigint FROM pg_class c WHERE c.oid = to_regclass($1)";
+
+// Catalog reads go straight to pg_catalog: the information_schema views join
+// and privilege-check far more than the explorer needs, which shows on
+// catalogs with tens of thousands of relations. The visibility filters are the
+// ones information_schema applies, so the same objects are listed.
+constexpr const char* kCatalogSchemasSql =
+    "SELECT n.nspname "
+    "FROM pg_catalog.pg_namespace n "
+    "WHERE pg_has_role(n.nspowner, 'USAGE') OR has_schema_privilege(n.oid, 'CREATE, USAGE') "
+    "ORDER BY n.nspname";
+
+// One pass over the schema's relations: PK flag, planner row estimate (-1 when
+// never analyzed) and on-disk size from relpages, so no relation file is stat'ed.
+constexpr const char* kCatalogTablesSql =
+    "SELECT c.relname, c.oid, "
+    "       EXISTS (SELECT 1 FROM pg_catalog.pg_constraint con "
+    "                WHERE con.conrelid = c.oid AND con.contype = 'p'), "
+    "       c.relkind, "
+    "       CASE WHEN c.relkind IN ('r', 'm') AND c.reltuples >= 0 THEN c.reltuples::bigint ELSE -1 END, "
+    "       CASE WHEN c.relkind IN ('r', 'm') THEN c.relpages::bigint * current_setting('block_size')::bigint ELSE -1 END "
+    "FROM pg_catalog.pg_class c "
+    "JOIN pg_catalog.pg_namespace n ON n.oid = c.relnamespace "
+    "WHERE n.nspname = :schema "
+    "  AND c.relkind IN ('r', 'p', 'v', 'f') "
+    "  AND (pg_has_role(c.relowner, 'USAGE') "
+    "       OR has_table_privilege(c.oid, 'SELECT, INSERT, UPDATE, DELETE, TRUNCATE, REFERENCES, TRIGGER') "
+    "       OR has_any_column_privilege(c.oid, 'SELECT, INSERT, UPDATE, REFERENCES')) "
+    "ORDER BY c.relname";
+
+// Columns with their PK membership in one query. udt_name semantics: a domain
+// reports its base type.
+constexpr const char* kCatalogColumnsSql =
+    "SELECT a.attname, "
+    "       coalesce(bt.typname, t.typname), "
+    "       NOT a.attnotnull, "
+    "       pg_get_expr(d.adbin, d.adrelid), "
+    "       c.oid, "
+    "       pk.conname, "
+    "       coalesce(a.attnum = ANY (pk.conkey), false) "
+    "FROM pg_catalog.pg_class c "
+    "JOIN pg_catalog.pg_namespace n ON n.oid = c.relnamespace "
+    "JOIN pg_catalog.pg_attribute a ON a.attrelid = c.oid AND a.attnum > 0 AND NOT a.attisdropped "
+    "JOIN pg_catalog.pg_type t ON t.oid = a.atttypid "
+    "LEFT JOIN pg_catalog.pg_type bt ON t.typtype = 'd' AND bt.oid = t.typbasetype "
+    "LEFT JOIN pg_catalog.pg_attrdef d ON d.adrelid = a.attrelid AND d.adnum = a.attnum "
+    "LEFT JOIN pg_catalog.pg_constraint pk ON pk.conrelid = c.oid AND pk.contype = 'p' "
+    "WHERE n.nspname = :schema AND c.relname = :table "
+    "ORDER BY a.attnum";
+
+// Index catalog in one query: the per-column pg_get_indexdef calls run
+// server-side over generate_series and come back as a JSON array (key columns
+// first, then INCLUDE columns). Only PK/unique/exclusion constraints own an
+// index; a foreign key's conindid points at the referenced index instead.
+constexpr const char* kCatalogIndexesSelectSql =
+    "SELECT tbl.relname, "
+    "       idx.relname, "
+    "       am.amname, "
+    "       i.indisunique, "
+    "       i.indisprimary, "
+    "       i.indisvalid, "
+    "       con.conname, "
+    "       con.contype, "
+    "       pg_get_indexdef(i.indexrelid, 0, true), "
+    "       pg_get_expr(i.indpred, i.indrelid, true), "
+    "       i.indnkeyatts, "
+    "       (SELECT json_agg(pg_get_indexdef(i.indexrelid, k, true) ORDER BY k)::text "
+    "          FROM generate_series(1, i.indnatts::int) k) "
+    "FROM pg_catalog.pg_index i "
+    "JOIN pg_catalog.pg_class tbl ON tbl.oid = i.indrelid "
+    "JOIN pg_catalog.pg_namespace ns ON ns.oid = tbl.relnamespace "
+    "JOIN pg_catalog.pg_class idx ON idx.oid = i.indexrelid "
+    "JOIN pg_catalog.pg_am am ON am.oid = idx.relam "
+    "LEFT JOIN pg_catalog.pg_constraint con "
+    "       ON con.conindid = i.indexrelid AND con.conrelid = i.indrelid AND con.contype IN ('p', 'u', 'x') ";
+
+// DDL inserts, updates or deletes rows of these catalogs. The token is each
+// catalog's cumulative tuple counters from the statistics system (this
+// session's pending ones included): lookups by OID, no catalog is read, and
+// the counters never wrap. Other sessions' changes show once their stats are
+// flushed (a few seconds at most). Temporary tables write the same catalogs,
+// so creating or dropping one moves the token too. Empty with track_counts off.
+constexpr const char* kCatalogVersionSql =
+    "SELECT string_agg((pg_stat_get_tuples_inserted(c.oid) + pg_stat_get_tuples_updated(c.oid) "
+    "                   + pg_stat_get_tuples_deleted(c.oid) + pg_stat_get_xact_tuples_inserted(c.oid) "
+    "                   + pg_stat_get_xact_tuples_updated(c.oid) + pg_stat_get_xact_tuples_deleted(c.oid))::text, "
+    "                  '.' ORDER BY c.n) "
+    "FROM unnest('{pg_catalog.pg_namespace, pg_catalog.pg_class, pg_catalog.pg_attribute, "
+    "              pg_catalog.pg_attrdef, pg_catalog.pg_constraint, pg_catalog.pg_index}'::regclass[]) "
+    "     WITH ORDINALITY AS c(oid, n) "
+    "WHERE current_setting('track_counts')::bool";
+
+// Export range planning; $1 is the quoted relation name.
+constexpr const char* kExportRelationSql =
+    "SELECT c.relkind, pg_relation_size(c.oid) / current_setting('block_size')::bigint, "
+    "       (SELECT string_agg(quote_ident(a.attname), ', ' ORDER BY a.attnum) "
+    "          FROM pg_attribute a "
+    "         WHERE a.attrelid = c.oid AND a.attnum > 0 AND NOT a.attisdropped) "
+    "FROM pg_class c WHERE c.oid = to_regclass($1)";
+
+constexpr const char* kExportPartitionsSql =
+    "SELECT quote_ident(n.nspname) || '.' || quote_ident(c.relname), pg_relation_size(c.oid) "
+    "FROM pg_partition_tree(to_regclass($1)) t "
+    "JOIN pg_class c ON c.oid = t.relid "
+    "JOIN pg_namespace n ON n.oid = c.relnamespace "
+    "WHERE t.isleaf "
+    "ORDER BY 2 DESC";
+
+constexpr const char* kExportKeyHistogramSql =
+    "SELECT quote_ident(a.attname), format_type(a.atttypid, a.atttypmod), b.bound "
+    "FROM pg_index i "
+    "JOIN pg_class c ON c.oid = i.indrelid "
+    "JOIN pg_namespace n ON n.oid = c.relnamespace "
+    "JOIN pg_attribute a ON a.attrelid = i.indrelid AND a.attnum = i.indkey[0] "
+    "JOIN pg_stats s ON s.schemaname = n.nspname AND s.tablename = c.relname AND s.attname = a.attname "
+    "CROSS JOIN LATERAL unnest(s.histogram_bounds::text::text[]) WITH ORDINALITY AS b(bound, n) "
+    "WHERE i.indrelid = to_regclass($1) AND i.indisprimary AND i.indnatts = 1 "
+    "ORDER BY b.n";
+
+// 64 MiB of 8 KiB blocks: below that one connection finishes about as fast.
+constexpr long long kMinExportRangeBlocks = 8192;
+}
+
+// --- PostgresStatementCache ---
+
+PostgresStatementCache::PostgresStatementCache(const QString& connectionName)
+    : m_connectionName(connectionName) {}
+
+PostgresStatementCache::~PostgresStatementCache() {
+    clear();
+}
+
+QSqlQuery* PostgresStatementCache::prepared(const QString& key, const QString& sql) {
+    auto it = m_statements.find(key);
+    if (it != m_statements.end()) {
+        ++m_hits;
+        it->second.lastUsed = ++m_useCounter;
+        return it->second.query.get();
+    }
+
+    ++m_misses;
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    if (!db.isOpen()) {
+        m_lastError = "Connection is not open";
+        return nullptr;
+    }
+    auto query = std::make_unique<QSqlQuery>(db);
+    query->setForwardOnly(true);
+    // QPSQL turns this into a named PREPARE on the server.
+    if (!query->prepare(sql)) {
+        m_lastError = query->lastError().text();
+        return nullptr;
+    }
+    if (m_statements.size() >= kMaxCachedStatements) {
+        evictLeastRecentlyUsed();
+    }
+    Entry& entry = m_statements[key];
+    entry.query = std::move(query);
+    entry.lastUsed = ++m_useCounter;
+    return entry.query.get();
+}
+
+QSqlQuery* PostgresStatementCache::run(const QString& key, const QString& sql, const QVariantMap& bindings) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        QSqlQuery* query = prepared(key, sql);
+        if (!query) {
+            return nullptr;
+        }
+        for (auto it = bindings.constBegin(); it != bindings.constEnd(); ++it) {
+            query->bindValue(it.key(), it.value());
+        }
+        if (query->exec()) {
+            return query;
+        }
+        m_lastError = query->lastError().text();
+        // 26000: the statement is gone on the server (DISCARD ALL / DEALLOCATE
+        // from the SQL console). Prepare it again once.
+        if (attempt == 0 && query->lastError().nativeErrorCode() == "26000") {
+            qInfo() << "\x1b[33m🗂️ PG statements\x1b[0m preparando de novo:" << key;
+            m_statements.erase(key);
+            continue;
+        }
+        return nullptr;
+    }
+    return nullptr;
+}
+
+void PostgresStatementCache::evictLeastRecentlyUsed() {
+    auto oldest = m_statements.begin();
+    for (auto it = m_statements.begin(); it != m_statements.end(); ++it) {
+        if (it->second.lastUsed < oldest->second.lastUsed) {
+            oldest = it;
+        }
+    }
+    if (oldest != m_statements.end()) {
+        m_statements.erase(oldest);
+    }
+}
+
+void PostgresStatementCache::clear() {
+    if (m_hits == 0 && m_misses == 0) {
+        return;
+    }
+    qInfo() << "\x1b[36m🗂️ PG statements\x1b[0m hits:" << m_hits << "misses:" << m_misses
+            << "preparados:" << m_statements.size();
+    // Must run before QSqlDatabase::removeDatabase: the queries hold the connection.
+    m_statements.clear();
+    m_hits = 0;
+    m_misses = 0;
 }
 
 // --- PostgresConnection ---
 
-PostgresConnection::PostgresConnection() {
+PostgresConnection::PostgresConnection(bool nativeProtocol)
+    : m_nativeProtocol(nativeProtocol) {
 }
 
 PostgresConnection::~PostgresConnection() {
@@ -149,14 +460,22 @@ bool PostgresConnection::open(const QString& host, int port, const QString& db,
         return false;
     }
 
-    m_catalog = std::make_shared<PostgresCatalogProvider>(m_connectionName);
-    m_query = std::make_shared<PostgresQueryProvider>(m_connectionName);
-    
+    m_statements = std::make_shared<PostgresStatementCache>(m_connectionName);
+    m_catalog = std::make_shared<PostgresCatalogProvider>(m_connectionName, m_statements);
+    if (m_nativeProtocol) {
+        m_query = std::make_shared<PostgresNativeQueryProvider>(m_connectionName, m_statements);
+    } else {
+        m_query = std::make_shared<PostgresQueryProvider>(m_connectionName, m_statements);
+    }
+
     return true;
 }
 
 void PostgresConnection::close() {
     if (!m_connectionName.isEmpty()) {
+        if (m_statements) {
+            m_statements->clear();
+        }
         {
             QSqlDatabase db = QSqlDatabase::database(m_connectionName);
             if (db.isOpen()) {
@@ -167,6 +486,7 @@ void PostgresConnection::close() {
         m_connectionName.clear();
         m_catalog.reset();
         m_query.reset();
+        m_statements.reset();
     }
 }
 
@@ -179,6 +499,33 @@ QString PostgresConnection::lastError() const {
     return m_lastError;
 }
 
+bool PostgresConnection::ping() {
+    if (m_connectionName.isEmpty()) return false;
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    if (!db.isOpen()) return false;
+    QSqlQuery q(db);
+    if (!q.exec("SELECT 1")) {
+        m_lastError = q.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool PostgresConnection::resetForReuse() {
+    PGconn* conn = idleHandle(m_connectionName);
+    if (!conn) return isOpen();
+    const PGTransactionStatusType status = PQtransactionStatus(conn);
+    if (status == PQTRANS_INTRANS || status == PQTRANS_INERROR) {
+        qInfo() << "\x1b[33m🔁 PG\x1b[0m transação aberta ao devolver a conexão; ROLLBACK";
+        PQclear(PQexec(conn, "ROLLBACK"));
+    }
+    if (PQtransactionStatus(conn) != PQTRANS_IDLE) {
+        m_lastError = QString::fromUtf8(PQerrorMessage(conn)).trimmed();
+        return false;
+    }
+    return true;
+}
+
 std::shared_ptr<ICatalogProvider> PostgresConnection::catalog() {
     return m_catalog;
 }
@@ -189,56 +536,79 @@ std::shared_ptr<IQueryProvider> PostgresConnection::query() {
 
 // --- PostgresCatalogProvider ---
 
-PostgresCatalogProvider::PostgresCatalogProvider(const QString& connectionName) 
-    : m_connectionName(connectionName) {}
+PostgresCatalogProvider::PostgresCatalogProvider(const QString& connectionName, std::shared_ptr<PostgresStatementCache> statements)
+    : m_connectionName(connectionName)
+    , m_statements(std::move(statements)) {}
 
 std::vector<QString> PostgresCatalogProvider::listSchemas() {
     std::vector<QString> schemas;
     QSqlDatabase db = QSqlDatabase::database(m_connectionName);
     if (!db.isOpen()) return schemas;
 
-    QSqlQuery q(db);
-    if (q.exec("SELECT schema_name FROM information_schema.schemata ORDER BY schema_name")) {
-        while (q.next()) {
-            schemas.push_back(q.value(0).toString());
+    QSqlQuery* q = m_statements->run("catalog.schemas", kCatalogSchemasSql);
+    if (q) {
+        while (q->next()) {
+            schemas.push_back(q->value(0).toString());
         }
     }
     return schemas;
 }
 
+QString PostgresCatalogProvider::catalogVersion() {
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    if (!db.isOpen()) return QString();
+
+    QSqlQuery* q = m_statements->run("catalog.version", kCatalogVersionSql);
+    if (!q) return QString();
+    const QString version = q->next() ? q->value(0).toString() : QString();
+    // Single-row mode: the backend stays busy until the result is consumed.
+    q->finish();
+    return version;
+}
+
 std::vector<QString> PostgresCatalogProvider::listHiddenSchemas() {
     return { "information_schema", "pg_catalog", "pg_toast" };
 }
 
 std::vector<CatalogTable> PostgresCatalogProvider::listTables(const QString& schema) {
     std::vector<CatalogTable> tables;
+    streamTables(schema, 0, [&tables](std::vector<CatalogTable>& batch) {
+        tables = std::move(batch);
+        return true;
+    });
+    return tables;
+}
+
+bool PostgresCatalogProvider::streamTables(const QString& schema, int batchSize, const std::function<bool(std::vector<CatalogTable>&)>& onBatch) {
     QSqlDatabase db = QSqlDatabase::database(m_connectionName);
-    if (!db.isOpen()) return tables;
+    if (!db.isOpen()) return false;
 
-    QSqlQuery q(db);
-    q.prepare(
-        "SELECT t.table_name, "
-        "       EXISTS ("
-        "           SELECT 1"
-        "           FROM information_schema.table_constraints tc"
-        "           WHERE tc.table_schema = t.table_schema"
-        "             AND tc.table_name = t.table_name"
-        "             AND tc.constraint_type = 'PRIMARY KEY'"
-        "       ) AS has_primary_key "
-        "FROM information_schema.tables t "
-        "WHERE t.table_schema = :schema "
-        "ORDER BY t.table_name"
-    );
-    q.bindValue(":schema", schema);
-    if (q.exec()) {
-        while (q.next()) {
-            CatalogTable table;
-            table.name = q.value(0).toString();
-            table.hasPrimaryKey = q.value(1).toBool();
-            tables.push_back(table);
+    QSqlQuery* q = m_statements->run("catalog.tables", kCatalogTablesSql, { { ":schema", schema } });
+    if (!q) return false;
+
+    // batchSize <= 0: everything in one batch.
+    std::vector<CatalogTable> batch;
+    while (q->next()) {
+        CatalogTable table;
+        table.name = q->value(0).toString();
+        table.oid = q->value(1).toUInt();
+        table.hasPrimaryKey = q->value(2).toBool();
+        table.kind = q->value(3).toString();
+        table.estimatedRows = q->value(4).toLongLong();
+        table.estimatedBytes = q->value(5).toLongLong();
+        batch.push_back(table);
+        if (batchSize > 0 && static_cast<int>(batch.size()) >= batchSize) {
+            if (!onBatch(batch)) {
+                q->finish();
+                return true;
+            }
+            batch.clear();
         }
     }
-    return tables;
+    if (!batch.empty() || batchSize <= 0) {
+        onBatch(batch);
+    }
+    return true;
 }
 
 TableSchema PostgresCatalogProvider::getTableSchema(const QString& schema, const QString& table) {
@@ -249,24 +619,21 @@ TableSchema PostgresCatalogProvider::getTableSchema(const QString& schema, const
     QSqlDatabase db = QSqlDatabase::database(m_connectionName);
     if (!db.isOpen()) return ts;
 
-    QSqlQuery columnsQuery(db);
-    columnsQuery.prepare(
-        "SELECT column_name, udt_name, is_nullable, column_default "
-        "FROM information_schema.columns "
-        "WHERE table_schema = :schema AND table_name = :table "
-        "ORDER BY ordinal_position"
-    );
-    columnsQuery.bindValue(":schema", schema);
-    columnsQuery.bindValue(":table", table);
-
-    if (columnsQuery.exec()) {
-        while (columnsQuery.next()) {
+    QSqlQuery* columnsQuery = m_statements->run("catalog.columns", kCatalogColumnsSql,
+        { { ":schema", schema }, { ":table", table } });
+
+    if (columnsQuery) {
+        while (columnsQuery->next()) {
             Column col;
-            col.name = columnsQuery.value(0).toString();
-            col.rawType = columnsQuery.value(1).toString();
-            const QString nullableRaw = columnsQuery.value(2).toString().trimmed().toUpper();
-            col.isNullable = (nullableRaw == "YES");
-            col.defaultValue = columnsQuery.value(3).toString();
+            col.name = columnsQuery->value(0).toString();
+            col.rawType = columnsQuery->value(1).toString();
+            col.isNullable = columnsQuery->value(2).toBool();
+            col.defaultValue = columnsQuery->value(3).toString();
+            ts.oid = columnsQuery->value(4).toUInt();
+            if (ts.primaryKeyConstraintName.isEmpty()) {
+                ts.primaryKeyConstraintName = columnsQuery->value(5).toString();
+            }
+            col.isPrimaryKey = columnsQuery->value(6).toBool();
 
             const QString typeStr = col.rawType.trimmed().toLower();
             if (typeStr.contains("int")) col.type = DataType::Integer;
@@ -282,127 +649,176 @@ TableSchema PostgresCatalogProvider::getTableSchema(const QString& schema, const
             ts.columns.push_back(col);
         }
     }
+    return ts;
+}
 
-    QSqlQuery pkQuery(db);
-    pkQuery.prepare(
-        "SELECT tc.constraint_name, kcu.column_name "
-        "FROM information_schema.table_constraints tc "
-        "JOIN information_schema.key_column_usage kcu "
-        "  ON tc.constraint_name = kcu.constraint_name "
-        " AND tc.table_schema = kcu.table_schema "
-        " AND tc.table_name = kcu.table_name "
-        "WHERE tc.constraint_type = 'PRIMARY KEY' "
-        "  AND tc.table_schema = :schema "
-        "  AND tc.table_name = :table "
-        "ORDER BY kcu.ordinal_position"
-    );
-    pkQuery.bindValue(":schema", schema);
-    pkQuery.bindValue(":table", table);
-
-    QSet<QString> primaryKeyColumns;
-    if (pkQuery.exec()) {
-        while (pkQuery.next()) {
-            if (ts.primaryKeyConstraintName.isEmpty()) {
-                ts.primaryKeyConstraintName = pkQuery.value(0).toString();
-            }
-            primaryKeyColumns.insert(pkQuery.value(1).toString());
+namespace {
+// Reads a kCatalogIndexesSelectSql row (column 0, the table, is the caller's).
+TableIndex readCatalogIndex(const QSqlQuery& q)
+{
+    TableIndex idx;
+    idx.name = q.value(1).toString();
+    idx.method = q.value(2).toString();
+    idx.isUnique = q.value(3).toBool();
+    idx.isPrimary = q.value(4).toBool();
+    idx.isValid = q.value(5).toBool();
+    idx.constraintName = q.value(6).toString();
+    idx.constraintType = q.value(7).toString();
+    idx.definitionSql = q.value(8).toString();
+    idx.predicate = q.value(9).toString();
+    idx.advancedTailSql = extractAdvancedTailFromIndexDef(idx.definitionSql);
+    idx.isConstraintBacked = !idx.constraintName.trimmed().isEmpty();
+
+    const int keyCount = q.value(10).toInt();
+    const QJsonArray items = QJsonDocument::fromJson(q.value(11).toString().toUtf8()).array();
+    for (int i = 0; i < items.size(); ++i) {
+        const QString itemExpr = items.at(i).toString().trimmed();
+        if (itemExpr.isEmpty()) {
+            continue;
+        }
+        if (i < keyCount) {
+            idx.keyItems.append(itemExpr);
+        } else {
+            idx.includeItems.append(itemExpr);
         }
     }
-
-    for (auto& col : ts.columns) {
-        col.isPrimaryKey = primaryKeyColumns.contains(col.name);
-    }
-    return ts;
+    return idx;
+}
 }
 
-std::vector<TableIndex> PostgresCatalogProvider::getTableIndexes(const QString& schema, const QString& table)
+std::vector<TableIndex> PostgresCatalogProvider::getTableIndexes(const QString& schema, const QString& table, QString* error)
 {
     std::vector<TableIndex> indexes;
 
     QSqlDatabase db = QSqlDatabase::database(m_connectionName);
-    if (!db.isOpen()) return indexes;
+    if (!db.isOpen()) {
+        if (error) *error = "Connection is not open";
+        return indexes;
+    }
 
-    QSqlQuery q(db);
-    q.prepare(
-        "SELECT idx.relname AS index_name, "
-        "       am.amname AS method, "
-        "       i.indisunique, "
-        "       i.indisprimary, "
-        "       i.indisvalid, "
-        "       con.conname AS constraint_name, "
-        "       con.contype AS constraint_type, "
-        "       pg_get_indexdef(i.indexrelid, 0, true) AS definition_sql, "
-        "       pg_get_expr(i.indpred, i.indrelid, true) AS predicate, "
-        "       i.indnkeyatts, "
-        "       i.indnatts, "
-        "       i.indexrelid "
-        "FROM pg_index i "
-        "JOIN pg_class tbl ON tbl.oid = i.indrelid "
-        "JOIN pg_namespace ns ON ns.oid = tbl.relnamespace "
-        "JOIN pg_class idx ON idx.oid = i.indexrelid "
-        "JOIN pg_am am ON am.oid = idx.relam "
-        "LEFT JOIN pg_constraint con ON con.conindid = i.indexrelid "
-        "WHERE ns.nspname = :schema "
-        "  AND tbl.relname = :table "
-        "ORDER BY idx.relname"
-    );
-    q.bindValue(":schema", schema);
-    q.bindValue(":table", table);
+    QSqlQuery* q = m_statements->run("catalog.indexes",
+        QString(kCatalogIndexesSelectSql) + "WHERE ns.nspname = :schema AND tbl.relname = :table ORDER BY idx.relname",
+        { { ":schema", schema }, { ":table", table } });
+    if (!q) {
+        if (error) *error = m_statements->lastError();
+        return indexes;
+    }
+    while (q->next()) {
+        indexes.push_back(readCatalogIndex(*q));
+    }
+    if (q->lastError().isValid()) {
+        if (error) *error = q->lastError().text();
+        return {};
+    }
+    return indexes;
+}
 
-    if (!q.exec()) {
+std::map<QString, std::vector<TableIndex>> PostgresCatalogProvider::getSchemaIndexes(const QString& schema, QString* error)
+{
+    std::map<QString, std::vector<TableIndex>> indexes;
+
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    if (!db.isOpen()) {
+        if (error) *error = "Connection is not open";
         return indexes;
     }
 
-    QSqlQuery itemQuery(db);
-    itemQuery.prepare("SELECT pg_get_indexdef(:index_oid, :item_no, true)");
+    QSqlQuery* q = m_statements->run("catalog.schemaIndexes",
+        QString(kCatalogIndexesSelectSql) + "WHERE ns.nspname = :schema ORDER BY tbl.relname, idx.relname",
+        { { ":schema", schema } });
+    if (!q) {
+        if (error) *error = m_statements->lastError();
+        return indexes;
+    }
+    while (q->next()) {
+        indexes[q->value(0).toString()].push_back(readCatalogIndex(*q));
+    }
+    if (q->lastError().isValid()) {
+        if (error) *error = q->lastError().text();
+        return {};
+    }
+    return indexes;
+}
 
-    while (q.next()) {
-        TableIndex idx;
-        idx.name = q.value(0).toString();
-        idx.method = q.value(1).toString();
-        idx.isUnique = q.value(2).toBool();
-        idx.isPrimary = q.value(3).toBool();
-        idx.isValid = q.value(4).toBool();
-        idx.constraintName = q.value(5).toString();
-        idx.constraintType = q.value(6).toString();
-        idx.definitionSql = q.value(7).toString();
-        idx.predicate = q.value(8).toString();
-        idx.advancedTailSql = extractAdvancedTailFromIndexDef(idx.definitionSql);
-        idx.isConstraintBacked = !idx.constraintName.trimmed().isEmpty();
-
-        const int keyCount = q.value(9).toInt();
-        const int totalCount = q.value(10).toInt();
-        const qulonglong indexOid = q.value(11).toULongLong();
-
-        if (indexOid > 0 && totalCount > 0) {
-            for (int itemNo = 1; itemNo <= totalCount; ++itemNo) {
-                itemQuery.bindValue(":index_oid", indexOid);
-                itemQuery.bindValue(":item_no", itemNo);
-                if (!itemQuery.exec() || !itemQuery.next()) {
-                    continue;
-                }
-                const QString itemExpr = itemQuery.value(0).toString().trimmed();
-                if (itemExpr.isEmpty()) {
-                    continue;
-                }
-                if (itemNo <= keyCount) {
-                    idx.keyItems.append(itemExpr);
-                } else {
-                    idx.includeItems.append(itemExpr);
-                }
-            }
-        }
+// --- PostgresDatasetPager ---
+
+PostgresDatasetPager::PostgresDatasetPager(PostgresQueryProvider* provider, const QString& connectionName, PostgresTableMetadata metadata)
+    : m_provider(provider)
+    , m_connectionName(connectionName)
+    , m_cursorName("sofa_pager_" + QUuid::createUuid().toString(QUuid::Id128))
+    , m_metadata(std::move(metadata)) {}
 
-        indexes.push_back(idx);
+PostgresDatasetPager::~PostgresDatasetPager() {
+    close();
+}
+
+bool PostgresDatasetPager::exec(const QString& sql, QString* error) {
+    QSqlQuery q(QSqlDatabase::database(m_connectionName));
+    if (!q.exec(sql)) {
+        if (error) *error = q.lastError().text();
+        return false;
     }
+    return true;
+}
 
-    return indexes;
+bool PostgresDatasetPager::open(const QString& selectSql, QString* error) {
+    // REPEATABLE READ keeps every page on the same snapshot as the cursor itself.
+    if (!exec("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY", error)) {
+        return false;
+    }
+    if (!exec(QString("DECLARE %1 SCROLL CURSOR FOR %2").arg(m_cursorName, selectSql), error)) {
+        exec("ROLLBACK", nullptr);
+        return false;
+    }
+    m_open = true;
+    qInfo() << "\x1b[36m📑 PG pager\x1b[0m aberto:" << m_cursorName << selectSql;
+    return true;
+}
+
+DatasetPage PostgresDatasetPager::fetchPage(int offset, int limit) {
+    DatasetPage page;
+    if (!m_open) {
+        page.warning = "Cursor is closed";
+        return page;
+    }
+    limit = limit > 0 ? limit : 100;
+    offset = offset > 0 ? offset : 0;
+
+    // ABSOLUTE n leaves the cursor on row n, so the FETCH starts at row n + 1.
+    QString error;
+    if (!exec(QString("MOVE ABSOLUTE %1 IN %2").arg(offset).arg(m_cursorName), &error)) {
+        page.warning = error;
+        close();
+        return page;
+    }
+
+    DatasetRequest req;
+    req.limit = limit;
+    page = m_provider->execute(QString("FETCH FORWARD %1 FROM %2").arg(limit + 1).arg(m_cursorName), req);
+    if (page.columns.empty()) {
+        // The transaction is aborted after any error; the pager can't be reused.
+        close();
+        return page;
+    }
+    PostgresQueryProvider::decorateDatasetColumns(page.columns, m_metadata);
+    return page;
+}
+
+void PostgresDatasetPager::close() {
+    if (!m_open) {
+        return;
+    }
+    m_open = false;
+    exec(QString("CLOSE %1").arg(m_cursorName), nullptr);
+    exec("ROLLBACK", nullptr);
+    qInfo() << "\x1b[33m📑 PG pager\x1b[0m fechado:" << m_cursorName;
 }
 
 // --- PostgresQueryProvider ---
 
-PostgresQueryProvider::PostgresQueryProvider(const QString& connectionName)
-    : m_connectionName(connectionName) {}
+PostgresQueryProvider::PostgresQueryProvider(const QString& connectionName, std::shared_ptr<PostgresStatementCache> statements)
+    : m_connectionName(connectionName)
+    , m_statements(std::move(statements)) {}
 
 DatasetPage PostgresQueryProvider::execute(const QString& queryStr, const DatasetRequest& request) {
     DatasetPage page;
@@ -461,6 +877,12 @@ DatasetPage PostgresQueryProvider::execute(const QString& queryStr, const Datase
             page.hasMore = true;
             break;
         }
+        // QtSql hands out values already converted, so only the row budget applies here.
+        if (request.limits.maxRows > 0 && count >= request.limits.maxRows) {
+            page.warning = QString("Stopped after %1 rows: max rows limit (%2) reached").arg(count).arg(request.limits.maxRows);
+            page.hasMore = true;
+            break;
+        }
         
         std::vector<QVariant> row;
         QStringList debugVals;
@@ -502,150 +924,1382 @@ DatasetPage PostgresQueryProvider::getDataset(const QString& schema, const QStri
     }
 
     DatasetRequest req = request;
-    int limit = req.limit > 0 ? req.limit : 100;
-    int offset = req.offset > 0 ? req.offset : 0;
-    int sqlLimit = limit + 1;
-    req.limit = limit;
+    req.limit = req.limit > 0 ? req.limit : 100;
+    req.offset = req.offset > 0 ? req.offset : 0;
 
-    QSqlQuery typeQuery(db);
-    typeQuery.prepare(
-        "SELECT column_name, udt_name, is_nullable, column_default "
-        "FROM information_schema.columns "
-        "WHERE table_schema = :schema "
-        "  AND table_name = :table"
-    );
-    typeQuery.bindValue(":schema", schema);
-    typeQuery.bindValue(":table", table);
-
-    QHash<QString, QString> sqlTypeByColumn;
-    QHash<QString, bool> isNullableByColumn;
-    QHash<QString, QString> defaultValueByColumn;
-    if (typeQuery.exec()) {
-        while (typeQuery.next()) {
-            sqlTypeByColumn.insert(typeQuery.value(0).toString(), typeQuery.value(1).toString());
-            const QString nullableRaw = typeQuery.value(2).toString().trimmed().toUpper();
-            isNullableByColumn.insert(typeQuery.value(0).toString(), nullableRaw == "YES");
-            defaultValueByColumn.insert(typeQuery.value(0).toString(), typeQuery.value(3).toString());
-        }
-    }
-
-    auto quoteIdentifier = [](const QString& identifier) {
-        return QString("\"%1\"").arg(QString(identifier).replace("\"", "\"\""));
-    };
+    DatasetPage page;
+    if (getPipelinedDataset(schema, table, req, &page)) {
+        return page;
+    }
 
-    QString sql = QString("SELECT * FROM %1.%2")
-                      .arg(quoteIdentifier(schema), quoteIdentifier(table));
+    const PostgresTableMetadata metadata = loadTableMetadata(schema, table);
+    page = execute(datasetPageSql(schema, table, req, metadata), req);
+    finishDatasetPage(page, req, metadata);
+    if (req.withCount && !page.columns.empty()) {
+        const RowCount estimate = countRows(schema, table, req.filter, CountStrategy::Estimated);
+        page.totalRows = estimate.total;
+        page.totalRowsEstimated = estimate.estimated;
+    }
+    return page;
+}
 
-    const QString filterClause = req.filter.trimmed();
-    if (!filterClause.isEmpty()) {
-        sql += QString(" WHERE %1").arg(filterClause);
+bool PostgresQueryProvider::getPipelinedDataset(const QString& schema, const QString& table, const DatasetRequest& req, DatasetPage* page) {
+    PGconn* conn = idleHandle(m_connectionName);
+    if (!conn) {
+        return false;
+    }
+    const qint64 startTime = QDateTime::currentMSecsSinceEpoch();
+
+    // The data query depends on the primary key (keyset ordering). Metadata is
+    // memoized per table and only the table's catalog version travels with the
+    // data query; the memo is reloaded when the version moves. On the first
+    // visit the metadata query goes into the same pipeline instead.
+    const QString tableKey = schema + QChar(0x1f) + table;
+    const QString relation = quoteIdentifier(schema) + "." + quoteIdentifier(table);
+    const QByteArray relationParam = relation.toUtf8();
+    const auto known = m_lastMetadata.constFind(tableKey);
+    const bool haveMetadata = known != m_lastMetadata.constEnd();
+    const QString speculativeSql = haveMetadata ? datasetPageSql(schema, table, req, known.value()) : QString();
+    const bool speculativeBinary = haveMetadata && m_binaryResults && known->binaryResults;
+
+    std::vector<PipelineStatement> statements {
+        { kTableVersionSql, { relationParam }, false },
+    };
+    int metadataIndex = -1;
+    int dataIndex = -1;
+    if (haveMetadata) {
+        dataIndex = static_cast<int>(statements.size());
+        statements.push_back({ speculativeSql.toUtf8(), {}, speculativeBinary });
+    } else {
+        metadataIndex = static_cast<int>(statements.size());
+        statements.push_back({ kTableMetadataSql, { relationParam }, false });
+    }
+    // Only statistics go in the pipeline: an exact COUNT(*) can scan for minutes.
+    int estimateIndex = -1;
+    const bool estimateFromExplain = !req.filter.trimmed().isEmpty();
+    if (req.withCount) {
+        estimateIndex = static_cast<int>(statements.size());
+        if (estimateFromExplain) {
+            statements.push_back({ explainCountSql(schema, table, req.filter).toUtf8(), {}, false });
+        } else {
+            statements.push_back({ kRelTuplesSql, { relationParam }, false });
+        }
     }
 
-    if (req.hasSort && !req.sortColumn.isEmpty() && sqlTypeByColumn.contains(req.sortColumn)) {
-        sql += QString(" ORDER BY %1 %2")
-            .arg(quoteIdentifier(req.sortColumn), req.sortAscending ? "ASC" : "DESC");
+    qInfo() << "\x1b[36m⚡ PG pipeline\x1b[0m statements:" << statements.size() << "tabela:" << schema + "." + table;
+    std::vector<PgResultPtr> results;
+    QString error;
+    if (!runPipeline(conn, statements, &results, &error)) {
+        if (PQstatus(conn) != CONNECTION_OK) {
+            page->warning = error;
+            return true;
+        }
+        // libpq without pipeline support: the sequential path still works.
+        return false;
     }
 
-    sql += QString(" LIMIT %1 OFFSET %2").arg(sqlLimit).arg(offset);
-    DatasetPage page = execute(sql, req);
+    const PGresult* versionResult = results[0].get();
+    if (PQresultStatus(versionResult) != PGRES_TUPLES_OK) {
+        page->warning = resultErrorMessage(versionResult, conn);
+        qWarning() << "\x1b[31m❌ PG pipeline\x1b[0m metadata:" << page->warning;
+        return true;
+    }
+    const QString version = PQntuples(versionResult) > 0 ? QString::fromUtf8(PQgetvalue(versionResult, 0, 1)) : QString();
+
+    PostgresTableMetadata metadata;
+    if (haveMetadata && !version.isEmpty() && known->version == version) {
+        metadata = known.value();
+    } else {
+        PgResultPtr reloaded;
+        const PGresult* metadataResult = nullptr;
+        if (metadataIndex >= 0) {
+            metadataResult = results[metadataIndex].get();
+        } else {
+            qInfo() << "\x1b[33m🗂️ PG pipeline\x1b[0m catálogo da tabela mudou, recarregando metadata:" << schema + "." + table;
+            const char* params[] = { relationParam.constData() };
+            reloaded.reset(PQexecParams(conn, kTableMetadataSql, 1, nullptr, params, nullptr, nullptr, 0));
+            metadataResult = reloaded.get();
+        }
+        if (!metadataResult || PQresultStatus(metadataResult) != PGRES_TUPLES_OK) {
+            page->warning = resultErrorMessage(metadataResult, conn);
+            qWarning() << "\x1b[31m❌ PG pipeline\x1b[0m metadata:" << page->warning;
+            return true;
+        }
+        metadata = metadataFromResult(metadataResult);
+        metadata.oid = PQntuples(versionResult) > 0 ? QByteArray(PQgetvalue(versionResult, 0, 0)).toUInt() : 0;
+        metadata.version = version;
+        if (!version.isEmpty()) {
+            m_lastMetadata.insert(tableKey, metadata);
+        } else {
+            m_lastMetadata.remove(tableKey);
+        }
+    }
 
-    if (page.columns.empty()) {
-        return page;
+    const QString sql = datasetPageSql(schema, table, req, metadata);
+    PgResultPtr rerun;
+    const PGresult* dataResult = nullptr;
+    const bool binary = m_binaryResults && metadata.binaryResults;
+    if (dataIndex >= 0 && sql == speculativeSql && binary == speculativeBinary) {
+        dataResult = results[dataIndex].get();
+    } else {
+        // First visit to the table, or its key/columns changed: one more round trip.
+        qInfo() << "\x1b[33m↩️ PG pipeline\x1b[0m query de dados após metadata:" << sql;
+        const QByteArray sqlBytes = sql.toUtf8();
+        rerun.reset(PQexecParams(conn, sqlBytes.constData(), 0, nullptr, nullptr, nullptr, nullptr, binary ? 1 : 0));
+        dataResult = rerun.get();
     }
 
-    QSqlQuery pkQuery(db);
-    pkQuery.prepare(
-        "SELECT kcu.column_name "
-        "FROM information_schema.table_constraints tc "
-        "JOIN information_schema.key_column_usage kcu "
-        "  ON tc.constraint_name = kcu.constraint_name "
-        " AND tc.table_schema = kcu.table_schema "
-        " AND tc.table_name = kcu.table_name "
-        "WHERE tc.constraint_type = 'PRIMARY KEY' "
-        "  AND tc.table_schema = :schema "
-        "  AND tc.table_name = :table"
-    );
-    pkQuery.bindValue(":schema", schema);
-    pkQuery.bindValue(":table", table);
+    if (!dataResult || PQresultStatus(dataResult) != PGRES_TUPLES_OK) {
+        page->warning = resultErrorMessage(dataResult, conn);
+        qWarning() << "\x1b[31m❌ PG pipeline\x1b[0m erro ao executar query:" << page->warning;
+        return true;
+    }
 
-    QSet<QString> primaryKeyColumns;
-    if (pkQuery.exec()) {
-        while (pkQuery.next()) {
-            primaryKeyColumns.insert(pkQuery.value(0).toString());
+    *page = datasetFromResult(dataResult, req.limit, binary, req.limits);
+    if (estimateIndex >= 0) {
+        page->totalRows = estimateFromResult(results[estimateIndex].get(), estimateFromExplain);
+        if (page->totalRows < 0) {
+            // Never analyzed: ask the planner instead.
+            page->totalRows = countRows(schema, table, req.filter, CountStrategy::Estimated).total;
         }
+        page->totalRowsEstimated = true;
     }
+    finishDatasetPage(*page, req, metadata);
+    page->executionTimeMs = QDateTime::currentMSecsSinceEpoch() - startTime;
+    qInfo() << "\x1b[32m✅ PG pipeline\x1b[0m colunas:" << page->columns.size() << "linhas:" << page->rowCount()
+            << "round trips:" << (rerun ? 2 : 1) << "ms:" << page->executionTimeMs;
+    return true;
+}
 
-    for (auto& col : page.columns) {
-        col.isPrimaryKey = primaryKeyColumns.contains(col.name);
-        const QString sqlType = sqlTypeByColumn.value(col.name);
-        if (!sqlType.isEmpty()) {
-            col.rawType = sqlType;
-        }
-        if (isNullableByColumn.contains(col.name)) {
-            col.isNullable = isNullableByColumn.value(col.name);
+PostgresTableMetadata PostgresQueryProvider::metadataFromResult(const PGresult* result) {
+    PostgresTableMetadata metadata;
+    auto text = [result](int row, int column) {
+        return QString::fromUtf8(PQgetvalue(result, row, column));
+    };
+    QMap<int, QString> keyByPosition;
+    for (int r = 0; r < PQntuples(result); ++r) {
+        const QString name = text(r, 0);
+        metadata.sqlTypeByColumn.insert(name, text(r, 1));
+        metadata.isNullableByColumn.insert(name, text(r, 2) == "t");
+        metadata.defaultValueByColumn.insert(name, text(r, 3));
+        if (!PQgetisnull(result, r, 4)) {
+            keyByPosition.insert(text(r, 4).toInt(), name);
         }
-        if (defaultValueByColumn.contains(col.name)) {
-            col.defaultValue = defaultValueByColumn.value(col.name);
+        if (!hasBinaryDecoder(static_cast<Oid>(text(r, 5).toUInt()))) {
+            metadata.binaryResults = false;
         }
-        col.isNumeric = isNumericPostgresType(col.rawType);
-        col.isMultilineInput = isMultilineInputPostgresType(col.rawType);
-        col.temporalInputGroup = temporalInputGroupFromPostgresType(col.rawType);
-        col.temporalNowExpression = temporalNowExpressionForGroup(col.temporalInputGroup);
     }
-
-    return page;
+    for (const QString& column : keyByPosition) {
+        metadata.primaryKeyColumns.insert(column);
+        metadata.primaryKeyOrder.append(column);
+    }
+    return metadata;
 }
 
-int PostgresQueryProvider::count(const QString& schema, const QString& table) {
-    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
-    if (!db.isOpen()) {
+long long PostgresQueryProvider::estimateFromResult(const PGresult* result, bool fromExplain) {
+    if (!result || PQresultStatus(result) != PGRES_TUPLES_OK || PQntuples(result) == 0 || PQgetisnull(result, 0, 0)) {
         return -1;
     }
-    
-    QString sql = QString("SELECT COUNT(*) FROM \"%1\".\"%2\"").arg(schema).arg(table);
-    QSqlQuery q(db);
-    if (q.exec(sql) && q.next()) {
-        return q.value(0).toInt();
+    const QByteArray value(PQgetvalue(result, 0, 0), PQgetlength(result, 0, 0));
+    if (fromExplain) {
+        return planRowsFromExplain(value);
     }
-    
-    qWarning() << "Count failed:" << q.lastError().text();
-    return -1;
+    const long long total = value.toLongLong();
+    return total >= 0 ? total : -1;
 }
 
-int PostgresQueryProvider::backendPid() {
-    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
-    if (!db.isOpen()) {
-        return -1;
+QString PostgresQueryProvider::datasetPageSql(const QString& schema, const QString& table, const DatasetRequest& req, const PostgresTableMetadata& metadata) {
+    const QStringList keyColumns = keysetColumns(req, metadata);
+    if (!keyColumns.isEmpty()) {
+        return keysetSelectSql(schema, table, req, keyColumns);
     }
-    QSqlQuery q(db);
-    if (q.exec("SELECT pg_backend_pid()") && q.next()) {
-        return q.value(0).toInt();
+    return datasetSelectSql(schema, table, req, metadata)
+        + QString(" LIMIT %1 OFFSET %2").arg(req.limit + 1).arg(req.offset);
+}
+
+void PostgresQueryProvider::finishDatasetPage(DatasetPage& page, const DatasetRequest& req, const PostgresTableMetadata& metadata) {
+    if (page.columns.empty()) {
+        return;
     }
-    return -1;
+    const QStringList keyColumns = keysetColumns(req, metadata);
+    const int keyCount = static_cast<int>(keyColumns.size());
+    if (keyCount > 0) {
+        if (page.columns.size() < static_cast<size_t>(keyCount)) {
+            return;
+        }
+        // Strip the ::text key columns keysetSelectSql appended, keeping the last row's as the token.
+        const int dataColumns = static_cast<int>(page.columns.size()) - keyCount;
+        const int rowCount = page.rowCount();
+        if (page.hasMore && rowCount > 0) {
+            QStringList values;
+            for (int i = 0; i < keyCount; ++i) {
+                values << page.value(rowCount - 1, dataColumns + i).toString();
+            }
+            page.nextCursor = encodeKeysetCursor(req, keyColumns, values);
+        }
+        page.columns.resize(dataColumns);
+        if (page.isColumnar()) {
+            page.columnData.resize(dataColumns);
+        }
+        for (auto& row : page.rows) {
+            row.resize(dataColumns);
+        }
+    }
+    decorateDatasetColumns(page.columns, metadata);
 }
 
-bool PostgresConnection::cancelQuery(int backendPid) {
-    if (backendPid <= 0) return false;
-    if (m_connectionName.isEmpty()) return false;
-    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
-    if (!db.isOpen()) return false;
-    QSqlQuery q(db);
-    q.prepare("SELECT pg_cancel_backend(:pid)");
-    q.bindValue(":pid", backendPid);
-    if (!q.exec()) {
-        m_lastError = q.lastError().text();
-        return false;
+QStringList PostgresQueryProvider::keysetColumns(const DatasetRequest& req, const PostgresTableMetadata& metadata) {
+    // Seeking needs a total order: the sort column (which must not be NULL, since
+    // row comparisons with NULL drop rows) followed by the primary key.
+    if (metadata.primaryKeyOrder.isEmpty()) {
+        return {};
     }
-    if (q.next()) {
-        return q.value(0).toBool();
+    QStringList columns;
+    if (req.hasSort && !req.sortColumn.isEmpty() && metadata.sqlTypeByColumn.contains(req.sortColumn)) {
+        if (!metadata.primaryKeyColumns.contains(req.sortColumn)
+            && metadata.isNullableByColumn.value(req.sortColumn, true)) {
+            return {};
+        }
+        columns << req.sortColumn;
     }
-    return false;
+    for (const QString& column : metadata.primaryKeyOrder) {
+        if (!columns.contains(column)) {
+            columns << column;
+        }
+    }
+    return columns;
 }
 
-// --- PostgresAddon ---
+QString PostgresQueryProvider::keysetSelectSql(const QString& schema, const QString& table, const DatasetRequest& req, const QStringList& keyColumns) {
+    const bool ascending = !req.hasSort || req.sortAscending;
+    const QStringList seekValues = decodeKeysetCursor(req.cursor, req, keyColumns);
+
+    // Key values are read back as text so the next seek compares exactly what the
+    // server stored (no float/timestamp precision lost in QVariant).
+    QStringList selectList { "*" };
+    QStringList quotedKeys;
+    for (int i = 0; i < keyColumns.size(); ++i) {
+        const QString quoted = quoteIdentifier(keyColumns[i]);
+        quotedKeys << quoted;
+        selectList << QString("%1::text AS %2").arg(quoted, quoteIdentifier(QString("__sofa_key_%1").arg(i)));
+    }
 
-std::shared_ptr<IConnectionProvider> PostgresAddon::createConnection() {
-    return std::make_shared<PostgresConnection>();
+    QStringList conditions;
+    const QString filterClause = req.filter.trimmed();
+    if (!filterClause.isEmpty()) {
+        conditions << QString("(%1)").arg(filterClause);
+    }
+    if (!seekValues.isEmpty()) {
+        QStringList literals;
+        for (const QString& value : seekValues) {
+            literals << "'" + QString(value).replace("'", "''") + "'";
+        }
+        conditions << QString("(%1) %2 (%3)").arg(quotedKeys.join(", "), ascending ? ">" : "<", literals.join(", "));
+    }
+
+    QStringList orderBy;
+    for (const QString& quoted : quotedKeys) {
+        orderBy << quoted + (ascending ? " ASC" : " DESC");
+    }
+
+    QString sql = QString("SELECT %1 FROM %2.%3").arg(selectList.join(", "), quoteIdentifier(schema), quoteIdentifier(table));
+    if (!conditions.isEmpty()) {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    sql += " ORDER BY " + orderBy.join(", ");
+    sql += QString(" LIMIT %1").arg(req.limit + 1);
+    // Without a valid token (first page, or a jump) fall back to the offset.
+    if (seekValues.isEmpty() && req.offset > 0) {
+        sql += QString(" OFFSET %1").arg(req.offset);
+    }
+
+    return sql;
+}
+
+std::unique_ptr<IDatasetPager> PostgresQueryProvider::openPager(const QString& schema, const QString& table, const DatasetRequest& request) {
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    if (!db.isOpen()) {
+        return nullptr;
+    }
+    PostgresTableMetadata metadata = loadTableMetadata(schema, table);
+    const QString sql = datasetSelectSql(schema, table, request, metadata);
+    auto pager = std::make_unique<PostgresDatasetPager>(this, m_connectionName, std::move(metadata));
+    QString error;
+    if (!pager->open(sql, &error)) {
+        qWarning() << "\x1b[31m❌ PG pager\x1b[0m falha ao abrir cursor:" << error;
+        return nullptr;
+    }
+    return pager;
+}
+
+PostgresTableMetadata PostgresQueryProvider::loadTableMetadata(const QString& schema, const QString& table) {
+    const QString tableKey = schema + QChar(0x1f) + table;
+    const QVariantMap relationBinding { { ":relation", quoteIdentifier(schema) + "." + quoteIdentifier(table) } };
+
+    QString version;
+    quint32 oid = 0;
+    if (QSqlQuery* versionQuery = m_statements->run("dataset.version",
+            QString::fromLatin1(kTableVersionSql).replace("$1", ":relation"), relationBinding)) {
+        if (versionQuery->next()) {
+            oid = versionQuery->value(0).toUInt();
+            version = versionQuery->value(1).toString();
+        }
+        versionQuery->finish();
+    }
+    const auto known = m_lastMetadata.constFind(tableKey);
+    if (known != m_lastMetadata.constEnd() && !version.isEmpty() && known->version == version) {
+        return known.value();
+    }
+
+    PostgresTableMetadata metadata;
+    metadata.oid = oid;
+    metadata.version = version;
+    QSqlQuery* columnsQuery = m_statements->run("dataset.metadata",
+        QString::fromLatin1(kTableMetadataSql).replace("$1", ":relation"), relationBinding);
+
+    QMap<int, QString> keyByPosition;
+    if (columnsQuery) {
+        while (columnsQuery->next()) {
+            const QString name = columnsQuery->value(0).toString();
+            metadata.sqlTypeByColumn.insert(name, columnsQuery->value(1).toString());
+            metadata.isNullableByColumn.insert(name, columnsQuery->value(2).toBool());
+            metadata.defaultValueByColumn.insert(name, columnsQuery->value(3).toString());
+            if (!columnsQuery->value(4).isNull()) {
+                keyByPosition.insert(columnsQuery->value(4).toInt(), name);
+            }
+            if (!hasBinaryDecoder(static_cast<Oid>(columnsQuery->value(5).toUInt()))) {
+                metadata.binaryResults = false;
+            }
+        }
+    }
+    for (const QString& column : keyByPosition) {
+        metadata.primaryKeyColumns.insert(column);
+        metadata.primaryKeyOrder.append(column);
+    }
+    if (columnsQuery && !version.isEmpty()) {
+        m_lastMetadata.insert(tableKey, metadata);
+    } else {
+        m_lastMetadata.remove(tableKey);
+    }
+    return metadata;
+}
+
+QString PostgresQueryProvider::datasetSelectSql(const QString& schema, const QString& table, const DatasetRequest& req, const PostgresTableMetadata& metadata) {
+    QString sql = QString("SELECT * FROM %1.%2")
+                      .arg(quoteIdentifier(schema), quoteIdentifier(table));
+
+    const QString filterClause = req.filter.trimmed();
+    if (!filterClause.isEmpty()) {
+        sql += QString(" WHERE %1").arg(filterClause);
+    }
+
+    if (req.hasSort && !req.sortColumn.isEmpty() && metadata.sqlTypeByColumn.contains(req.sortColumn)) {
+        sql += QString(" ORDER BY %1 %2")
+            .arg(quoteIdentifier(req.sortColumn), req.sortAscending ? "ASC" : "DESC");
+    }
+    return sql;
+}
+
+void PostgresQueryProvider::decorateDatasetColumns(std::vector<Column>& columns, const PostgresTableMetadata& metadata) {
+    for (auto& col : columns) {
+        col.isPrimaryKey = metadata.primaryKeyColumns.contains(col.name);
+        const QString sqlType = metadata.sqlTypeByColumn.value(col.name);
+        if (!sqlType.isEmpty()) {
+            col.rawType = sqlType;
+        }
+        if (metadata.isNullableByColumn.contains(col.name)) {
+            col.isNullable = metadata.isNullableByColumn.value(col.name);
+        }
+        if (metadata.defaultValueByColumn.contains(col.name)) {
+            col.defaultValue = metadata.defaultValueByColumn.value(col.name);
+        }
+        col.isNumeric = isNumericPostgresType(col.rawType);
+        col.isMultilineInput = isMultilineInputPostgresType(col.rawType);
+        col.temporalInputGroup = temporalInputGroupFromPostgresType(col.rawType);
+        col.temporalNowExpression = temporalNowExpressionForGroup(col.temporalInputGroup);
+    }
+}
+
+int PostgresQueryProvider::count(const QString& schema, const QString& table) {
+    const RowCount result = countRows(schema, table, QString(), CountStrategy::Exact);
+    return result.total >= 0 ? static_cast<int>(qMin<long long>(result.total, std::numeric_limits<int>::max())) : -1;
+}
+
+RowCount PostgresQueryProvider::countRows(const QString& schema, const QString& table, const QString& filter, CountStrategy strategy) {
+    RowCount result;
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    if (!db.isOpen()) {
+        return result;
+    }
+
+    if (strategy == CountStrategy::Exact) {
+        const QString sql = filteredCountSql(schema, table, filter);
+        QSqlQuery* q = nullptr;
+        QSqlQuery filtered(db);
+        if (filter.trimmed().isEmpty()) {
+            // Identifiers can't be parameters, so each table gets its own statement.
+            q = m_statements->run("count:" + sql, sql);
+        } else if (filtered.exec(sql)) {
+            q = &filtered;
+        }
+        if (q && q->next()) {
+            result.total = q->value(0).toLongLong();
+            q->finish();
+        } else {
+            qWarning() << "Count failed:" << (filter.trimmed().isEmpty() ? m_statements->lastError() : filtered.lastError().text());
+        }
+        return result;
+    }
+
+    result.estimated = true;
+    if (filter.trimmed().isEmpty()) {
+        QSqlQuery* q = m_statements->run("count.reltuples",
+            QString::fromLatin1(kRelTuplesSql).replace("$1", ":relation"),
+            { { ":relation", quoteIdentifier(schema) + "." + quoteIdentifier(table) } });
+        const bool known = q && q->next() && !q->value(0).isNull() && q->value(0).toLongLong() >= 0;
+        if (known) {
+            result.total = q->value(0).toLongLong();
+        }
+        if (q) {
+            q->finish();
+        }
+        if (known) {
+            return result;
+        }
+    }
+    QSqlQuery explain(db);
+    if (explain.exec(explainCountSql(schema, table, filter)) && explain.next()) {
+        result.total = planRowsFromExplain(explain.value(0).toString().toUtf8());
+    }
+    return result;
+}
+
+int PostgresQueryProvider::backendPid() {
+    // The pid is fixed for the lifetime of the session; pooled connections
+    // would otherwise pay an extra round trip on every request.
+    if (m_backendPid > 0) {
+        return m_backendPid;
+    }
+    // libpq already knows it from the startup packet: no round trip.
+    if (PGconn* conn = nativeHandle(m_connectionName)) {
+        m_backendPid = PQbackendPID(conn);
+        if (m_backendPid > 0) {
+            return m_backendPid;
+        }
+    }
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    if (!db.isOpen()) {
+        return -1;
+    }
+    QSqlQuery q(db);
+    if (q.exec("SELECT pg_backend_pid()") && q.next()) {
+        m_backendPid = q.value(0).toInt();
+        return m_backendPid;
+    }
+    return -1;
+}
+
+bool PostgresQueryProvider::setStatementTimeout(int timeoutMs) {
+    timeoutMs = qMax(0, timeoutMs);
+    // Session setting: only pay the round trip when it actually changes.
+    if (timeoutMs == m_statementTimeoutMs) {
+        return true;
+    }
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    if (!db.isOpen()) {
+        return false;
+    }
+    QSqlQuery q(db);
+    const QString sql = timeoutMs > 0
+        ? QString("SET statement_timeout = %1").arg(timeoutMs)
+        : QString("RESET statement_timeout");
+    if (!q.exec(sql)) {
+        qWarning() << "\x1b[31m❌ PG statement_timeout\x1b[0m erro:" << q.lastError().text();
+        return false;
+    }
+    m_statementTimeoutMs = timeoutMs;
+    return true;
+}
+
+// --- PostgresResultCursor ---
+
+namespace {
+// Rows per PGresult in chunked mode; the caller's batch size is applied on top.
+constexpr int kChunkedRows = 256;
+}
+
+PostgresResultCursor::PostgresResultCursor(PGconn* conn, const QString& query, bool binaryResults, const QueryLimits& limits, bool nonBlocking)
+    : m_conn(conn)
+    , m_query(query)
+    , m_binary(binaryResults)
+    , m_nonBlocking(nonBlocking)
+    , m_limits(limits) {}
+
+PostgresResultCursor::~PostgresResultCursor() {
+    close();
+}
+
+bool PostgresResultCursor::send() {
+    const QByteArray sql = m_query.toUtf8();
+    int sent = 0;
+    bool binarySafe = false;
+    if (m_binary && prepareUnnamed(m_conn, sql, &binarySafe, nullptr)) {
+        // Columns without a binary decoder make the whole result text, as QPSQL shows it.
+        m_binary = binarySafe;
+        sent = PQsendQueryPrepared(m_conn, "", 0, nullptr, nullptr, nullptr, m_binary ? 1 : 0);
+    } else {
+        // Scripts can't be prepared; the simple protocol runs them (and reports
+        // any other error through the normal result path).
+        m_binary = false;
+        sent = PQsendQuery(m_conn, sql.constData());
+    }
+    if (!sent) {
+        return false;
+    }
+    enableRowMode();
+    if (m_nonBlocking) {
+        // Large statements may not fit the socket buffer; poll() finishes sending them.
+        const int flushed = PQflush(m_conn);
+        if (flushed < 0) {
+            return false;
+        }
+        m_flushPending = flushed == 1;
+    }
+    return true;
+}
+
+bool PostgresResultCursor::resendAsSimpleQuery(const PGresult* result) {
+    if (!m_binary || resultSqlState(result) != "42601" || !m_query.contains(';')) {
+        return false;
+    }
+    drain();
+    m_binary = false;
+    if (!send()) {
+        m_error = QString::fromUtf8(PQerrorMessage(m_conn)).trimmed();
+        m_atEnd = true;
+    }
+    return true;
+}
+
+void PostgresResultCursor::enableRowMode() {
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    if (PQsetChunkedRowsMode(m_conn, kChunkedRows)) {
+        return;
+    }
+#endif
+    PQsetSingleRowMode(m_conn);
+}
+
+void PostgresResultCursor::takeRowDescription(const PGresult* result) {
+    if (!m_columns.empty()) {
+        return;
+    }
+    m_columns = columnsFromResult(result);
+    m_readers.clear();
+    m_readers.reserve(m_columns.size());
+    for (int c = 0; c < static_cast<int>(m_columns.size()); ++c) {
+        m_readers.push_back(columnReaderFor(PQftype(result, c), m_binary));
+    }
+}
+
+void PostgresResultCursor::fail(const PGresult* result) {
+    m_error = resultErrorMessage(result, m_conn);
+    if (m_error.isEmpty() && result) {
+        m_error = QString::fromUtf8(PQresStatus(PQresultStatus(result)));
+    }
+    qWarning() << "\x1b[31m❌ PG stream\x1b[0m erro:" << m_error;
+    drain();
+    m_atEnd = true;
+}
+
+void PostgresResultCursor::drain() {
+    m_pending.reset();
+    m_pendingRow = 0;
+    while (PGresult* result = PQgetResult(m_conn)) {
+        const ExecStatusType status = PQresultStatus(result);
+        PQclear(result);
+        // COPY keeps returning the same status until the data phase is finished.
+        if (status == PGRES_COPY_IN) {
+            PQputCopyEnd(m_conn, "COPY is not supported here");
+        } else if (status == PGRES_COPY_OUT) {
+            char* buffer = nullptr;
+            while (PQgetCopyData(m_conn, &buffer, 0) > 0) {
+                PQfreemem(buffer);
+            }
+        } else if (status == PGRES_COPY_BOTH) {
+            break;
+        }
+    }
+}
+
+bool PostgresResultCursor::checkLimits() {
+    if (m_limits.maxRows > 0 && m_rowsRead >= m_limits.maxRows) {
+        m_limitWarning = QString("Stopped after %1 rows: max rows limit (%2) reached").arg(m_rowsRead).arg(m_limits.maxRows);
+    } else if (m_limits.maxBytes > 0 && m_bytesRead >= m_limits.maxBytes) {
+        m_limitWarning = QString("Stopped after %1 rows: max bytes limit (%2 MB) reached")
+                             .arg(m_rowsRead)
+                             .arg(m_limits.maxBytes / (1024.0 * 1024.0), 0, 'f', 1);
+    } else {
+        return false;
+    }
+    qWarning() << "\x1b[33m⚠️ PG stream\x1b[0m" << m_limitWarning;
+    close();
+    return true;
+}
+
+bool PostgresResultCursor::start() {
+    m_startedAtMs = QDateTime::currentMSecsSinceEpoch();
+    qInfo() << "\x1b[36m🔎 PG stream\x1b[0m query:" << m_query << (m_nonBlocking ? "(async)" : "");
+
+    if (m_nonBlocking && PQsetnonblocking(m_conn, 1) != 0) {
+        m_nonBlocking = false;
+    }
+    if (!send()) {
+        m_error = QString::fromUtf8(PQerrorMessage(m_conn)).trimmed();
+        m_atEnd = true;
+        return false;
+    }
+    if (m_nonBlocking) {
+        // fetchNext() reads the row description once poll() received it.
+        return true;
+    }
+
+    // Read up to the first row-returning statement so columns() is known before any fetch.
+    while (true) {
+        PgResultPtr result(PQgetResult(m_conn));
+        if (!result) {
+            m_atEnd = true;
+            return true;
+        }
+        switch (PQresultStatus(result.get())) {
+        case PGRES_SINGLE_TUPLE:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+        case PGRES_TUPLES_CHUNK:
+#endif
+            takeRowDescription(result.get());
+            m_described = true;
+            m_inFirstResultSet = true;
+            m_pending = std::move(result);
+            m_pendingRow = 0;
+            return true;
+        case PGRES_TUPLES_OK:
+            // Row-returning statement that produced no rows.
+            takeRowDescription(result.get());
+            m_described = true;
+            return true;
+        case PGRES_COMMAND_OK:
+        case PGRES_EMPTY_QUERY:
+            continue;
+        default:
+            if (resendAsSimpleQuery(result.get())) {
+                if (m_atEnd) {
+                    return false;
+                }
+                continue;
+            }
+            fail(result.get());
+            return false;
+        }
+    }
+}
+
+DatasetPage PostgresResultCursor::fetchNext(int batchSize) {
+    DatasetPage page;
+    if (batchSize <= 0) {
+        batchSize = 100;
+    }
+    int rowsInPage = 0;
+
+    while (!m_atEnd && rowsInPage < batchSize) {
+        if (!m_pending) {
+            // Non-blocking: only results poll() already received.
+            if (m_nonBlocking && PQisBusy(m_conn)) {
+                break;
+            }
+            m_pending.reset(PQgetResult(m_conn));
+            m_pendingRow = 0;
+            if (!m_pending) {
+                m_atEnd = true;
+                break;
+            }
+        }
+
+        const PGresult* result = m_pending.get();
+        switch (PQresultStatus(result)) {
+        case PGRES_SINGLE_TUPLE:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+        case PGRES_TUPLES_CHUNK:
+#endif
+            if (!m_described) {
+                takeRowDescription(result);
+                m_described = true;
+                m_inFirstResultSet = true;
+            }
+            // Rows of later statements in a script are not shown, only consumed.
+            if (m_inFirstResultSet) {
+                const int total = PQntuples(result);
+                const int columnCount = static_cast<int>(m_readers.size());
+                if (page.columnData.empty()) {
+                    page.columnData.reserve(columnCount);
+                    for (const auto& reader : m_readers) {
+                        page.columnData.emplace_back(reader.storage);
+                        page.columnData.back().reserve(batchSize);
+                    }
+                }
+                while (m_pendingRow < total && rowsInPage < batchSize) {
+                    if (checkLimits()) {
+                        break;
+                    }
+                    for (int c = 0; c < columnCount; ++c) {
+                        if (PQgetisnull(result, m_pendingRow, c)) {
+                            page.columnData[c].appendNull();
+                        } else {
+                            const int length = PQgetlength(result, m_pendingRow, c);
+                            m_bytesRead += length;
+                            m_readers[c].read(page.columnData[c], PQgetvalue(result, m_pendingRow, c), length);
+                        }
+                    }
+                    ++rowsInPage;
+                    ++m_pendingRow;
+                    ++m_rowsRead;
+                }
+                if (m_atEnd) {
+                    break;
+                }
+                if (m_pendingRow < total) {
+                    continue;
+                }
+            }
+            m_pending.reset();
+            break;
+        case PGRES_TUPLES_OK:
+            if (!m_described) {
+                takeRowDescription(result);
+                m_described = true;
+            }
+            m_inFirstResultSet = false;
+            m_pending.reset();
+            break;
+        case PGRES_COMMAND_OK:
+        case PGRES_EMPTY_QUERY:
+            m_pending.reset();
+            break;
+        default:
+            if (!m_described && resendAsSimpleQuery(result)) {
+                break;
+            }
+            fail(result);
+            break;
+        }
+    }
+
+    page.warning = m_error.isEmpty() ? m_limitWarning : m_error;
+    page.hasMore = !m_atEnd || !m_limitWarning.isEmpty();
+    page.executionTimeMs = QDateTime::currentMSecsSinceEpoch() - m_startedAtMs;
+    if (m_atEnd) {
+        qInfo() << "\x1b[32m✅ PG stream\x1b[0m colunas:" << m_columns.size() << "linhas:" << m_rowsRead << "bytes:" << m_bytesRead << "ms:" << page.executionTimeMs;
+    }
+    return page;
+}
+
+bool PostgresResultCursor::poll() {
+    if (m_atEnd) {
+        return true;
+    }
+    if (m_flushPending) {
+        const int flushed = PQflush(m_conn);
+        m_flushPending = flushed == 1;
+        if (flushed < 0) {
+            m_error = QString::fromUtf8(PQerrorMessage(m_conn)).trimmed();
+            m_atEnd = true;
+            return false;
+        }
+    }
+    if (!PQconsumeInput(m_conn)) {
+        m_error = QString::fromUtf8(PQerrorMessage(m_conn)).trimmed();
+        qWarning() << "\x1b[31m❌ PG stream\x1b[0m erro:" << m_error;
+        m_atEnd = true;
+        return false;
+    }
+    return true;
+}
+
+void PostgresResultCursor::close() {
+    if (!m_conn) {
+        return;
+    }
+    if (!m_atEnd) {
+        // Stop the server from producing the rest of the result instead of reading it all.
+        m_pending.reset();
+        if (PGcancel* cancel = PQgetCancel(m_conn)) {
+            char errorBuffer[256];
+            PQcancel(cancel, errorBuffer, sizeof(errorBuffer));
+            PQfreeCancel(cancel);
+        }
+        drain();
+        m_atEnd = true;
+        qInfo() << "\x1b[33m⏹️ PG stream\x1b[0m fechado antes do fim";
+    }
+    if (m_nonBlocking) {
+        // QtSql expects a blocking connection once the session returns to the pool.
+        PQsetnonblocking(m_conn, 0);
+        m_nonBlocking = false;
+        m_flushPending = false;
+    }
+}
+
+std::unique_ptr<IResultCursor> PostgresQueryProvider::openCursor(const QString& queryStr, const QueryLimits& limits) {
+    PGconn* conn = idleHandle(m_connectionName);
+    if (!conn) {
+        return nullptr;
+    }
+    auto cursor = std::make_unique<PostgresResultCursor>(conn, queryStr, m_binaryResults, limits);
+    cursor->start();
+    return cursor;
+}
+
+std::unique_ptr<IAsyncResultCursor> PostgresQueryProvider::openAsyncCursor(const QString& queryStr, const QueryLimits& limits) {
+    PGconn* conn = idleHandle(m_connectionName);
+    if (!conn) {
+        return nullptr;
+    }
+    auto cursor = std::make_unique<PostgresResultCursor>(conn, queryStr, m_binaryResults, limits, true);
+    cursor->start();
+    return cursor;
+}
+
+// --- PostgresCopyInWriter ---
+
+namespace {
+constexpr qsizetype kCopyBufferBytes = 256 * 1024;
+}
+
+void appendCopyValue(QByteArray& buffer, const QVariant& value)
+{
+    if (value.isNull()) {
+        buffer.append("\\N");
+        return;
+    }
+    const QByteArray text = value.toString().toUtf8();
+    for (const char c : text) {
+        switch (c) {
+        case '\\': buffer.append("\\\\"); break;
+        case '\t': buffer.append("\\t"); break;
+        case '\n': buffer.append("\\n"); break;
+        case '\r': buffer.append("\\r"); break;
+        default: buffer.append(c); break;
+        }
+    }
+}
+
+PostgresCopyInWriter::PostgresCopyInWriter(PGconn* conn)
+    : m_conn(conn) {}
+
+PostgresCopyInWriter::~PostgresCopyInWriter() {
+    if (m_active) {
+        abort("Import closed");
+    }
+}
+
+bool PostgresCopyInWriter::start(const QString& schema, const QString& table, const QStringList& columns) {
+    QStringList quoted;
+    for (const QString& column : columns) {
+        quoted << quoteIdentifier(column);
+    }
+    const QString sql = QString("COPY %1.%2 (%3) FROM STDIN")
+                            .arg(quoteIdentifier(schema), quoteIdentifier(table), quoted.join(", "));
+    qInfo() << "\x1b[36m📥 PG copy\x1b[0m" << sql;
+
+    PgResultPtr result(PQexec(m_conn, sql.toUtf8().constData()));
+    if (PQresultStatus(result.get()) != PGRES_COPY_IN) {
+        m_error = resultErrorMessage(result.get(), m_conn);
+        qWarning() << "\x1b[31m❌ PG copy\x1b[0m erro:" << m_error;
+        return false;
+    }
+    m_active = true;
+    m_buffer.reserve(kCopyBufferBytes + 4096);
+    return true;
+}
+
+bool PostgresCopyInWriter::writeRows(const std::vector<std::vector<QVariant>>& rows) {
+    if (!m_active) {
+        return false;
+    }
+    for (const auto& row : rows) {
+        for (size_t c = 0; c < row.size(); ++c) {
+            if (c > 0) {
+                m_buffer.append('\t');
+            }
+            appendCopyValue(m_buffer, row[c]);
+        }
+        m_buffer.append('\n');
+        if (m_buffer.size() >= kCopyBufferBytes && !flush()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PostgresCopyInWriter::flush() {
+    if (m_buffer.isEmpty()) {
+        return true;
+    }
+    if (PQputCopyData(m_conn, m_buffer.constData(), static_cast<int>(m_buffer.size())) != 1) {
+        // The server ended the COPY (error or cancel); the reason comes with the result.
+        m_active = false;
+        m_buffer.clear();
+        readCommandResult();
+        return false;
+    }
+    m_buffer.clear();
+    return true;
+}
+
+long long PostgresCopyInWriter::readCommandResult() {
+    long long rows = -1;
+    while (PGresult* raw = PQgetResult(m_conn)) {
+        PgResultPtr result(raw);
+        const ExecStatusType status = PQresultStatus(raw);
+        if (status == PGRES_COMMAND_OK) {
+            rows = QByteArray(PQcmdTuples(raw)).toLongLong();
+        } else if (status == PGRES_COPY_IN) {
+            PQputCopyEnd(m_conn, "COPY aborted");
+        } else if (m_error.isEmpty()) {
+            m_error = resultErrorMessage(raw, m_conn);
+        }
+    }
+    if (m_error.isEmpty() && rows < 0) {
+        m_error = QString::fromUtf8(PQerrorMessage(m_conn)).trimmed();
+    }
+    return m_error.isEmpty() ? rows : -1;
+}
+
+long long PostgresCopyInWriter::finish() {
+    if (!m_active) {
+        return -1;
+    }
+    if (!flush()) {
+        return -1;
+    }
+    m_active = false;
+    if (PQputCopyEnd(m_conn, nullptr) != 1) {
+        m_error = QString::fromUtf8(PQerrorMessage(m_conn)).trimmed();
+    }
+    const long long rows = readCommandResult();
+    if (rows >= 0) {
+        qInfo() << "\x1b[32m✅ PG copy\x1b[0m linhas:" << rows;
+    } else {
+        qWarning() << "\x1b[31m❌ PG copy\x1b[0m erro:" << m_error;
+    }
+    return rows;
+}
+
+void PostgresCopyInWriter::abort(const QString& reason) {
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+    m_buffer.clear();
+    // Rolls the whole COPY back on the server.
+    PQputCopyEnd(m_conn, reason.toUtf8().constData());
+    readCommandResult();
+    qInfo() << "\x1b[33m⏹️ PG copy\x1b[0m abortado:" << reason;
+}
+
+std::unique_ptr<IBulkWriter> PostgresQueryProvider::openBulkWriter(const QString& schema, const QString& table, const QStringList& columns, QString* error) {
+    PGconn* conn = idleHandle(m_connectionName);
+    if (!conn) {
+        if (error) *error = "Connection is not open";
+        return nullptr;
+    }
+    auto writer = std::make_unique<PostgresCopyInWriter>(conn);
+    if (!writer->start(schema, table, columns)) {
+        if (error) *error = writer->lastError();
+        return nullptr;
+    }
+    return writer;
+}
+
+// --- PostgresCopyOutReader ---
+
+PostgresCopyOutReader::PostgresCopyOutReader(PGconn* conn)
+    : m_conn(conn) {}
+
+PostgresCopyOutReader::~PostgresCopyOutReader() {
+    close();
+}
+
+bool PostgresCopyOutReader::start(const QString& selectSql, CopyFormat format, const QString& snapshot) {
+    if (!snapshot.isEmpty()) {
+        // SET TRANSACTION SNAPSHOT must come before any query of the transaction.
+        const QString adopt = QString("SET TRANSACTION SNAPSHOT '%1'").arg(QString(snapshot).replace("'", "''"));
+        PgResultPtr begin(PQexec(m_conn, "BEGIN ISOLATION LEVEL REPEATABLE READ, READ ONLY"));
+        m_inTransaction = PQresultStatus(begin.get()) == PGRES_COMMAND_OK;
+        PgResultPtr adopted(m_inTransaction ? PQexec(m_conn, adopt.toUtf8().constData()) : nullptr);
+        if (!m_inTransaction || PQresultStatus(adopted.get()) != PGRES_COMMAND_OK) {
+            m_error = resultErrorMessage(m_inTransaction ? adopted.get() : begin.get(), m_conn);
+            endTransaction();
+            m_atEnd = true;
+            return false;
+        }
+    }
+
+    const QString describeSql = QString("SELECT * FROM (%1\n) sofa_export LIMIT 0").arg(selectSql);
+    PgResultPtr described(PQexec(m_conn, describeSql.toUtf8().constData()));
+    if (PQresultStatus(described.get()) != PGRES_TUPLES_OK) {
+        m_error = resultErrorMessage(described.get(), m_conn);
+        endTransaction();
+        m_atEnd = true;
+        return false;
+    }
+    m_columns = columnsFromResult(described.get());
+
+    QString options;
+    if (format == CopyFormat::Csv) {
+        options = " WITH (FORMAT csv, HEADER)";
+    } else if (format == CopyFormat::CsvNoHeader) {
+        options = " WITH (FORMAT csv)";
+    }
+    const QString sql = QString("COPY (%1\n) TO STDOUT%2").arg(selectSql, options);
+    qInfo() << "\x1b[36m📤 PG copy\x1b[0m" << sql;
+    PgResultPtr result(PQexec(m_conn, sql.toUtf8().constData()));
+    if (PQresultStatus(result.get()) != PGRES_COPY_OUT) {
+        m_error = resultErrorMessage(result.get(), m_conn);
+        qWarning() << "\x1b[31m❌ PG copy\x1b[0m erro:" << m_error;
+        endTransaction();
+        m_atEnd = true;
+        return false;
+    }
+    m_active = true;
+    m_headerPending = format == CopyFormat::Csv;
+    return true;
+}
+
+void PostgresCopyOutReader::endTransaction() {
+    if (!m_inTransaction) {
+        return;
+    }
+    // Read-only: after a failure COMMIT simply rolls back.
+    PgResultPtr done(PQexec(m_conn, "COMMIT"));
+    m_inTransaction = false;
+}
+
+QByteArray PostgresCopyOutReader::read(qsizetype maxBytes, int* rows) {
+    QByteArray out;
+    int count = 0;
+    while (m_active && out.size() < maxBytes) {
+        char* buffer = nullptr;
+        const int length = PQgetCopyData(m_conn, &buffer, 0);
+        if (length < 0) {
+            // -1: all rows sent; -2: the COPY failed. Either way the result says which.
+            readCommandResult();
+            break;
+        }
+        out.append(buffer, length);
+        PQfreemem(buffer);
+        if (m_headerPending) {
+            m_headerPending = false;
+        } else {
+            ++count;
+        }
+    }
+    if (rows) *rows = count;
+    return out;
+}
+
+void PostgresCopyOutReader::readCommandResult() {
+    m_active = false;
+    m_atEnd = true;
+    while (PGresult* raw = PQgetResult(m_conn)) {
+        PgResultPtr result(raw);
+        if (PQresultStatus(raw) != PGRES_COMMAND_OK && m_error.isEmpty()) {
+            m_error = resultErrorMessage(raw, m_conn);
+        }
+    }
+    endTransaction();
+    if (m_error.isEmpty()) {
+        qInfo() << "\x1b[32m✅ PG copy\x1b[0m exportado";
+    } else {
+        qWarning() << "\x1b[31m❌ PG copy\x1b[0m erro:" << m_error;
+    }
+}
+
+void PostgresCopyOutReader::close() {
+    if (!m_active) {
+        return;
+    }
+    // Stop the server instead of reading the rest of the table.
+    if (PGcancel* cancel = PQgetCancel(m_conn)) {
+        char errorBuffer[256];
+        PQcancel(cancel, errorBuffer, sizeof(errorBuffer));
+        PQfreeCancel(cancel);
+    }
+    char* buffer = nullptr;
+    int length = 0;
+    while ((length = PQgetCopyData(m_conn, &buffer, 0)) > 0) {
+        PQfreemem(buffer);
+    }
+    m_active = false;
+    m_atEnd = true;
+    while (PGresult* raw = PQgetResult(m_conn)) {
+        PQclear(raw);
+    }
+    endTransaction();
+    qInfo() << "\x1b[33m⏹️ PG copy\x1b[0m fechado antes do fim";
+}
+
+std::unique_ptr<ICopyOutReader> PostgresQueryProvider::openCopyOut(const CopySource& source, CopyFormat format, QString* error) {
+    PGconn* conn = idleHandle(m_connectionName);
+    if (!conn) {
+        if (error) *error = "Connection is not open";
+        return nullptr;
+    }
+
+    // COPY takes a single statement without the terminator.
+    QString selectSql = source.sql.trimmed();
+    while (selectSql.endsWith(';')) {
+        selectSql.chop(1);
+        selectSql = selectSql.trimmed();
+    }
+    if (selectSql.isEmpty()) {
+        selectSql = QString("SELECT * FROM %1.%2").arg(quoteIdentifier(source.schema), quoteIdentifier(source.table));
+        if (!source.filter.trimmed().isEmpty()) {
+            selectSql += QString(" WHERE %1").arg(source.filter.trimmed());
+        }
+    }
+
+    auto reader = std::make_unique<PostgresCopyOutReader>(conn);
+    if (!reader->start(selectSql, format, source.snapshot)) {
+        if (error) *error = reader->lastError();
+        return nullptr;
+    }
+    return reader;
+}
+
+QString PostgresQueryProvider::exportSnapshot(QString* error) {
+    PGconn* conn = idleHandle(m_connectionName);
+    if (!conn) {
+        if (error) *error = "Connection is not open";
+        return QString();
+    }
+    releaseSnapshot();
+    PgResultPtr begin(PQexec(conn, "BEGIN ISOLATION LEVEL REPEATABLE READ, READ ONLY"));
+    if (PQresultStatus(begin.get()) != PGRES_COMMAND_OK) {
+        if (error) *error = resultErrorMessage(begin.get(), conn);
+        return QString();
+    }
+    m_snapshotOpen = true;
+    PgResultPtr result(PQexec(conn, "SELECT pg_export_snapshot()"));
+    if (PQresultStatus(result.get()) != PGRES_TUPLES_OK || PQntuples(result.get()) != 1) {
+        if (error) *error = resultErrorMessage(result.get(), conn);
+        releaseSnapshot();
+        return QString();
+    }
+    return QString::fromUtf8(PQgetvalue(result.get(), 0, 0));
+}
+
+void PostgresQueryProvider::releaseSnapshot() {
+    if (!m_snapshotOpen) {
+        return;
+    }
+    m_snapshotOpen = false;
+    if (PGconn* conn = nativeHandle(m_connectionName)) {
+        PgResultPtr done(PQexec(conn, "COMMIT"));
+    }
+}
+
+std::vector<CopySource> PostgresQueryProvider::planExportRanges(const CopySource& source, int parts) {
+    PGconn* conn = idleHandle(m_connectionName);
+    if (!conn || parts < 2 || !source.sql.trimmed().isEmpty()) {
+        return {};
+    }
+
+    const QByteArray relation = (quoteIdentifier(source.schema) + "." + quoteIdentifier(source.table)).toUtf8();
+    const char* relationParams[] = { relation.constData() };
+    PgResultPtr info(PQexecParams(conn, kExportRelationSql, 1, nullptr, relationParams, nullptr, nullptr, 0));
+    if (PQresultStatus(info.get()) != PGRES_TUPLES_OK || PQntuples(info.get()) != 1) {
+        return {};
+    }
+    const char relkind = PQgetvalue(info.get(), 0, 0)[0];
+    const long long blocks = QByteArray(PQgetvalue(info.get(), 0, 1)).toLongLong();
+    const QString columns = QString::fromUtf8(PQgetvalue(info.get(), 0, 2));
+    const QString filter = source.filter.trimmed();
+
+    auto rangeSource = [&](const QString& from, const QString& predicate) {
+        QStringList conditions;
+        if (!filter.isEmpty()) conditions << QString("(%1)").arg(filter);
+        if (!predicate.isEmpty()) conditions << predicate;
+        CopySource range;
+        range.sql = QString("SELECT %1 FROM %2").arg(columns, from);
+        if (!conditions.isEmpty()) range.sql += " WHERE " + conditions.join(" AND ");
+        return range;
+    };
+
+    std::vector<CopySource> ranges;
+    if (relkind == 'p') {
+        // Partitioned: leaf partitions, largest first, dealt to the least loaded
+        // range; each range reads its partitions with UNION ALL.
+        PgResultPtr leaves(PQexecParams(conn, kExportPartitionsSql, 1, nullptr, relationParams, nullptr, nullptr, 0));
+        const int leafCount = PQresultStatus(leaves.get()) == PGRES_TUPLES_OK ? PQntuples(leaves.get()) : 0;
+        if (leafCount < 2) {
+            return {};
+        }
+        parts = qMin(parts, leafCount);
+        std::vector<QStringList> selects(parts);
+        std::vector<long long> load(parts, 0);
+        for (int i = 0; i < leafCount; ++i) {
+            const auto target = std::min_element(load.begin(), load.end()) - load.begin();
+            selects[target] << rangeSource(QString::fromUtf8(PQgetvalue(leaves.get(), i, 0)), QString()).sql;
+            load[target] += QByteArray(PQgetvalue(leaves.get(), i, 1)).toLongLong() + 1;
+        }
+        for (const auto& group : selects) {
+            CopySource range;
+            range.sql = group.join("\nUNION ALL\n");
+            ranges.push_back(range);
+        }
+        return ranges;
+    }
+
+    // Small tables are not worth the extra connections.
+    parts = static_cast<int>(qMin<long long>(parts, blocks / kMinExportRangeBlocks));
+    if (parts < 2) {
+        return {};
+    }
+    const QString from = QString::fromUtf8(relation);
+
+    if (PQserverVersion(conn) >= 140000) {
+        // TID range scans (PG14+) read only their own blocks.
+        const long long step = blocks / parts;
+        for (int i = 0; i < parts; ++i) {
+            QStringList bounds;
+            if (i > 0) bounds << QString("ctid >= '(%1,0)'::tid").arg(i * step);
+            if (i < parts - 1) bounds << QString("ctid < '(%1,0)'::tid").arg((i + 1) * step);
+            ranges.push_back(rangeSource(from, bounds.join(" AND ")));
+        }
+        return ranges;
+    }
+
+    // Older servers would scan the whole table for every ctid range: split a
+    // single-column primary key on its ANALYZE histogram instead.
+    PgResultPtr histogram(PQexecParams(conn, kExportKeyHistogramSql, 1, nullptr, relationParams, nullptr, nullptr, 0));
+    const int boundCount = PQresultStatus(histogram.get()) == PGRES_TUPLES_OK ? PQntuples(histogram.get()) : 0;
+    if (boundCount < parts) {
+        return {};
+    }
+    const QString key = QString::fromUtf8(PQgetvalue(histogram.get(), 0, 0));
+    const QString type = QString::fromUtf8(PQgetvalue(histogram.get(), 0, 1));
+    auto bound = [&](int part) {
+        const QString value = QString::fromUtf8(PQgetvalue(histogram.get(), part * boundCount / parts, 2));
+        return QString("'%1'::%2").arg(QString(value).replace("'", "''"), type);
+    };
+    for (int i = 0; i < parts; ++i) {
+        QStringList bounds;
+        if (i > 0) bounds << QString("%1 >= %2").arg(key, bound(i));
+        if (i < parts - 1) bounds << QString("%1 < %2").arg(key, bound(i + 1));
+        ranges.push_back(rangeSource(from, bounds.join(" AND ")));
+    }
+    return ranges;
+}
+
+// --- PostgresNativeQueryProvider ---
+
+PostgresNativeQueryProvider::PostgresNativeQueryProvider(const QString& connectionName, std::shared_ptr<PostgresStatementCache> statements)
+    : PostgresQueryProvider(connectionName, std::move(statements)) {
+    m_binaryResults = true;
+}
+
+DatasetPage PostgresNativeQueryProvider::execute(const QString& queryStr, const DatasetRequest& request) {
+    PGconn* conn = idleHandle(m_connectionName);
+    if (!conn) {
+        return PostgresQueryProvider::execute(queryStr, request);
+    }
+
+    DatasetPage page;
+    qint64 startTime = QDateTime::currentMSecsSinceEpoch();
+    qInfo() << "\x1b[36m🔎 PG libpq\x1b[0m query:" << queryStr;
+
+    const QByteArray sql = queryStr.toUtf8();
+    // Binary wire format unless a column's type has no binary decoder.
+    bool binary = false;
+    PgResultPtr result;
+    if (prepareUnnamed(conn, sql, &binary, &result)) {
+        result.reset(PQexecPrepared(conn, "", 0, nullptr, nullptr, nullptr, binary ? 1 : 0));
+    }
+    const ExecStatusType status = result ? PQresultStatus(result.get()) : PGRES_FATAL_ERROR;
+
+    if (status == PGRES_COMMAND_OK || status == PGRES_EMPTY_QUERY) {
+        page.executionTimeMs = QDateTime::currentMSecsSinceEpoch() - startTime;
+        qInfo() << "\x1b[32m✅ PG libpq\x1b[0m comando ok ms:" << page.executionTimeMs;
+        return page;
+    }
+
+    if (status != PGRES_TUPLES_OK) {
+        // The extended protocol rejects multi-statement scripts with a syntax
+        // error; the simple protocol used by QPSQL handles them.
+        if (resultSqlState(result.get()) == "42601" && queryStr.contains(';')) {
+            qInfo() << "\x1b[33m↩️ PG libpq\x1b[0m fallback para QPSQL";
+            return PostgresQueryProvider::execute(queryStr, request);
+        }
+        page.warning = resultErrorMessage(result.get(), conn);
+        qWarning() << "\x1b[31m❌ PG libpq\x1b[0m erro ao executar query:" << page.warning;
+        return page;
+    }
+
+    page = datasetFromResult(result.get(), request.limit, binary, request.limits);
+    page.executionTimeMs = QDateTime::currentMSecsSinceEpoch() - startTime;
+    qInfo() << "\x1b[32m✅ PG libpq\x1b[0m colunas:" << page.columns.size() << "linhas:" << page.rowCount() << "ms:" << page.executionTimeMs;
+    return page;
+}
+
+bool PostgresConnection::cancelQuery(int backendPid) {
+    if (backendPid <= 0) return false;
+    if (m_connectionName.isEmpty()) return false;
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    if (!db.isOpen()) return false;
+    QSqlQuery q(db);
+    q.prepare("SELECT pg_cancel_backend(:pid)");
+    q.bindValue(":pid", backendPid);
+    if (!q.exec()) {
+        m_lastError = q.lastError().text();
+        return false;
+    }
+    if (q.next()) {
+        return q.value(0).toBool();
+    }
+    return false;
+}
+
+// --- PostgresAddon ---
+
+std::shared_ptr<IConnectionProvider> PostgresAddon::createConnection() {
+    return std::make_shared<PostgresConnection>(m_nativeProtocol);
+}
+
+std::unique_ptr<ICancelHandle> PostgresConnection::cancelHandle() {
+    PGconn* conn = nativeHandle(m_connectionName);
+    if (!conn) return nullptr;
+    PGcancel* cancel = PQgetCancel(conn);
+    if (!cancel) return nullptr;
+    return std::make_unique<PostgresCancelHandle>(cancel);
+}
+
+// --- PostgresCancelHandle ---
+
+PostgresCancelHandle::~PostgresCancelHandle() {
+    if (m_cancel) {
+        PQfreeCancel(m_cancel);
+    }
+}
+
+bool PostgresCancelHandle::cancel(QString* error) {
+    char errorBuffer[256];
+    if (!PQcancel(m_cancel, errorBuffer, sizeof(errorBuffer))) {
+        if (error) *error = QString::fromUtf8(errorBuffer).trimmed();
+        qWarning() << "\x1b[31m❌ PG cancel\x1b[0m" << errorBuffer;
+        return false;
+    }
+    qInfo() << "\x1b[33m⏹️ PG cancel\x1b[0m enviado";
+    return true;
 }
 
 }
@@ -1,42 +1,311 @@
 #pragma once
 #include "addons/IAddon.h"
+#include "PostgresLibpq.h"
+#include <QHash>
+#include <QSet>
 #include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <map>
+#include <memory>
 #include <vector>
 #include <QSqlDatabase>
 #include <QSqlError>
 
+class QSqlQuery;
+
 namespace Sofa::Addons::Postgres {
 
 using namespace Sofa::Core;
 
+// Named server-side prepared statements for the fixed catalog/metadata queries
+// of one session. Lives exactly as long as the QSqlDatabase it prepares on:
+// PostgresConnection creates it in open() and clears it in close(), so a
+// recycled connection never reuses a statement from the old backend.
+class PostgresStatementCache {
+public:
+    explicit PostgresStatementCache(const QString& connectionName);
+    ~PostgresStatementCache();
+
+    // Binds the named values and executes the statement cached under key,
+    // preparing sql on the first use. Returns nullptr on failure (see lastError()).
+    // The query stays owned by the cache and is valid until the next run() of the same key.
+    QSqlQuery* run(const QString& key, const QString& sql, const QVariantMap& bindings = QVariantMap());
+    void clear();
+
+    quint64 hits() const { return m_hits; }
+    quint64 misses() const { return m_misses; }
+    QString lastError() const { return m_lastError; }
+
+private:
+    struct Entry {
+        std::unique_ptr<QSqlQuery> query;
+        quint64 lastUsed = 0;
+    };
+
+    QSqlQuery* prepared(const QString& key, const QString& sql);
+    void evictLeastRecentlyUsed();
+
+    QString m_connectionName;
+    std::map<QString, Entry> m_statements;
+    quint64 m_useCounter = 0;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+    QString m_lastError;
+};
+
+// Streams a result through libpq's chunked (PG17+) or single-row mode on the
+// session's PGconn, so only the rows of the current batch are held in memory.
+// In non-blocking mode the connection is switched to PQsetnonblocking until the
+// cursor closes, and fetchNext() stops at the first result libpq hasn't read yet.
+class PostgresResultCursor : public IAsyncResultCursor {
+public:
+    PostgresResultCursor(PGconn* conn, const QString& query, bool binaryResults, const QueryLimits& limits = QueryLimits(), bool nonBlocking = false);
+    ~PostgresResultCursor() override;
+
+    // Sends the query; in blocking mode also waits for the row description.
+    // False on failure.
+    bool start();
+    QString lastError() const { return m_error; }
+
+    const std::vector<Column>& columns() const override { return m_columns; }
+    DatasetPage fetchNext(int batchSize) override;
+    bool atEnd() const override { return m_atEnd; }
+    void close() override;
+
+    qintptr socket() const override { return PQsocket(m_conn); }
+    bool wantsWrite() const override { return m_flushPending; }
+    bool poll() override;
+
+private:
+    bool send();
+    // The extended protocol rejects multi-statement scripts (42601); resends them
+    // as a simple query. False when the error is something else.
+    bool resendAsSimpleQuery(const PGresult* result);
+    void enableRowMode();
+    void takeRowDescription(const PGresult* result);
+    void fail(const PGresult* result);
+    void drain();
+    // Stops the statement once limits.maxRows/maxBytes is used up; true when it tripped.
+    bool checkLimits();
+
+    PGconn* m_conn = nullptr;
+    QString m_query;
+    bool m_binary = false;
+    bool m_nonBlocking = false;
+    bool m_flushPending = false;
+    bool m_atEnd = false;
+    // True once the first row-returning statement's description was read.
+    bool m_described = false;
+    // True while results still belong to the first row-returning statement.
+    bool m_inFirstResultSet = false;
+    std::vector<Column> m_columns;
+    std::vector<ColumnReader> m_readers;
+    PgResultPtr m_pending;
+    int m_pendingRow = 0;
+    QString m_error;
+    qint64 m_startedAtMs = 0;
+    QueryLimits m_limits;
+    long long m_rowsRead = 0;
+    long long m_bytesRead = 0;
+    QString m_limitWarning; // set when a limit stopped the stream; implies more rows existed
+};
+
+// One value in COPY text format: \N for NULL, backslash escapes for the
+// backslash, tab, newline and carriage return. No delimiter is added.
+void appendCopyValue(QByteArray& buffer, const QVariant& value);
+
+// COPY schema.table (columns) FROM STDIN in text format on the session's
+// PGconn. Rows are encoded into a buffer that goes out in ~256 KiB
+// PQputCopyData calls; a cancel or server error fails the next write.
+class PostgresCopyInWriter : public IBulkWriter {
+public:
+    explicit PostgresCopyInWriter(PGconn* conn);
+    ~PostgresCopyInWriter() override;
+
+    bool start(const QString& schema, const QString& table, const QStringList& columns);
+    bool writeRows(const std::vector<std::vector<QVariant>>& rows) override;
+    long long finish() override;
+    void abort(const QString& reason) override;
+    QString lastError() const override { return m_error; }
+
+private:
+    bool flush();
+    long long readCommandResult();
+
+    PGconn* m_conn = nullptr;
+    QByteArray m_buffer;
+    bool m_active = false;
+    QString m_error;
+};
+
+// COPY (select) TO STDOUT on the session's PGconn. The columns come from a
+// LIMIT 0 run of the same select, so formatters know the types up front.
+class PostgresCopyOutReader : public ICopyOutReader {
+public:
+    explicit PostgresCopyOutReader(PGconn* conn);
+    ~PostgresCopyOutReader() override;
+
+    // With a snapshot, the COPY runs in a read-only transaction that adopts it.
+    bool start(const QString& selectSql, CopyFormat format, const QString& snapshot = QString());
+
+    const std::vector<Column>& columns() const override { return m_columns; }
+    QByteArray read(qsizetype maxBytes, int* rows) override;
+    bool atEnd() const override { return m_atEnd; }
+    QString lastError() const override { return m_error; }
+    void close() override;
+
+private:
+    void readCommandResult();
+    void endTransaction();
+
+    PGconn* m_conn = nullptr;
+    std::vector<Column> m_columns;
+    bool m_inTransaction = false;
+    bool m_active = false;
+    bool m_atEnd = false;
+    bool m_headerPending = false;
+    QString m_error;
+};
+
+// Column metadata getDataset adds on top of the result's own row description.
+// Memoized per table and reused while the table's catalog version (version)
+// stays the same.
+struct PostgresTableMetadata {
+    quint32 oid = 0;
+    QString version;
+    QHash<QString, QString> sqlTypeByColumn;
+    QHash<QString, bool> isNullableByColumn;
+    QHash<QString, QString> defaultValueByColumn;
+    QSet<QString> primaryKeyColumns;
+    QStringList primaryKeyOrder; // key columns in constraint order
+    // Every column type has a binary decoder, so pages may use binary format.
+    bool binaryResults = true;
+};
+
+class PostgresQueryProvider;
+
+// Keyset tokens are opaque to callers: base64url JSON holding the ordering they
+// were made for and the last row's key values, as text.
+QString encodeKeysetCursor(const DatasetRequest& request, const QStringList& keyColumns, const QStringList& values);
+// Returns the seek values, or nothing when the token is absent or was made for another ordering.
+QStringList decodeKeysetCursor(const QString& cursor, const DatasetRequest& request, const QStringList& keyColumns);
+
+// SCROLL cursor declared inside a read-only transaction that stays open on the
+// connection. Each page is MOVE ABSOLUTE + FETCH; the server moves relative to
+// the current position, so next/previous page cost does not grow with depth.
+class PostgresDatasetPager : public IDatasetPager {
+public:
+    PostgresDatasetPager(PostgresQueryProvider* provider, const QString& connectionName, PostgresTableMetadata metadata);
+    ~PostgresDatasetPager() override;
+
+    bool open(const QString& selectSql, QString* error);
+    DatasetPage fetchPage(int offset, int limit) override;
+    void close() override;
+
+private:
+    bool exec(const QString& sql, QString* error);
+
+    PostgresQueryProvider* m_provider = nullptr;
+    QString m_connectionName;
+    QString m_cursorName;
+    PostgresTableMetadata m_metadata;
+    bool m_open = false;
+};
+
 class PostgresQueryProvider : public IQueryProvider {
 public:
-    explicit PostgresQueryProvider(const QString& connectionName);
+    PostgresQueryProvider(const QString& connectionName, std::shared_ptr<PostgresStatementCache> statements);
     DatasetPage execute(const QString& query, const DatasetRequest& request) override;
+    std::unique_ptr<IResultCursor> openCursor(const QString& query, const QueryLimits& limits = QueryLimits()) override;
+    std::unique_ptr<IAsyncResultCursor> openAsyncCursor(const QString& query, const QueryLimits& limits = QueryLimits()) override;
+    std::unique_ptr<IBulkWriter> openBulkWriter(const QString& schema, const QString& table, const QStringList& columns, QString* error) override;
+    std::unique_ptr<ICopyOutReader> openCopyOut(const CopySource& source, CopyFormat format, QString* error) override;
+    // ctid block ranges (PG14+), primary-key histogram ranges before that, or
+    // groups of leaf partitions for a partitioned table.
+    std::vector<CopySource> planExportRanges(const CopySource& source, int parts) override;
+    QString exportSnapshot(QString* error) override;
+    void releaseSnapshot() override;
     DatasetPage getDataset(const QString& schema, const QString& table, const DatasetRequest& request) override;
+    std::unique_ptr<IDatasetPager> openPager(const QString& schema, const QString& table, const DatasetRequest& request) override;
     int count(const QString& schema, const QString& table) override;
+    RowCount countRows(const QString& schema, const QString& table, const QString& filter, CountStrategy strategy) override;
     int backendPid() override;
+    bool setStatementTimeout(int timeoutMs) override;
+
+    static void decorateDatasetColumns(std::vector<Column>& columns, const PostgresTableMetadata& metadata);
+
+protected:
+    // Memoized metadata after a version check; a full reload when the version moved.
+    PostgresTableMetadata loadTableMetadata(const QString& schema, const QString& table);
+    // Sends metadata, data (and count) in one libpq pipeline; false when the
+    // pipeline is unavailable and the sequential path should run instead.
+    bool getPipelinedDataset(const QString& schema, const QString& table, const DatasetRequest& request, DatasetPage* page);
+    static PostgresTableMetadata metadataFromResult(const PGresult* result);
+    // Row estimate from a kRelTuplesSql or EXPLAIN (FORMAT JSON) result; -1 when unknown.
+    static long long estimateFromResult(const PGresult* result, bool fromExplain);
+    static QStringList keysetColumns(const DatasetRequest& request, const PostgresTableMetadata& metadata);
+    // Full SQL for one page: keyset seek when the table allows it, LIMIT/OFFSET otherwise.
+    static QString datasetPageSql(const QString& schema, const QString& table, const DatasetRequest& request, const PostgresTableMetadata& metadata);
+    static QString keysetSelectSql(const QString& schema, const QString& table, const DatasetRequest& request, const QStringList& keyColumns);
+    static QString datasetSelectSql(const QString& schema, const QString& table, const DatasetRequest& request, const PostgresTableMetadata& metadata);
+    // Strips keyset helper columns, sets nextCursor and decorates the columns.
+    static void finishDatasetPage(DatasetPage& page, const DatasetRequest& request, const PostgresTableMetadata& metadata);
 
-private:
     QString m_connectionName;
+    std::shared_ptr<PostgresStatementCache> m_statements;
+    // Metadata per table (schema + 0x1f + table), reused while its version holds
+    // so a page costs one round trip (version check pipelined with the data).
+    QHash<QString, PostgresTableMetadata> m_lastMetadata;
+    int m_backendPid = -1;
+    bool m_binaryResults = false;
+    // Session statement_timeout last set through setStatementTimeout (0 = server default).
+    int m_statementTimeoutMs = 0;
+    // Transaction opened by exportSnapshot() and still holding the snapshot.
+    bool m_snapshotOpen = false;
+};
+
+// Runs queries straight on the session's PGconn with binary result format,
+// skipping QSqlQuery's per-value text parsing. Falls back to QPSQL for
+// anything the extended protocol can't take (e.g. multi-statement scripts).
+class PostgresNativeQueryProvider : public PostgresQueryProvider {
+public:
+    PostgresNativeQueryProvider(const QString& connectionName, std::shared_ptr<PostgresStatementCache> statements);
+    DatasetPage execute(const QString& query, const DatasetRequest& request) override;
 };
 
 class PostgresCatalogProvider : public ICatalogProvider {
 public:
-    explicit PostgresCatalogProvider(const QString& connectionName);
+    PostgresCatalogProvider(const QString& connectionName, std::shared_ptr<PostgresStatementCache> statements);
     std::vector<QString> listSchemas() override;
     std::vector<QString> listHiddenSchemas() override;
     std::vector<CatalogTable> listTables(const QString& schema) override;
+    bool streamTables(const QString& schema, int batchSize, const std::function<bool(std::vector<CatalogTable>&)>& onBatch) override;
     TableSchema getTableSchema(const QString& schema, const QString& table) override;
-    std::vector<TableIndex> getTableIndexes(const QString& schema, const QString& table) override;
+    std::vector<TableIndex> getTableIndexes(const QString& schema, const QString& table, QString* error = nullptr) override;
+    std::map<QString, std::vector<TableIndex>> getSchemaIndexes(const QString& schema, QString* error = nullptr) override;
+    QString catalogVersion() override;
 
 private:
     QString m_connectionName;
+    std::shared_ptr<PostgresStatementCache> m_statements;
+};
+
+// Holds the backend's cancel key (PQgetCancel), so cancelling needs neither the
+// session nor a second connection; PQcancel is safe from any thread.
+class PostgresCancelHandle : public ICancelHandle {
+public:
+    explicit PostgresCancelHandle(PGcancel* cancel) : m_cancel(cancel) {}
+    ~PostgresCancelHandle() override;
+    bool cancel(QString* error) override;
+
+private:
+    PGcancel* m_cancel = nullptr;
 };
 
 class PostgresConnection : public IConnectionProvider {
 public:
-    PostgresConnection();
+    explicit PostgresConnection(bool nativeProtocol = false);
     ~PostgresConnection();
 
     bool testConnection(const QString& host, int port, const QString& db, const QString& user, const QString& password) override;
@@ -44,23 +313,32 @@ public:
     void close() override;
     bool isOpen() const override;
     QString lastError() const override;
+    bool ping() override;
+    bool resetForReuse() override;
 
     std::shared_ptr<ICatalogProvider> catalog() override;
     std::shared_ptr<IQueryProvider> query() override;
     bool cancelQuery(int backendPid) override;
+    std::unique_ptr<ICancelHandle> cancelHandle() override;
 
 private:
     QString m_connectionName;
     QString m_lastError;
+    bool m_nativeProtocol = false;
+    std::shared_ptr<PostgresStatementCache> m_statements;
     std::shared_ptr<PostgresCatalogProvider> m_catalog;
     std::shared_ptr<PostgresQueryProvider> m_query;
 };
 
 class PostgresAddon : public IAddon {
 public:
-    QString id() const override { return "postgres"; }
-    QString name() const override { return "PostgreSQL"; }
+    explicit PostgresAddon(bool nativeProtocol = false) : m_nativeProtocol(nativeProtocol) {}
+    QString id() const override { return m_nativeProtocol ? "postgres_libpq" : "postgres"; }
+    QString name() const override { return m_nativeProtocol ? "PostgreSQL (libpq)" : "PostgreSQL"; }
     std::shared_ptr<IConnectionProvider> createConnection() override;
+
+private:
+    bool m_nativeProtocol = false;
 };
 
 }
@@ -42,6 +42,7 @@ int main(int argc, char *argv[])
 
     // Register Addons
     addonHost->registerAddon("postgres", std::make_shared<PostgresAddon>());
+    addonHost->registerAddon("postgres_libpq", std::make_shared<PostgresAddon>(true));
 
     // Register a test command
     commandService->registerCommand("test.hello", "Hello Command", [logger]() {
@@ -1,5 +1,6 @@
 import QtQuick
 import QtQuick.Controls
+import QtQuick.Dialogs
 import QtQuick.Layouts
 import QtQuick.Window
 import Qt5Compat.GraphicalEffects
@@ -626,11 +627,12 @@ ApplicationWindow {
             property bool empty: false
             property bool gridControlsVisible: true
             property string requestTag: ""
+            property string countRequestTag: ""
+            property string importRequestTag: ""
+            property string exportRequestTag: ""
             property int pageSize: 100
             property int pageIndex: 0
             property bool hasMore: false
-            property bool pendingLoad: false
-            property bool pendingLoadUseDelayed: false
             property string insertRequestTag: ""
             property bool insertRunning: false
             property string sortColumnName: ""
@@ -641,7 +643,50 @@ ApplicationWindow {
             property string appliedFilterClause: ""
             property bool requestInFlight: false
             property bool delayedLoadingForCurrentRequest: false
+            // Identifies this tab's server-side cursor when cursor paging is enabled.
+            property string pagingKey: ""
+            // Keyset tokens by page index: pageCursors[i] seeks to the first row of page i.
+            property var pageCursors: []
             
+            Component.onCompleted: {
+                tableRoot.pagingKey = "pager:" + Date.now() + ":" + Math.floor(Math.random() * 1000000)
+            }
+            Component.onDestruction: {
+                // Nobody is left to show these results: stop them on the server.
+                App.cancelRequest(tableRoot.requestTag, false)
+                App.cancelRequest(tableRoot.countRequestTag, false)
+                App.closeDatasetCursor(tableRoot.pagingKey)
+            }
+
+            function resetPager() {
+                App.closeDatasetCursor(tableRoot.pagingKey)
+            }
+
+            function runImport(fileUrl) {
+                var path = fileUrl.toString()
+                var lower = path.toLowerCase()
+                var format = (lower.endsWith(".tsv") || lower.endsWith(".tab")) ? "tsv" : "csv"
+                tableRoot.importRequestTag = "import_" + tableRoot.schema + "." + tableRoot.tableName + "_" + Date.now()
+                btnImport.isImporting = true
+                btnImport.tooltip = ""
+                btnImport.text = "Importing..."
+                App.importFileAsync(tableRoot.schema, tableRoot.tableName, path, { format: format, hasHeader: true }, tableRoot.importRequestTag)
+            }
+
+            // Exports the table with the filter currently applied to the grid.
+            function runExport(fileUrl) {
+                var path = fileUrl.toString()
+                var lower = path.toLowerCase()
+                var format = lower.endsWith(".jsonl") || lower.endsWith(".ndjson") ? "jsonl"
+                    : lower.endsWith(".sql") ? "sql" : "csv"
+                tableRoot.exportRequestTag = "export_" + tableRoot.schema + "." + tableRoot.tableName + "_" + Date.now()
+                btnExport.isExporting = true
+                btnExport.tooltip = ""
+                btnExport.text = "Exporting..."
+                App.exportAsync({ schema: tableRoot.schema, table: tableRoot.tableName, filter: tableRoot.appliedFilterClause },
+                                path, { format: format }, tableRoot.exportRequestTag)
+            }
+
             // Helper to get active connection color
             function getActiveConnectionColor() {
                 var currentId = App.activeConnectionId
@@ -697,107 +742,12 @@ ApplicationWindow {
                 sortActive = false
             }
 
-            function parseDateMs(value) {
-                if (value === null || value === undefined) return NaN
-                var parsed = Date.parse(String(value))
-                return isNaN(parsed) ? NaN : parsed
-            }
-
-            function compareCellValues(a, b, ascending) {
-                var aNull = (a === null || a === undefined)
-                var bNull = (b === null || b === undefined)
-                if (aNull || bNull) {
-                    if (aNull && bNull) return 0
-                    if (ascending) return aNull ? 1 : -1
-                    return aNull ? -1 : 1
-                }
-
-                if (typeof a === "number" && typeof b === "number") {
-                    return ascending ? (a - b) : (b - a)
-                }
-
-                if (typeof a === "boolean" && typeof b === "boolean") {
-                    if (a === b) return 0
-                    var boolCmp = a ? 1 : -1
-                    return ascending ? boolCmp : -boolCmp
-                }
-
-                var aDate = parseDateMs(a)
-                var bDate = parseDateMs(b)
-                if (!isNaN(aDate) && !isNaN(bDate)) {
-                    return ascending ? (aDate - bDate) : (bDate - aDate)
-                }
-
-                var aText = String(a).toLocaleLowerCase()
-                var bText = String(b).toLocaleLowerCase()
-                var textCmp = aText.localeCompare(bText)
-                return ascending ? textCmp : -textCmp
-            }
-
-            function sortDatasetLocally(dataset, columnName, ascending) {
-                if (!dataset || !dataset.columns || !dataset.rows || !columnName) return null
-
-                var sortIndex = -1
-                for (var i = 0; i < dataset.columns.length; i++) {
-                    if ((dataset.columns[i].name || "") === columnName) {
-                        sortIndex = i
-                        break
-                    }
-                }
-                if (sortIndex < 0) return null
-
-                var rows = dataset.rows ? dataset.rows.slice(0) : []
-                var nulls = dataset.nulls ? dataset.nulls.slice(0) : []
-                var zipped = []
-                for (var rowIndex = 0; rowIndex < rows.length; rowIndex++) {
-                    zipped.push({
-                        row: rows[rowIndex],
-                        nullRow: rowIndex < nulls.length ? nulls[rowIndex] : []
-                    })
-                }
-
-                zipped.sort(function(left, right) {
-                    var leftRow = left.row || []
-                    var rightRow = right.row || []
-                    var leftNullRow = left.nullRow || []
-                    var rightNullRow = right.nullRow || []
-                    var leftVal = sortIndex < leftRow.length ? leftRow[sortIndex] : null
-                    var rightVal = sortIndex < rightRow.length ? rightRow[sortIndex] : null
-                    var leftIsNull = (sortIndex < leftNullRow.length && leftNullRow[sortIndex] === true) || leftVal === null || leftVal === undefined
-                    var rightIsNull = (sortIndex < rightNullRow.length && rightNullRow[sortIndex] === true) || rightVal === null || rightVal === undefined
-                    return compareCellValues(leftIsNull ? null : leftVal, rightIsNull ? null : rightVal, ascending)
-                })
-
-                var sortedRows = []
-                var sortedNulls = []
-                for (var sortedIndex = 0; sortedIndex < zipped.length; sortedIndex++) {
-                    sortedRows.push(zipped[sortedIndex].row)
-                    sortedNulls.push(zipped[sortedIndex].nullRow)
-                }
-
-                return {
-                    "columns": dataset.columns,
-                    "rows": sortedRows,
-                    "nulls": sortedNulls,
-                    "hasMore": dataset.hasMore,
-                    "executionTime": dataset.executionTime,
-                    "warning": dataset.warning
-                }
-            }
-
             function applySortToCurrentDataset() {
-                if (!sortActive || !sortColumnName || !lastDatasetResult || !lastDatasetResult.columns) {
-                    if (lastDatasetResult && lastDatasetResult.columns) {
-                        gridEngine.loadFromVariant(lastDatasetResult)
-                    }
-                    return
-                }
-
-                var sorted = sortDatasetLocally(lastDatasetResult, sortColumnName, sortAscending)
-                if (sorted) {
-                    gridEngine.loadFromVariant(sorted)
-                } else {
-                    gridEngine.loadFromVariant(lastDatasetResult)
+                if (!lastDatasetResult || !lastDatasetResult.columns) return
+                gridEngine.loadFromVariant(lastDatasetResult)
+                var sortIndex = currentSortColumnIndex()
+                if (sortIndex >= 0) {
+                    gridEngine.sortByColumn(sortIndex, sortAscending)
                 }
             }
 
@@ -914,17 +864,6 @@ ApplicationWindow {
                 id: gridEngine
             }
 
-            Timer {
-                id: loadRetryTimer
-                interval: 150
-                repeat: false
-                onTriggered: {
-                    if (tableRoot.pendingLoad) {
-                        tableRoot.loadData(tableRoot.pendingLoadUseDelayed)
-                    }
-                }
-            }
-
             Timer {
                 id: loadingVisualDelayTimer
                 interval: 150
@@ -963,7 +902,10 @@ ApplicationWindow {
                         Layout.preferredWidth: 24
                         iconSize: 12
                         opacity: 0.8
-                        onClicked: tableRoot.loadData()
+                        onClicked: {
+                            App.invalidateRowCounts(schema, tableName)
+                            tableRoot.loadData()
+                        }
                     }
 
                     AppButton {
@@ -984,6 +926,8 @@ ApplicationWindow {
                         
                         property bool isLoading: false
                         property string originalText: "Count"
+                        // Label shown when no exact count is running (the estimate, or "Count").
+                        property string idleText: originalText
                         property var countStartTime: 0
                         
                         Timer {
@@ -1004,7 +948,19 @@ ApplicationWindow {
                         function finishLoading(total) {
                             isLoading = false
                             var suffix = (total === 1) ? " record" : " records"
-                            text = total + suffix
+                            idleText = total + suffix
+                            text = idleText
+                        }
+
+                        function showEstimate(total) {
+                            idleText = "~" + total + " records"
+                            if (!isLoading) text = idleText
+                        }
+
+                        function stopLoading() {
+                            delayTimer.stop()
+                            isLoading = false
+                            text = idleText
                         }
                         
                         // Custom content item to support loading animation
@@ -1048,12 +1004,15 @@ ApplicationWindow {
                         }
 
                         onClicked: {
-                            if (!isLoading) {
-                                isLoading = true
-                                countStartTime = Date.now()
-                                text = "loading..."
-                                tableRoot.runCount()
+                            if (isLoading) {
+                                // A running exact count can be a full scan; a second click stops it.
+                                App.cancelRequest(tableRoot.countRequestTag)
+                                return
                             }
+                            isLoading = true
+                            countStartTime = Date.now()
+                            text = "loading..."
+                            tableRoot.runCount()
                         }
                     }
 
@@ -1085,6 +1044,78 @@ ApplicationWindow {
                         onClicked: root.openIndexes(tableRoot.schema, tableRoot.tableName)
                     }
 
+                    AppButton {
+                        id: btnImport
+                        text: "Import"
+                        icon.source: "qrc:/qt/qml/sofa/ui/assets/plus-solid-full.svg"
+                        isPrimary: false
+                        isOutline: true
+                        accentColor: tableRoot.getActiveConnectionColor()
+                        Layout.preferredHeight: 24
+                        iconSize: 12
+                        spacing: 4
+                        opacity: 0.8
+                        font.weight: Font.DemiBold
+                        property bool isImporting: false
+
+                        function stopImporting(label) {
+                            isImporting = false
+                            text = label
+                        }
+
+                        onClicked: {
+                            if (isImporting) {
+                                App.cancelRequest(tableRoot.importRequestTag)
+                                return
+                            }
+                            importFileDialog.open()
+                        }
+
+                        FileDialog {
+                            id: importFileDialog
+                            title: "Import CSV/TSV into " + tableRoot.schema + "." + tableRoot.tableName
+                            nameFilters: ["CSV files (*.csv)", "TSV files (*.tsv *.tab *.txt)", "All files (*)"]
+                            onAccepted: tableRoot.runImport(selectedFile)
+                        }
+                    }
+
+                    AppButton {
+                        id: btnExport
+                        text: "Export"
+                        icon.source: "qrc:/qt/qml/sofa/ui/assets/table-list-solid-full.svg"
+                        isPrimary: false
+                        isOutline: true
+                        accentColor: tableRoot.getActiveConnectionColor()
+                        Layout.preferredHeight: 24
+                        iconSize: 12
+                        spacing: 4
+                        opacity: 0.8
+                        font.weight: Font.DemiBold
+                        property bool isExporting: false
+
+                        function stopExporting(label) {
+                            isExporting = false
+                            text = label
+                        }
+
+                        onClicked: {
+                            if (isExporting) {
+                                App.cancelRequest(tableRoot.exportRequestTag)
+                                return
+                            }
+                            exportFileDialog.open()
+                        }
+
+                        FileDialog {
+                            id: exportFileDialog
+                            title: "Export " + tableRoot.schema + "." + tableRoot.tableName
+                            fileMode: FileDialog.SaveFile
+                            defaultSuffix: "csv"
+                            nameFilters: ["CSV files (*.csv)", "JSON Lines (*.jsonl *.ndjson)", "SQL INSERT statements (*.sql)"]
+                            onAccepted: tableRoot.runExport(selectedFile)
+                        }
+                    }
+
                     Item { Layout.fillWidth: true }
 
                     AppButton {
@@ -1286,27 +1317,22 @@ ApplicationWindow {
             }
 
 
-            function loadData(useDelayedLoading) {
+            function loadData(useDelayedLoading, keepCursor) {
                 if (useDelayedLoading === undefined) useDelayedLoading = false
+                // Only page navigation may reuse the open cursor; any other reload must see fresh data.
+                if (keepCursor !== true) {
+                    tableRoot.resetPager()
+                    tableRoot.pageCursors = []
+                    // The filter (or the data) changed: a running exact count is stale.
+                    if (btnCount.isLoading) App.cancelRequest(tableRoot.countRequestTag)
+                }
+                // The previous page/filter request is superseded by this one.
+                if (tableRoot.requestInFlight) App.cancelRequest(tableRoot.requestTag, false)
                 tableRoot.errorMessage = ""
                 tableRoot.empty = false
                 tableRoot.loading = false
                 tableRoot.hasMore = false
                 if (tableName) {
-                    if (App.queryRunning) {
-                        tableRoot.pendingLoad = true
-                        tableRoot.pendingLoadUseDelayed = useDelayedLoading
-                        tableRoot.requestInFlight = true
-                        tableRoot.delayedLoadingForCurrentRequest = useDelayedLoading
-                        tableRoot.loading = !useDelayedLoading
-                        if (!loadRetryTimer.running) {
-                            loadRetryTimer.start()
-                        }
-                        return
-                    }
-
-                    tableRoot.pendingLoad = false
-                    tableRoot.pendingLoadUseDelayed = false
                     console.log("\u001b[34m📥 Buscando dados\u001b[0m", schema + "." + tableName)
                     var filterTag = tableRoot.appliedFilterClause.length > 0
                         ? ":filter:" + String(tableRoot.appliedFilterClause.length)
@@ -1329,7 +1355,11 @@ ApplicationWindow {
                         "",
                         true,
                         tableRoot.requestTag,
-                        tableRoot.appliedFilterClause
+                        tableRoot.appliedFilterClause,
+                        tableRoot.pagingKey,
+                        tableRoot.pageCursors[tableRoot.pageIndex] || "",
+                        // The row estimate rides along with the data; page navigation keeps the last one.
+                        keepCursor !== true
                     )
                     if (!ok) {
                         tableRoot.requestInFlight = false
@@ -1341,8 +1371,6 @@ ApplicationWindow {
                         gridEngine.clear()
                     }
                 } else {
-                    tableRoot.pendingLoad = false
-                    tableRoot.pendingLoadUseDelayed = false
                     tableRoot.requestInFlight = false
                     tableRoot.delayedLoadingForCurrentRequest = false
                     loadingVisualDelayTimer.stop()
@@ -1354,6 +1382,7 @@ ApplicationWindow {
 
             onSchemaChanged: {
                 tableRoot.pageIndex = 0
+                tableRoot.pageCursors = []
                 tableRoot.resetSortState()
                 tableRoot.lastDatasetResult = ({})
                 tableRoot.tableStructureColumns = []
@@ -1365,6 +1394,7 @@ ApplicationWindow {
 
             onTableNameChanged: {
                 tableRoot.pageIndex = 0
+                tableRoot.pageCursors = []
                 tableRoot.resetSortState()
                 tableRoot.lastDatasetResult = ({})
                 tableRoot.tableStructureColumns = []
@@ -1375,21 +1405,21 @@ ApplicationWindow {
             }
 
             function runCount() {
-                var tag = "count_" + Date.now()
-                App.getCount(schema, tableName, tag)
+                tableRoot.countRequestTag = "count_" + schema + "." + tableName + "_" + Date.now()
+                App.getCount(schema, tableName, tableRoot.appliedFilterClause, tableRoot.countRequestTag)
             }
 
             function nextPage() {
                 if (!tableRoot.requestInFlight && tableRoot.hasMore) {
                     tableRoot.pageIndex += 1
-                    tableRoot.loadData(true)
+                    tableRoot.loadData(true, true)
                 }
             }
 
             function previousPage() {
                 if (!tableRoot.requestInFlight && tableRoot.pageIndex > 0) {
                     tableRoot.pageIndex -= 1
-                    tableRoot.loadData(true)
+                    tableRoot.loadData(true, true)
                 }
             }
 
@@ -1400,7 +1430,7 @@ ApplicationWindow {
                 }
                 if (event.key === Qt.Key_Escape) {
                     if (tableRoot.requestInFlight) {
-                        App.cancelActiveQuery();
+                        App.cancelRequest(tableRoot.requestTag);
                         event.accepted = true;
                     }
                 }
@@ -1422,15 +1452,26 @@ ApplicationWindow {
                     loadingVisualDelayTimer.stop()
                     tableRoot.loading = false
                     tableRoot.errorMessage = ""
-                    console.log("\u001b[32m✅ Dataset recebido\u001b[0m", "colunas=" + (result.columns ? result.columns.length : 0) + " linhas=" + (result.rows ? result.rows.length : 0))
+                    console.log("\u001b[32m✅ Dataset recebido\u001b[0m", "colunas=" + (result.columns ? result.columns.length : 0) + " linhas=" + (result.rowCount || 0))
                     tableRoot.hasMore = result.hasMore === true
+                    tableRoot.pageCursors[tableRoot.pageIndex + 1] = result.nextCursor || ""
+                    if (result.totalRows !== undefined && !btnCount.isLoading) {
+                        var exact = App.cachedRowCount(schema, tableName, tableRoot.appliedFilterClause)
+                        if (exact >= 0) {
+                            btnCount.finishLoading(exact)
+                        } else if (result.totalRowsEstimated) {
+                            btnCount.showEstimate(result.totalRows)
+                        } else {
+                            btnCount.finishLoading(result.totalRows)
+                        }
+                    }
                     if (!result.columns || result.columns.length === 0) {
                         tableRoot.errorMessage = "Falha ao carregar dados da tabela."
                         tableRoot.empty = false
                         gridEngine.clear()
                         return
                     }
-                    tableRoot.empty = result.rows && result.rows.length === 0
+                    tableRoot.empty = result.rowCount === 0
 
                     tableRoot.lastDatasetResult = result
                     tableRoot.tableStructureColumns = result.columns ? result.columns : []
@@ -1495,8 +1536,7 @@ ApplicationWindow {
                 }
 
                 function onCountFinished(tag, total) {
-                    if (tag.startsWith("count_")) {
-                        // Assuming this is for the current table's count button
+                    if (tag === tableRoot.countRequestTag) {
                         if (btnCount.isLoading) {
                             var elapsed = Date.now() - btnCount.countStartTime
                             var minTime = 300
@@ -1510,6 +1550,69 @@ ApplicationWindow {
                         }
                     }
                 }
+
+                function onCountError(tag, error) {
+                    if (tag !== tableRoot.countRequestTag) return;
+                    console.log("\u001b[31m❌ Count\u001b[0m", error)
+                    btnCount.stopLoading()
+                }
+
+                function onCountCanceled(tag) {
+                    if (tag !== tableRoot.countRequestTag) return;
+                    btnCount.stopLoading()
+                }
+
+                function onImportProgress(tag, progress) {
+                    if (tag !== tableRoot.importRequestTag) return;
+                    var percent = progress.totalBytes > 0 ? Math.floor(progress.bytesRead * 100 / progress.totalBytes) : 0
+                    btnImport.text = percent + "% · " + Math.round(progress.rowsPerSecond) + " rows/s"
+                }
+
+                function onImportFinished(tag, result) {
+                    if (tag !== tableRoot.importRequestTag) return;
+                    btnImport.stopImporting("Import")
+                    btnImport.tooltip = "Imported " + result.rows + " rows in " + Math.round(result.executionTime) + " ms"
+                        + (result.skippedColumns ? "\nSkipped columns: " + result.skippedColumns.join(", ") : "")
+                    App.invalidateRowCounts(tableRoot.schema, tableRoot.tableName)
+                    tableRoot.loadData()
+                }
+
+                function onImportError(tag, error) {
+                    if (tag !== tableRoot.importRequestTag) return;
+                    console.log("\u001b[31m❌ Import\u001b[0m", error)
+                    btnImport.stopImporting("Import failed")
+                    btnImport.tooltip = error
+                }
+
+                function onImportCanceled(tag) {
+                    if (tag !== tableRoot.importRequestTag) return;
+                    btnImport.stopImporting("Import")
+                }
+
+                function onExportProgress(tag, progress) {
+                    if (tag !== tableRoot.exportRequestTag) return;
+                    btnExport.text = Math.round(progress.rows) + " rows · " + Math.round(progress.rowsPerSecond) + " rows/s"
+                }
+
+                function onExportFinished(tag, result) {
+                    if (tag !== tableRoot.exportRequestTag) return;
+                    btnExport.stopExporting("Export")
+                    btnExport.tooltip = "Exported " + result.rows + " rows (" + Math.round(result.bytesWritten / 1024) + " KB) in "
+                        + Math.round(result.executionTime) + " ms"
+                        + (result.ranges ? " over " + result.ranges + " connections" : "") + "\n" + result.filePath
+                }
+
+                function onExportError(tag, error) {
+                    if (tag !== tableRoot.exportRequestTag) return;
+                    console.log("\u001b[31m❌ Export\u001b[0m", error)
+                    btnExport.stopExporting("Export failed")
+                    btnExport.tooltip = error
+                }
+
+                function onExportCanceled(tag) {
+                    if (tag !== tableRoot.exportRequestTag) return;
+                    btnExport.stopExporting("Export")
+                }
             }
         }
     }
@@ -2356,6 +2459,22 @@ ApplicationWindow {
         }
     }
 
+    Shortcut {
+        sequences: ["Ctrl+P"]
+        enabled: App.activeConnectionId !== -1
+        onActivated: quickOpenPalette.open()
+    }
+
+    QuickOpenPalette {
+        id: quickOpenPalette
+        parent: Overlay.overlay
+        onObjectSelected: function(kind, schema, tableName) {
+            if (kind === "column") openStructure(schema, tableName)
+            else if (kind === "index") openIndexes(schema, tableName)
+            else openTable(schema, tableName)
+        }
+    }
+
     Popup {
         id: deleteConnectionConfirmPopup
         parent: Overlay.overlay
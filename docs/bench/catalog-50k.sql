@@ -0,0 +1,36 @@
+-- Generates the 50k-table catalog used by catalog-bench.sql.
+--
+--   psql -d sofa_bench -f docs/bench/catalog-50k.sql
+--
+-- Schema "bench": 50,000 tables of 4-12 columns. Every 5th table has no
+-- primary key, every 10th a default, every 20th a unique constraint.
+-- Takes a few minutes; drop it with DROP SCHEMA bench CASCADE.
+
+SET client_min_messages = warning;
+DROP SCHEMA IF EXISTS bench CASCADE;
+CREATE SCHEMA bench;
+
+DO $$
+DECLARE
+    columns text;
+BEGIN
+    FOR i IN 1..50000 LOOP
+        SELECT string_agg(format('c%s %s', k, (ARRAY['int', 'bigint', 'text', 'numeric', 'timestamptz', 'boolean'])[1 + k % 6]), ', ')
+          INTO columns
+          FROM generate_series(1, 2 + i % 9) k;
+        EXECUTE format('CREATE TABLE bench.t%s (id int%s, %s%s%s)',
+                       i,
+                       CASE WHEN i % 5 = 0 THEN '' ELSE ' PRIMARY KEY' END,
+                       columns,
+                       CASE WHEN i % 10 = 0 THEN ', created timestamptz DEFAULT now()' ELSE '' END,
+                       CASE WHEN i % 20 = 0 THEN ', code text UNIQUE' ELSE '' END);
+        -- One transaction per 1000 tables keeps the lock table small.
+        IF i % 1000 = 0 THEN
+            COMMIT;
+        END IF;
+    END LOOP;
+END $$;
+
+ANALYZE pg_catalog.pg_class;
+ANALYZE pg_catalog.pg_attribute;
+ANALYZE pg_catalog.pg_constraint;
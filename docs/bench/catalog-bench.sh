@@ -0,0 +1,98 @@
+#!/usr/bin/env bash
+# Times the explorer's catalog statements before (information_schema) and
+# after (pg_catalog) the rewrite, on the catalog from catalog-50k.sql.
+#
+#   docs/bench/catalog-bench.sh -h localhost -d sofa_bench
+#
+# Arguments go to psql. RUNS (default 5) timed runs follow one warm-up;
+# SCHEMA and TABLE pick the listTables schema and the getTableSchema table.
+set -euo pipefail
+
+RUNS=${RUNS:-5}
+SCHEMA=${SCHEMA:-bench}
+TABLE=${TABLE:-t25000}
+PSQL_ARGS=("$@")
+
+# Prints "best median" in ms over RUNS runs of one statement.
+time_sql() {
+    local sql=$1
+    {
+        echo '\timing on'
+        echo '\o /dev/null'
+        for _ in $(seq $((RUNS + 1))); do
+            echo "$sql;"
+        done
+    } | psql -X -q -v ON_ERROR_STOP=1 -v schema="$SCHEMA" -v tbl="$TABLE" "${PSQL_ARGS[@]}" \
+      | sed -n 's/^Time: \([0-9.]*\) ms.*/\1/p' \
+      | tail -n +2 \
+      | sort -n \
+      | awk '{ t[NR] = $1 } END { printf "%10.1f %10.1f\n", t[1], t[int((NR + 1) / 2)] }'
+}
+
+report() {
+    printf '%-34s %s\n' "$1" "$(time_sql "$2")"
+}
+
+OLD_TABLES="SELECT t.table_name,
+       EXISTS (SELECT 1 FROM information_schema.table_constraints tc
+                WHERE tc.table_schema = t.table_schema AND tc.table_name = t.table_name
+                  AND tc.constraint_type = 'PRIMARY KEY') AS has_primary_key,
+       to_regclass(quote_ident(t.table_schema) || '.' || quote_ident(t.table_name))::oid
+FROM information_schema.tables t
+WHERE t.table_schema = :'schema'
+ORDER BY t.table_name"
+
+OLD_COLUMNS="SELECT column_name, udt_name, is_nullable, column_default,
+       to_regclass(quote_ident(table_schema) || '.' || quote_ident(table_name))::oid
+FROM information_schema.columns
+WHERE table_schema = :'schema' AND table_name = :'tbl'
+ORDER BY ordinal_position"
+
+OLD_PRIMARY_KEY="SELECT tc.constraint_name, kcu.column_name
+FROM information_schema.table_constraints tc
+JOIN information_schema.key_column_usage kcu
+  ON tc.constraint_name = kcu.constraint_name
+ AND tc.table_schema = kcu.table_schema
+ AND tc.table_name = kcu.table_name
+WHERE tc.constraint_type = 'PRIMARY KEY' AND tc.table_schema = :'schema' AND tc.table_name = :'tbl'
+ORDER BY kcu.ordinal_position"
+
+# kCatalogTablesSql and kCatalogColumnsSql (addons/postgres/SofaAddonPostgres.cpp).
+NEW_TABLES="SELECT c.relname, c.oid,
+       EXISTS (SELECT 1 FROM pg_catalog.pg_constraint con
+                WHERE con.conrelid = c.oid AND con.contype = 'p'),
+       c.relkind,
+       CASE WHEN c.relkind IN ('r', 'm') AND c.reltuples >= 0 THEN c.reltuples::bigint ELSE -1 END,
+       CASE WHEN c.relkind IN ('r', 'm') THEN c.relpages::bigint * current_setting('block_size')::bigint ELSE -1 END
+FROM pg_catalog.pg_class c
+JOIN pg_catalog.pg_namespace n ON n.oid = c.relnamespace
+WHERE n.nspname = :'schema'
+  AND c.relkind IN ('r', 'p', 'v', 'f')
+  AND (pg_has_role(c.relowner, 'USAGE')
+       OR has_table_privilege(c.oid, 'SELECT, INSERT, UPDATE, DELETE, TRUNCATE, REFERENCES, TRIGGER')
+       OR has_any_column_privilege(c.oid, 'SELECT, INSERT, UPDATE, REFERENCES'))
+ORDER BY c.relname"
+
+NEW_COLUMNS="SELECT a.attname,
+       coalesce(bt.typname, t.typname),
+       NOT a.attnotnull,
+       pg_get_expr(d.adbin, d.adrelid),
+       c.oid,
+       pk.conname,
+       coalesce(a.attnum = ANY (pk.conkey), false)
+FROM pg_catalog.pg_class c
+JOIN pg_catalog.pg_namespace n ON n.oid = c.relnamespace
+JOIN pg_catalog.pg_attribute a ON a.attrelid = c.oid AND a.attnum > 0 AND NOT a.attisdropped
+JOIN pg_catalog.pg_type t ON t.oid = a.atttypid
+LEFT JOIN pg_catalog.pg_type bt ON t.typtype = 'd' AND bt.oid = t.typbasetype
+LEFT JOIN pg_catalog.pg_attrdef d ON d.adrelid = a.attrelid AND d.adnum = a.attnum
+LEFT JOIN pg_catalog.pg_constraint pk ON pk.conrelid = c.oid AND pk.contype = 'p'
+WHERE n.nspname = :'schema' AND c.relname = :'tbl'
+ORDER BY a.attnum"
+
+printf '%-34s %10s %10s   (ms, schema %s, table %s, %s runs)\n' "" "best" "median" "$SCHEMA" "$TABLE" "$RUNS"
+report "listTables      information_schema" "$OLD_TABLES"
+report "listTables      pg_catalog" "$NEW_TABLES"
+report "getTableSchema  information_schema" "$OLD_COLUMNS"
+report "  + primary key information_schema" "$OLD_PRIMARY_KEY"
+report "getTableSchema  pg_catalog" "$NEW_COLUMNS"
@@ -1,9 +1,11 @@
 #include "AppContext.h"
+#include <QDebug>
 #include <QVariantMap>
 #include <QStringList>
 #include <QJsonDocument>
 #include <QRegularExpression>
 #include <QSet>
+#include <QUrl>
 #include <QtGui/QClipboard>
 #include <QtGui/QGuiApplication>
 #include "addons/IAddon.h"
@@ -25,6 +27,23 @@ QString sanitizeDriverErrorSuffix(const QString& error)
     return sanitized.trimmed();
 }
 
+// A heuristic, not a parser: a false positive only costs a catalog reload.
+// Comments are dropped first so a leading "-- note" or "/* */" doesn't hide
+// the statement; DO and CALL count since their bodies may run DDL.
+bool looksLikeDdl(const QString& sql)
+{
+    static const QRegularExpression kComments(
+        QStringLiteral("--[^\\n]*|/\\*.*?\\*/"),
+        QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression kDdl(
+        QStringLiteral("(^|;)\\s*(CREATE|ALTER|DROP|COMMENT|TRUNCATE|GRANT|REVOKE|REINDEX|DO|CALL"
+                       "|SECURITY\\s+LABEL|IMPORT\\s+FOREIGN\\s+SCHEMA)\\b"),
+        QRegularExpression::CaseInsensitiveOption);
+    QString text = sql;
+    text.replace(kComments, QStringLiteral(" "));
+    return text.contains(kDdl);
+}
+
 } // namespace
 
 namespace Sofa::Core {
@@ -46,32 +65,76 @@ AppContext::AppContext(std::shared_ptr<ICommandService> commandService,
         m_localStore->init();
     }
 
-    m_worker = new QueryWorker(m_addonHost);
-    m_worker->moveToThread(&m_workerThread);
-    connect(&m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
-    connect(m_worker, &QueryWorker::sqlStarted, this, &AppContext::handleSqlStarted);
-    connect(m_worker, &QueryWorker::sqlFinished, this, &AppContext::handleSqlFinished);
-    connect(m_worker, &QueryWorker::sqlError, this, &AppContext::handleSqlError);
-    connect(m_worker, &QueryWorker::datasetStarted, this, &AppContext::handleDatasetStarted);
-    connect(m_worker, &QueryWorker::datasetFinished, this, &AppContext::handleDatasetFinished);
-    connect(m_worker, &QueryWorker::datasetError, this, &AppContext::handleDatasetError);
-    connect(m_worker, &QueryWorker::tableSchemaStarted, this, &AppContext::handleTableSchemaStarted);
-    connect(m_worker, &QueryWorker::tableSchemaFinished, this, &AppContext::handleTableSchemaFinished);
-    connect(m_worker, &QueryWorker::tableSchemaError, this, &AppContext::handleTableSchemaError);
-    connect(m_worker, &QueryWorker::tableIndexesStarted, this, &AppContext::handleTableIndexesStarted);
-    connect(m_worker, &QueryWorker::tableIndexesFinished, this, &AppContext::handleTableIndexesFinished);
-    connect(m_worker, &QueryWorker::tableIndexesError, this, &AppContext::handleTableIndexesError);
-    connect(m_worker, &QueryWorker::countFinished, this, &AppContext::handleCountFinished);
-    
-    m_workerThread.start();
+    m_catalogCache = std::make_shared<CatalogCache>();
+    m_scheduler = new QueryScheduler(m_addonHost, QueryScheduler::defaultWorkerCount(), this, m_catalogCache);
+    std::vector<QueryWorker*> workers = m_scheduler->workers();
+    workers.push_back(m_scheduler->ioWorker());
+    for (QueryWorker* worker : workers) {
+        connect(worker, &QueryWorker::sqlStarted, this, &AppContext::handleSqlStarted);
+        connect(worker, &QueryWorker::sqlBatch, this, &AppContext::handleSqlBatch);
+        connect(worker, &QueryWorker::sqlFinished, this, &AppContext::handleSqlFinished);
+        connect(worker, &QueryWorker::sqlError, this, &AppContext::handleSqlError);
+        connect(worker, &QueryWorker::datasetStarted, this, &AppContext::handleDatasetStarted);
+        connect(worker, &QueryWorker::datasetFinished, this, &AppContext::handleDatasetFinished);
+        connect(worker, &QueryWorker::datasetError, this, &AppContext::handleDatasetError);
+        connect(worker, &QueryWorker::tableSchemaStarted, this, &AppContext::handleTableSchemaStarted);
+        connect(worker, &QueryWorker::tableSchemaFinished, this, &AppContext::handleTableSchemaFinished);
+        connect(worker, &QueryWorker::tableSchemaError, this, &AppContext::handleTableSchemaError);
+        connect(worker, &QueryWorker::tableIndexesStarted, this, &AppContext::handleTableIndexesStarted);
+        connect(worker, &QueryWorker::tableIndexesFinished, this, &AppContext::handleTableIndexesFinished);
+        connect(worker, &QueryWorker::tableIndexesError, this, &AppContext::handleTableIndexesError);
+        connect(worker, &QueryWorker::schemasStarted, this, &AppContext::handleSchemasStarted);
+        connect(worker, &QueryWorker::schemasFinished, this, &AppContext::handleSchemasFinished);
+        connect(worker, &QueryWorker::schemasError, this, &AppContext::handleSchemasError);
+        connect(worker, &QueryWorker::tablesStarted, this, &AppContext::handleTablesStarted);
+        connect(worker, &QueryWorker::tablesBatch, this, &AppContext::handleTablesBatch);
+        connect(worker, &QueryWorker::tablesFinished, this, &AppContext::handleTablesFinished);
+        connect(worker, &QueryWorker::tablesError, this, &AppContext::handleTablesError);
+        connect(worker, &QueryWorker::countStarted, this, &AppContext::handleCountStarted);
+        connect(worker, &QueryWorker::countFinished, this, &AppContext::handleCountFinished);
+        connect(worker, &QueryWorker::countError, this, &AppContext::handleCountError);
+        connect(worker, &QueryWorker::importStarted, this, &AppContext::handleImportStarted);
+        connect(worker, &QueryWorker::importProgress, this, &AppContext::handleImportProgress);
+        connect(worker, &QueryWorker::importFinished, this, &AppContext::handleImportFinished);
+        connect(worker, &QueryWorker::importError, this, &AppContext::handleImportError);
+        connect(worker, &QueryWorker::exportStarted, this, &AppContext::handleExportStarted);
+        connect(worker, &QueryWorker::exportProgress, this, &AppContext::handleExportProgress);
+        connect(worker, &QueryWorker::exportFinished, this, &AppContext::handleExportFinished);
+        connect(worker, &QueryWorker::exportError, this, &AppContext::handleExportError);
+        connect(worker, &QueryWorker::catalogVersionFinished, this, &AppContext::handleCatalogVersion);
+    }
+    connect(m_scheduler, &QueryScheduler::activeRequestsChanged, this, &AppContext::updateQueryRunning);
+
+    m_catalogModel = new CatalogTreeModel(this);
+    connect(m_catalogModel, &CatalogTreeModel::schemasRequested, this, &AppContext::getSchemasAsync);
+    connect(m_catalogModel, &CatalogTreeModel::tablesRequested, this, &AppContext::getTablesAsync);
+    connect(this, &AppContext::schemasFinished, m_catalogModel, &CatalogTreeModel::handleSchemasFinished);
+    connect(this, &AppContext::schemasError, m_catalogModel, &CatalogTreeModel::handleSchemasError);
+    connect(this, &AppContext::tablesBatch, m_catalogModel, &CatalogTreeModel::handleTablesBatch);
+    connect(this, &AppContext::tablesFinished, m_catalogModel, &CatalogTreeModel::handleTablesFinished);
+    connect(this, &AppContext::tablesError, m_catalogModel, &CatalogTreeModel::handleTablesError);
+    connect(this, &AppContext::catalogChanged, m_catalogModel, [this](const QString& schema) {
+        m_catalogModel->reload(schema);
+    });
+
+    m_catalogSearch = new CatalogSearchModel(this);
+    connect(m_catalogSearch, &CatalogSearchModel::schemasRequested, this, &AppContext::getSchemasAsync);
+    connect(m_catalogSearch, &CatalogSearchModel::tablesRequested, this, &AppContext::getTablesAsync);
+    connect(this, &AppContext::schemasFinished, m_catalogSearch, &CatalogSearchModel::handleSchemasFinished);
+    connect(this, &AppContext::tablesBatch, m_catalogSearch, &CatalogSearchModel::handleTablesBatch);
+    connect(this, &AppContext::tablesFinished, m_catalogSearch, &CatalogSearchModel::handleTablesFinished);
+    connect(this, &AppContext::tableSchemaFinished, m_catalogSearch, &CatalogSearchModel::handleTableSchemaFinished);
+    connect(this, &AppContext::tableIndexesFinished, m_catalogSearch, &CatalogSearchModel::handleTableIndexesFinished);
+    connect(this, &AppContext::catalogChanged, m_catalogSearch, &CatalogSearchModel::handleCatalogChanged);
+    connect(&m_catalogPollTimer, &QTimer::timeout, this, &AppContext::checkCatalogVersion);
 }
 
 AppContext::~AppContext()
 {
-    if (m_workerThread.isRunning()) {
-        m_workerThread.quit();
-        m_workerThread.wait();
-    }
+    saveCatalogSnapshot();
+    // Stop the worker threads before the handlers they signal go away.
+    delete m_scheduler;
+    m_scheduler = nullptr;
 }
 
 void AppContext::executeCommand(const QString& id)
@@ -269,8 +332,12 @@ bool AppContext::openConnection(int id)
         return false;
     }
     
-    // 2. Get driver (hardcoded postgres for now)
+    // 2. Get driver (postgres for now; "postgres_driver" picks the QPSQL or libpq backend)
     QString driverId = "postgres";
+    const QString preferredDriver = m_localStore->getSetting("postgres_driver", driverId).toString();
+    if (m_addonHost->hasAddon(preferredDriver)) {
+        driverId = preferredDriver;
+    }
     if (!m_addonHost->hasAddon(driverId)) {
         m_logger->error("Driver not found: " + driverId);
         return false;
@@ -302,8 +369,24 @@ bool AppContext::openConnection(int id)
         m_activeConnectionInfo["database"] = targetConn.database;
         m_activeConnectionInfo["user"] = targetConn.user;
         m_activeConnectionInfo["password"] = password;
+        m_catalogCache->invalidate(catalogCacheKey());
+        // Last session's lists are shown right away; the version check below
+        // drops them if the catalog changed since.
+        if (m_localStore->getSetting("catalog_snapshot", "on").toString() != "off"
+            && m_catalogCache->restore(catalogCacheKey(), m_localStore->getCatalogSnapshot(id))) {
+            qInfo() << "\x1b[36m🗂️ Catálogo\x1b[0m" << "restaurado do snapshot local";
+        }
+        const int pollMs = m_localStore->getSetting("catalog_poll_interval_ms", 0).toInt();
+        if (pollMs > 0) {
+            m_catalogPollTimer.start(pollMs);
+        }
+        // Also stamps what gets cached with the version the next snapshot is checked against.
+        checkCatalogVersion();
         m_logger->info("Opened connection: " + targetConn.name);
         setLastError("");
+        m_catalogModel->clear();
+        m_catalogSearch->clear();
+        m_catalogModel->reload();
         emit connectionOpened(id);
         emit activeConnectionIdChanged();
     } else {
@@ -319,12 +402,26 @@ bool AppContext::openConnection(int id)
 
 void AppContext::closeConnection()
 {
+    saveCatalogSnapshot();
     if (m_currentConnection && m_currentConnection->isOpen()) {
         m_currentConnection->close();
     }
     m_currentConnection.reset();
     m_currentConnectionId = -1;
+    m_catalogPollTimer.stop();
+    if (!m_activeConnectionInfo.isEmpty()) {
+        m_catalogCache->invalidate(catalogCacheKey());
+    }
     m_activeConnectionInfo.clear();
+    m_ddlRequests.clear();
+    m_rowCounts.clear();
+    m_pendingRowCounts.clear();
+    if (m_scheduler) {
+        m_scheduler->broadcast("releaseConnections");
+        m_scheduler->clearAffinity();
+    }
+    m_catalogModel->clear();
+    m_catalogSearch->clear();
     emit connectionClosed();
     emit activeConnectionIdChanged();
 }
@@ -332,29 +429,19 @@ void AppContext::closeConnection()
 QStringList AppContext::getSchemas()
 {
     QStringList list;
+    QStringList hidden;
     if (!m_currentConnection || !m_currentConnection->isOpen()) return list;
+
+    const QString cacheKey = catalogCacheKey();
+    if (m_catalogCache->schemas(cacheKey, &list, &hidden)) {
+        return list;
+    }
+    const quint64 cacheGeneration = m_catalogCache->generation(cacheKey);
     
     auto catalog = m_currentConnection->catalog();
     if (catalog) {
-        QSet<QString> hiddenSet;
-        auto hiddenSchemas = catalog->listHiddenSchemas();
-        for (const auto& s : hiddenSchemas) {
-            hiddenSet.insert(s);
-        }
-        auto schemas = catalog->listSchemas();
-        bool publicFound = false;
-        for (const auto& s : schemas) {
-            if (!hiddenSet.contains(s)) {
-                if (s == "public") {
-                    publicFound = true;
-                } else {
-                    list.append(s);
-                }
-            }
-        }
-        if (publicFound) {
-            list.prepend("public");
-        }
+        QueryWorker::schemaLists(*catalog, &list, &hidden);
+        m_catalogCache->storeSchemas(cacheKey, list, hidden, cacheGeneration);
     }
     return list;
 }
@@ -366,18 +453,7 @@ QStringList AppContext::getHiddenSchemas()
     
     auto catalog = m_currentConnection->catalog();
     if (catalog) {
-        auto schemas = catalog->listHiddenSchemas();
-        bool publicFound = false;
-        for (const auto& s : schemas) {
-            if (s == "public") {
-                publicFound = true;
-            } else {
-                list.append(s);
-            }
-        }
-        if (publicFound) {
-            list.prepend("public");
-        }
+        QueryWorker::schemaLists(*catalog, nullptr, &list);
     }
     return list;
 }
@@ -386,20 +462,50 @@ QVariantList AppContext::getTables(const QString& schema)
 {
     QVariantList list;
     if (!m_currentConnection || !m_currentConnection->isOpen()) return list;
-    
-    auto catalog = m_currentConnection->catalog();
-    if (catalog) {
-        auto tables = catalog->listTables(schema);
-        for (const auto& t : tables) {
-            QVariantMap table;
-            table["name"] = t.name;
-            table["hasPrimaryKey"] = t.hasPrimaryKey;
-            list.append(table);
-        }
+
+    const QString cacheKey = catalogCacheKey();
+    std::vector<CatalogTable> tables;
+    if (!m_catalogCache->tables(cacheKey, schema, &tables)) {
+        auto catalog = m_currentConnection->catalog();
+        if (!catalog) return list;
+        const quint64 cacheGeneration = m_catalogCache->generation(cacheKey);
+        tables = catalog->listTables(schema);
+        m_catalogCache->storeTables(cacheKey, schema, tables, cacheGeneration);
+    }
+    for (const auto& t : tables) {
+        list.append(QueryWorker::catalogTableToVariant(t));
     }
     return list;
 }
 
+bool AppContext::getSchemasAsync(const QString& requestTag)
+{
+    const QString reason = asyncUnavailableReason();
+    if (!reason.isEmpty()) {
+        setLastError(reason);
+        emit schemasError(requestTag, m_lastError);
+        return false;
+    }
+    m_scheduler->submit(requestTag, "schemas", [info = m_activeConnectionInfo](QueryWorker* worker, const QString& requestId) {
+        worker->runSchemas(info, requestId);
+    });
+    return true;
+}
+
+bool AppContext::getTablesAsync(const QString& schema, const QString& requestTag)
+{
+    const QString reason = asyncUnavailableReason();
+    if (!reason.isEmpty()) {
+        setLastError(reason);
+        emit tablesError(requestTag, m_lastError);
+        return false;
+    }
+    m_scheduler->submit(requestTag, "tables", [info = m_activeConnectionInfo, schema](QueryWorker* worker, const QString& requestId) {
+        worker->runTables(info, schema, requestId);
+    });
+    return true;
+}
+
 QVariantMap AppContext::runQuery(const QString& queryText)
 {
     QVariantMap result;
@@ -425,6 +531,7 @@ QVariantMap AppContext::runQuery(const QString& queryText)
     }
     
     DatasetRequest request; // default
+    request.limits = queryLimits();
     DatasetPage page = queryProvider->execute(queryText, request);
     
     if (!page.warning.isEmpty()) {
@@ -457,10 +564,11 @@ QVariantMap AppContext::runQuery(const QString& queryText)
     
     QVariantList rows;
     QVariantList nulls;
-    for (const auto& row : page.rows) {
+    for (int i = 0; i < page.rowCount(); ++i) {
         QVariantList rowList;
         QVariantList nullRow;
-        for (const auto& val : row) {
+        for (int c = 0; c < static_cast<int>(page.columns.size()); ++c) {
+            const QVariant val = page.value(i, c);
             rowList.append(val);
             nullRow.append(val.isNull());
         }
@@ -474,40 +582,67 @@ QVariantMap AppContext::runQuery(const QString& queryText)
     return result;
 }
 
-bool AppContext::runQueryAsync(const QString& queryText, const QString& requestTag)
+QString AppContext::asyncUnavailableReason() const
 {
     if (!m_currentConnection || !m_currentConnection->isOpen()) {
-        setLastError("Connection is not open.");
-        emit sqlError(requestTag, m_lastError);
-        return false;
+        return "Connection is not open.";
     }
-    if (m_queryRunning) {
-        setLastError("A query is already running.");
-        emit sqlError(requestTag, m_lastError);
-        return false;
-    }
-    if (!m_worker) {
-        setLastError("Worker unavailable.");
-        emit sqlError(requestTag, m_lastError);
-        return false;
+    if (!m_scheduler) {
+        return "Worker unavailable.";
     }
     if (!m_activeConnectionInfo.contains("driverId")) {
-        setLastError("Connection configuration unavailable.");
+        return "Connection configuration unavailable.";
+    }
+    return QString();
+}
+
+bool AppContext::runQueryAsync(const QString& queryText, const QString& requestTag, const QVariantMap& limits)
+{
+    const QString reason = asyncUnavailableReason();
+    if (!reason.isEmpty()) {
+        setLastError(reason);
         emit sqlError(requestTag, m_lastError);
         return false;
     }
-    m_queryRunning = true;
-    emit queryRunningChanged();
-    m_activeRequestTag = requestTag;
-    m_activeRequestType = "sql";
-    m_activeBackendPid = -1;
-    QMetaObject::invokeMethod(m_worker, "runSql", Qt::QueuedConnection,
-                              Q_ARG(QVariantMap, m_activeConnectionInfo),
-                              Q_ARG(QString, queryText),
-                              Q_ARG(QString, requestTag));
+    auto job = [info = m_activeConnectionInfo, queryText, requestLimits = queryLimits(limits)](QueryWorker* worker, const QString& requestId) {
+        worker->runSql(info, queryText, requestId, requestLimits);
+    };
+    // Console statements share the async I/O thread ("sql_async_io" = "off" puts
+    // them back on the blocking workers).
+    QString requestId;
+    if (m_localStore && m_localStore->getSetting("sql_async_io", "on").toString() == "off") {
+        requestId = m_scheduler->submit(requestTag, "sql", job);
+    } else {
+        requestId = m_scheduler->submitIo(requestTag, "sql", job);
+    }
+    if (looksLikeDdl(queryText)) {
+        m_ddlRequests.insert(requestId);
+    }
     return true;
 }
 
+QueryLimits AppContext::queryLimits(const QVariantMap& overrides) const
+{
+    auto setting = [this, &overrides](const QString& overrideKey, const QString& name, const QVariant& fallback) {
+        if (overrides.contains(overrideKey)) {
+            return overrides.value(overrideKey);
+        }
+        if (!m_localStore) {
+            return fallback;
+        }
+        const QVariant global = m_localStore->getSetting(name, fallback);
+        return m_localStore->getSetting(QString("connection_%1_%2").arg(m_currentConnectionId).arg(name), global);
+    };
+
+    // Defaults keep a stray SELECT * from exhausting client memory; no timeout
+    // unless configured, since long analytical queries are legitimate.
+    QueryLimits limits;
+    limits.statementTimeoutMs = setting("statementTimeoutMs", "query_statement_timeout_ms", 0).toInt();
+    limits.maxRows = setting("maxRows", "query_max_rows", 200000).toLongLong();
+    limits.maxBytes = setting("maxBytes", "query_max_bytes", 256LL * 1024 * 1024).toLongLong();
+    return limits;
+}
+
 QVariantList AppContext::getQueryHistory(int connectionId)
 {
     QVariantList list;
@@ -593,10 +728,11 @@ QVariantMap AppContext::getDataset(const QString& schema, const QString& table,
     
     QVariantList rows;
     QVariantList nulls;
-    for (const auto& row : page.rows) {
+    for (int i = 0; i < page.rowCount(); ++i) {
         QVariantList r;
         QVariantList nullRow;
-        for (const auto& val : row) {
+        for (int c = 0; c < static_cast<int>(page.columns.size()); ++c) {
+            const QVariant val = page.value(i, c);
             r.append(val);
             nullRow.append(val.isNull());
         }
@@ -618,7 +754,7 @@ QVariantMap AppContext::getDataset(const QString& schema, const QString& table,
     }
     
     if (m_logger) {
-        m_logger->info("\x1b[32m✅ Dataset\x1b[0m colunas=" + QString::number(page.columns.size()) + " linhas=" + QString::number(page.rows.size()) + " hasMore=" + (page.hasMore ? "true" : "false"));
+        m_logger->info("\x1b[32m✅ Dataset\x1b[0m colunas=" + QString::number(page.columns.size()) + " linhas=" + QString::number(page.rowCount()) + " hasMore=" + (page.hasMore ? "true" : "false"));
     }
     if (m_logger && !rows.isEmpty()) {
         QStringList debugVals;
@@ -634,293 +770,551 @@ QVariantMap AppContext::getDataset(const QString& schema, const QString& table,
     return result;
 }
 
-bool AppContext::getDatasetAsync(const QString& schema, const QString& table, int limit, int offset, const QString& sortColumn, bool sortAscending, const QString& requestTag, const QString& filterClause)
+bool AppContext::getDatasetAsync(const QString& schema, const QString& table, int limit, int offset, const QString& sortColumn, bool sortAscending, const QString& requestTag, const QString& filterClause, const QString& pagingKey, const QString& cursor, bool withCount)
 {
-    if (!m_currentConnection || !m_currentConnection->isOpen()) {
-        setLastError("Connection is not open.");
-        emit datasetError(requestTag, m_lastError);
-        return false;
-    }
-    if (m_queryRunning) {
-        setLastError("A query is already running.");
+    const QString reason = asyncUnavailableReason();
+    if (!reason.isEmpty()) {
+        setLastError(reason);
         emit datasetError(requestTag, m_lastError);
         return false;
     }
-    if (!m_worker) {
-        setLastError("Worker unavailable.");
-        emit datasetError(requestTag, m_lastError);
-        return false;
-    }
-    if (!m_activeConnectionInfo.contains("driverId")) {
-        setLastError("Connection configuration unavailable.");
-        emit datasetError(requestTag, m_lastError);
-        return false;
+    // Server-side cursor paging is opt-in ("table_paging_mode" = "cursor"): it keeps
+    // a connection and an open transaction per table tab.
+    QString cursorKey;
+    if (!pagingKey.isEmpty() && m_localStore
+        && m_localStore->getSetting("table_paging_mode", "offset").toString() == "cursor") {
+        cursorKey = pagingKey;
     }
-    m_queryRunning = true;
-    emit queryRunningChanged();
-    m_activeRequestTag = requestTag;
-    m_activeRequestType = "dataset";
-    m_activeBackendPid = -1;
-    QMetaObject::invokeMethod(m_worker, "runDataset", Qt::QueuedConnection,
-                              Q_ARG(QVariantMap, m_activeConnectionInfo),
-                              Q_ARG(QString, schema),
-                              Q_ARG(QString, table),
-                              Q_ARG(int, limit),
-                              Q_ARG(int, offset),
-                              Q_ARG(QString, sortColumn),
-                              Q_ARG(bool, sortAscending),
-                              Q_ARG(QString, requestTag),
-                              Q_ARG(QString, filterClause));
+    m_scheduler->submit(requestTag, "dataset", [info = m_activeConnectionInfo, schema, table, limit, offset, sortColumn, sortAscending, filterClause, cursorKey, cursor, withCount, requestLimits = queryLimits()](QueryWorker* worker, const QString& requestId) {
+        worker->runDataset(info, schema, table, limit, offset, sortColumn, sortAscending, requestId, filterClause, cursorKey, cursor, withCount, requestLimits);
+    }, cursorKey);
     return true;
 }
 
+void AppContext::closeDatasetCursor(const QString& pagingKey)
+{
+    if (!m_scheduler || pagingKey.isEmpty()) return;
+    m_scheduler->submit("pager-close:" + pagingKey, "pager", [pagingKey](QueryWorker* worker, const QString&) {
+        worker->closePager(pagingKey);
+    }, pagingKey);
+    m_scheduler->releaseAffinity(pagingKey);
+}
+
 bool AppContext::getTableSchemaAsync(const QString& schema, const QString& table, const QString& requestTag)
 {
-    if (!m_currentConnection || !m_currentConnection->isOpen()) {
-        setLastError("Connection is not open.");
-        emit tableSchemaError(requestTag, m_lastError);
-        return false;
-    }
-    if (m_queryRunning) {
-        setLastError("A query is already running.");
-        emit tableSchemaError(requestTag, m_lastError);
-        return false;
-    }
-    if (!m_worker) {
-        setLastError("Worker unavailable.");
-        emit tableSchemaError(requestTag, m_lastError);
-        return false;
-    }
-    if (!m_activeConnectionInfo.contains("driverId")) {
-        setLastError("Connection configuration unavailable.");
+    const QString reason = asyncUnavailableReason();
+    if (!reason.isEmpty()) {
+        setLastError(reason);
         emit tableSchemaError(requestTag, m_lastError);
         return false;
     }
-
-    m_queryRunning = true;
-    emit queryRunningChanged();
-    m_activeRequestTag = requestTag;
-    m_activeRequestType = "schema";
-    m_activeBackendPid = -1;
-    QMetaObject::invokeMethod(m_worker, "runTableSchema", Qt::QueuedConnection,
-                              Q_ARG(QVariantMap, m_activeConnectionInfo),
-                              Q_ARG(QString, schema),
-                              Q_ARG(QString, table),
-                              Q_ARG(QString, requestTag));
+    m_scheduler->submit(requestTag, "schema", [info = m_activeConnectionInfo, schema, table](QueryWorker* worker, const QString& requestId) {
+        worker->runTableSchema(info, schema, table, requestId);
+    });
     return true;
 }
 
 bool AppContext::getTableIndexesAsync(const QString& schema, const QString& table, const QString& requestTag)
 {
-    if (!m_currentConnection || !m_currentConnection->isOpen()) {
-        setLastError("Connection is not open.");
+    const QString reason = asyncUnavailableReason();
+    if (!reason.isEmpty()) {
+        setLastError(reason);
         emit tableIndexesError(requestTag, m_lastError);
         return false;
     }
-    if (m_queryRunning) {
-        setLastError("A query is already running.");
+    m_scheduler->submit(requestTag, "indexes", [info = m_activeConnectionInfo, schema, table](QueryWorker* worker, const QString& requestId) {
+        worker->runTableIndexes(info, schema, table, requestId);
+    });
+    return true;
+}
+
+bool AppContext::getSchemaIndexesAsync(const QString& schema, const QString& requestTag)
+{
+    const QString reason = asyncUnavailableReason();
+    if (!reason.isEmpty()) {
+        setLastError(reason);
         emit tableIndexesError(requestTag, m_lastError);
         return false;
     }
-    if (!m_worker) {
-        setLastError("Worker unavailable.");
-        emit tableIndexesError(requestTag, m_lastError);
-        return false;
+    m_scheduler->submit(requestTag, "indexes", [info = m_activeConnectionInfo, schema](QueryWorker* worker, const QString& requestId) {
+        worker->runSchemaIndexes(info, schema, requestId);
+    });
+    return true;
+}
+
+void AppContext::getCount(const QString& schema, const QString& table, const QString& filterClause, const QString& requestTag)
+{
+    const QString reason = asyncUnavailableReason();
+    if (!reason.isEmpty()) {
+        if (m_logger) m_logger->error("\x1b[31m❌ Count\x1b[0m " + reason);
+        emit countError(requestTag, reason);
+        return;
     }
-    if (!m_activeConnectionInfo.contains("driverId")) {
-        setLastError("Connection configuration unavailable.");
-        emit tableIndexesError(requestTag, m_lastError);
+    const QString key = rowCountKey(schema, table, filterClause);
+    auto cached = m_rowCounts.constFind(key);
+    if (cached != m_rowCounts.constEnd()) {
+        emit countFinished(requestTag, (double)cached.value());
+        return;
+    }
+    const QString requestId = m_scheduler->submit(requestTag, "count", [info = m_activeConnectionInfo, schema, table, filterClause](QueryWorker* worker, const QString& requestId) {
+        worker->runCount(info, schema, table, filterClause, requestId);
+    });
+    m_pendingRowCounts.insert(requestId, key);
+}
+
+bool AppContext::importFileAsync(const QString& schema, const QString& table, const QString& filePath, const QVariantMap& options, const QString& requestTag)
+{
+    const QString reason = asyncUnavailableReason();
+    if (!reason.isEmpty()) {
+        setLastError(reason);
+        emit importError(requestTag, m_lastError);
         return false;
     }
+    const QString localPath = filePath.startsWith("file:") ? QUrl(filePath).toLocalFile() : filePath;
+    m_scheduler->submit(requestTag, "import", [info = m_activeConnectionInfo, schema, table, localPath, options](QueryWorker* worker, const QString& requestId) {
+        worker->runImport(info, schema, table, localPath, options, requestId);
+    });
+    return true;
+}
 
-    m_queryRunning = true;
-    emit queryRunningChanged();
-    m_activeRequestTag = requestTag;
-    m_activeRequestType = "indexes";
-    m_activeBackendPid = -1;
-    QMetaObject::invokeMethod(m_worker, "runTableIndexes", Qt::QueuedConnection,
-                              Q_ARG(QVariantMap, m_activeConnectionInfo),
-                              Q_ARG(QString, schema),
-                              Q_ARG(QString, table),
-                              Q_ARG(QString, requestTag));
+bool AppContext::exportAsync(const QVariantMap& source, const QString& filePath, const QVariantMap& options, const QString& requestTag)
+{
+    const QString reason = asyncUnavailableReason();
+    if (!reason.isEmpty()) {
+        setLastError(reason);
+        emit exportError(requestTag, m_lastError);
+        return false;
+    }
+    const QString localPath = filePath.startsWith("file:") ? QUrl(filePath).toLocalFile() : filePath;
+    QVariantMap exportOptions = options;
+    if (!exportOptions.contains("parallel") && m_localStore) {
+        exportOptions["parallel"] = m_localStore->getSetting("export_parallel_connections", 4).toInt();
+    }
+    m_scheduler->submit(requestTag, "export", [info = m_activeConnectionInfo, source, localPath, exportOptions](QueryWorker* worker, const QString& requestId) {
+        worker->runExport(info, source, localPath, exportOptions, requestId);
+    });
     return true;
 }
 
-void AppContext::getCount(const QString& schema, const QString& table, const QString& requestTag)
+QString AppContext::rowCountKey(const QString& schema, const QString& table, const QString& filterClause) const
 {
-    if (!m_currentConnection || !m_currentConnection->isOpen()) {
-        if (m_logger) m_logger->error("\x1b[31m❌ Count\x1b[0m conexão não está aberta");
+    return QStringList { QString::number(m_currentConnectionId), schema, table, filterClause.trimmed() }.join(QChar(0x1f));
+}
+
+double AppContext::cachedRowCount(const QString& schema, const QString& table, const QString& filterClause) const
+{
+    return (double)m_rowCounts.value(rowCountKey(schema, table, filterClause), -1);
+}
+
+void AppContext::invalidateRowCounts(const QString& schema, const QString& table)
+{
+    if (schema.isEmpty() && table.isEmpty()) {
+        m_rowCounts.clear();
         return;
     }
-    
-    QMetaObject::invokeMethod(m_worker, "runCount", Qt::QueuedConnection,
-                              Q_ARG(QVariantMap, m_activeConnectionInfo),
-                              Q_ARG(QString, schema),
-                              Q_ARG(QString, table),
-                              Q_ARG(QString, requestTag));
+    const QString prefix = rowCountKey(schema, table, QString());
+    for (auto it = m_rowCounts.begin(); it != m_rowCounts.end();) {
+        if (it.key().startsWith(prefix)) {
+            it = m_rowCounts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void AppContext::invalidateCatalog(const QString& schema, const QString& table)
+{
+    if (m_activeConnectionInfo.isEmpty()) {
+        return;
+    }
+    m_catalogCache->invalidate(catalogCacheKey(), schema, table);
+    emit catalogChanged(schema, table);
+}
+
+QString AppContext::catalogCacheKey() const
+{
+    return ConnectionPool::keyFor(m_activeConnectionInfo);
+}
+
+void AppContext::saveCatalogSnapshot()
+{
+    if (m_currentConnectionId == -1 || m_activeConnectionInfo.isEmpty() || !m_localStore
+        || m_localStore->getSetting("catalog_snapshot", "on").toString() == "off") {
+        return;
+    }
+    const QByteArray snapshot = m_catalogCache->snapshot(catalogCacheKey());
+    if (!snapshot.isEmpty()) {
+        m_localStore->saveCatalogSnapshot(m_currentConnectionId, snapshot);
+    }
+}
+
+void AppContext::checkCatalogVersion()
+{
+    if (!asyncUnavailableReason().isEmpty() || m_scheduler->hasActiveRequests({"catalog"})) {
+        return;
+    }
+    m_scheduler->submit("catalog-version", "catalog", [info = m_activeConnectionInfo](QueryWorker* worker, const QString& requestId) {
+        worker->runCatalogVersion(info, requestId);
+    });
+}
+
+void AppContext::handleCatalogVersion(const QString& requestId, const QString& version)
+{
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty() || m_activeConnectionInfo.isEmpty()) return;
+    if (m_catalogCache->checkVersion(catalogCacheKey(), version)) {
+        qInfo() << "\x1b[36m🔄 Catálogo\x1b[0m" << "alterado no servidor; cache de metadados descartado";
+        emit catalogChanged(QString(), QString());
+    }
 }
 
 bool AppContext::cancelActiveQuery()
 {
-    if (!m_queryRunning || !m_currentConnection) {
+    if (!m_scheduler) {
         return false;
     }
-    bool canceled = m_currentConnection->cancelQuery(m_activeBackendPid);
-    if (canceled) {
-        QString tag = m_activeRequestTag;
-        QString type = m_activeRequestType;
-        m_queryRunning = false;
-        emit queryRunningChanged();
-        m_activeBackendPid = -1;
-        m_activeRequestTag.clear();
-        m_activeRequestType.clear();
-        setLastError("");
-        if (type == "sql") {
-            emit sqlCanceled(tag);
-        } else if (type == "dataset") {
-            emit datasetCanceled(tag);
-        }
-    } else {
-        setLastError("Cancelamento não suportado pelo driver.");
+    return cancelRequestById(m_scheduler->latestStartedRequestId());
+}
+
+bool AppContext::cancelRequest(const QString& requestTag, bool notify)
+{
+    if (!m_scheduler || requestTag.isEmpty()) {
+        return false;
     }
-    return canceled;
+    return cancelRequestById(m_scheduler->latestRequestId(requestTag), notify);
 }
 
-void AppContext::handleSqlStarted(const QString& requestTag, int backendPid)
+bool AppContext::cancelRequestById(const QString& requestId, bool notify)
 {
-    m_activeBackendPid = backendPid;
-    if (requestTag == m_activeRequestTag) {
-        emit sqlStarted(requestTag);
+    const auto* current = m_scheduler->request(requestId);
+    if (!current) {
+        return false;
     }
+    const QueryScheduler::RequestHandle handle = *current;
+
+    // Requests that have not reached the server yet are simply dropped (a token
+    // that arrives later is used right away). Running ones are interrupted through
+    // their own cancel token; drivers without one fall back to cancelQuery(pid).
+    if (handle.cancelToken) {
+        // A failed cancel means the job already returned; the pid may serve another request by now.
+        m_scheduler->cancel(requestId);
+    } else if (handle.started && handle.backendPid > 0) {
+        if (!m_currentConnection || !m_currentConnection->cancelQuery(handle.backendPid)) {
+            setLastError("Cancelamento não suportado pelo driver.");
+            return false;
+        }
+    }
+    m_scheduler->drop(requestId);
+    m_pendingRowCounts.remove(requestId);
+    if (m_ddlRequests.remove(requestId)) {
+        invalidateCatalog();
+    }
+    if (!notify) {
+        return true;
+    }
+    setLastError("");
+    if (handle.type == "sql") {
+        emit sqlCanceled(handle.tag);
+    } else if (handle.type == "dataset") {
+        emit datasetCanceled(handle.tag);
+    } else if (handle.type == "schema") {
+        emit tableSchemaCanceled(handle.tag);
+    } else if (handle.type == "indexes") {
+        emit tableIndexesCanceled(handle.tag);
+    } else if (handle.type == "schemas") {
+        emit schemasCanceled(handle.tag);
+    } else if (handle.type == "tables") {
+        emit tablesCanceled(handle.tag);
+    } else if (handle.type == "count") {
+        emit countCanceled(handle.tag);
+    } else if (handle.type == "import") {
+        emit importCanceled(handle.tag);
+    } else if (handle.type == "export") {
+        emit exportCanceled(handle.tag);
+    }
+    return true;
 }
 
-void AppContext::handleSqlFinished(const QString& requestTag, const QVariantMap& result)
+void AppContext::updateQueryRunning()
 {
-    if (requestTag != m_activeRequestTag) return;
-    m_queryRunning = false;
+    const bool running = m_scheduler && m_scheduler->hasActiveRequests({ "sql", "dataset", "schema", "indexes" });
+    if (running == m_queryRunning) return;
+    m_queryRunning = running;
     emit queryRunningChanged();
+}
+
+QString AppContext::startRequest(const QString& requestId, int backendPid)
+{
+    const auto* handle = m_scheduler ? m_scheduler->request(requestId) : nullptr;
+    if (!handle) return QString();
+    const QString tag = handle->tag;
+    m_scheduler->markStarted(requestId, backendPid);
+    return tag;
+}
+
+QString AppContext::takeRequest(const QString& requestId)
+{
+    const auto* handle = m_scheduler ? m_scheduler->request(requestId) : nullptr;
+    if (!handle) return QString();
+    const QString tag = handle->tag;
+    m_scheduler->finish(requestId);
+    return tag;
+}
+
+void AppContext::handleSqlStarted(const QString& requestId, int backendPid)
+{
+    const QString tag = startRequest(requestId, backendPid);
+    if (tag.isEmpty()) return;
+    emit sqlStarted(tag);
+}
+
+void AppContext::handleSqlBatch(const QString& requestId, const QVariantMap& batch)
+{
+    const auto* handle = m_scheduler ? m_scheduler->request(requestId) : nullptr;
+    if (!handle) return;
+    emit sqlBatch(handle->tag, batch);
+}
+
+void AppContext::handleSqlFinished(const QString& requestId, const QVariantMap& result)
+{
+    if (m_ddlRequests.remove(requestId)) {
+        invalidateCatalog();
+    }
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    // Any statement may have written rows; exact counts are re-run on demand.
+    invalidateRowCounts();
     setLastError("");
-    m_activeBackendPid = -1;
-    m_activeRequestTag.clear();
-    m_activeRequestType.clear();
-    emit sqlFinished(requestTag, result);
+    emit sqlFinished(tag, result);
 }
 
-void AppContext::handleSqlError(const QString& requestTag, const QString& error)
+void AppContext::handleSqlError(const QString& requestId, const QString& error)
 {
-    if (requestTag != m_activeRequestTag && !m_activeRequestTag.isEmpty()) return;
-    m_queryRunning = false;
-    emit queryRunningChanged();
+    // A script may fail after some of its DDL already ran.
+    if (m_ddlRequests.remove(requestId)) {
+        invalidateCatalog();
+    }
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
     const QString cleanError = sanitizeDriverErrorSuffix(error);
     setLastError(cleanError);
-    m_activeBackendPid = -1;
-    m_activeRequestTag.clear();
-    m_activeRequestType.clear();
-    emit sqlError(requestTag, cleanError);
+    emit sqlError(tag, cleanError);
 }
 
-void AppContext::handleDatasetStarted(const QString& requestTag, int backendPid)
+void AppContext::handleDatasetStarted(const QString& requestId, int backendPid)
 {
-    m_activeBackendPid = backendPid;
-    if (requestTag == m_activeRequestTag) {
-        emit datasetStarted(requestTag);
-    }
+    const QString tag = startRequest(requestId, backendPid);
+    if (tag.isEmpty()) return;
+    emit datasetStarted(tag);
 }
 
-void AppContext::handleDatasetFinished(const QString& requestTag, const QVariantMap& result)
+void AppContext::handleDatasetFinished(const QString& requestId, const QVariantMap& result)
 {
-    if (requestTag != m_activeRequestTag) return;
-    m_queryRunning = false;
-    emit queryRunningChanged();
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
     setLastError("");
-    m_activeBackendPid = -1;
-    m_activeRequestTag.clear();
-    m_activeRequestType.clear();
-    emit datasetFinished(requestTag, result);
+    emit datasetFinished(tag, result);
 }
 
-void AppContext::handleDatasetError(const QString& requestTag, const QString& error)
+void AppContext::handleDatasetError(const QString& requestId, const QString& error)
 {
-    if (requestTag != m_activeRequestTag && !m_activeRequestTag.isEmpty()) return;
-    m_queryRunning = false;
-    emit queryRunningChanged();
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
     const QString cleanError = sanitizeDriverErrorSuffix(error);
     setLastError(cleanError);
-    m_activeBackendPid = -1;
-    m_activeRequestTag.clear();
-    m_activeRequestType.clear();
-    emit datasetError(requestTag, cleanError);
+    emit datasetError(tag, cleanError);
 }
 
-void AppContext::handleTableSchemaStarted(const QString& requestTag, int backendPid)
+void AppContext::handleTableSchemaStarted(const QString& requestId, int backendPid)
 {
-    m_activeBackendPid = backendPid;
-    if (requestTag == m_activeRequestTag) {
-        emit tableSchemaStarted(requestTag);
-    }
+    const QString tag = startRequest(requestId, backendPid);
+    if (tag.isEmpty()) return;
+    emit tableSchemaStarted(tag);
 }
 
-void AppContext::handleTableSchemaFinished(const QString& requestTag, const QVariantMap& result)
+void AppContext::handleTableSchemaFinished(const QString& requestId, const QVariantMap& result)
 {
-    if (requestTag != m_activeRequestTag) return;
-    m_queryRunning = false;
-    emit queryRunningChanged();
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
     setLastError("");
-    m_activeBackendPid = -1;
-    m_activeRequestTag.clear();
-    m_activeRequestType.clear();
-    emit tableSchemaFinished(requestTag, result);
+    emit tableSchemaFinished(tag, result);
 }
 
-void AppContext::handleTableSchemaError(const QString& requestTag, const QString& error)
+void AppContext::handleTableSchemaError(const QString& requestId, const QString& error)
 {
-    if (requestTag != m_activeRequestTag && !m_activeRequestTag.isEmpty()) return;
-    m_queryRunning = false;
-    emit queryRunningChanged();
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
     const QString cleanError = sanitizeDriverErrorSuffix(error);
     setLastError(cleanError);
-    m_activeBackendPid = -1;
-    m_activeRequestTag.clear();
-    m_activeRequestType.clear();
-    emit tableSchemaError(requestTag, cleanError);
+    emit tableSchemaError(tag, cleanError);
 }
 
-void AppContext::handleTableIndexesStarted(const QString& requestTag, int backendPid)
+void AppContext::handleTableIndexesStarted(const QString& requestId, int backendPid)
 {
-    m_activeBackendPid = backendPid;
-    if (requestTag == m_activeRequestTag) {
-        emit tableIndexesStarted(requestTag);
-    }
+    const QString tag = startRequest(requestId, backendPid);
+    if (tag.isEmpty()) return;
+    emit tableIndexesStarted(tag);
 }
 
-void AppContext::handleTableIndexesFinished(const QString& requestTag, const QVariantMap& result)
+void AppContext::handleTableIndexesFinished(const QString& requestId, const QVariantMap& result)
 {
-    if (requestTag != m_activeRequestTag) return;
-    m_queryRunning = false;
-    emit queryRunningChanged();
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
     setLastError("");
-    m_activeBackendPid = -1;
-    m_activeRequestTag.clear();
-    m_activeRequestType.clear();
-    emit tableIndexesFinished(requestTag, result);
+    emit tableIndexesFinished(tag, result);
 }
 
-void AppContext::handleTableIndexesError(const QString& requestTag, const QString& error)
+void AppContext::handleTableIndexesError(const QString& requestId, const QString& error)
 {
-    if (requestTag != m_activeRequestTag && !m_activeRequestTag.isEmpty()) return;
-    m_queryRunning = false;
-    emit queryRunningChanged();
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
     const QString cleanError = sanitizeDriverErrorSuffix(error);
     setLastError(cleanError);
-    m_activeBackendPid = -1;
-    m_activeRequestTag.clear();
-    m_activeRequestType.clear();
-    emit tableIndexesError(requestTag, cleanError);
+    emit tableIndexesError(tag, cleanError);
+}
+
+void AppContext::handleSchemasStarted(const QString& requestId, int backendPid)
+{
+    const QString tag = startRequest(requestId, backendPid);
+    if (tag.isEmpty()) return;
+    emit schemasStarted(tag);
+}
+
+void AppContext::handleSchemasFinished(const QString& requestId, const QVariantMap& result)
+{
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    emit schemasFinished(tag, result);
+}
+
+void AppContext::handleSchemasError(const QString& requestId, const QString& error)
+{
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    emit schemasError(tag, sanitizeDriverErrorSuffix(error));
+}
+
+void AppContext::handleTablesStarted(const QString& requestId, int backendPid)
+{
+    const QString tag = startRequest(requestId, backendPid);
+    if (tag.isEmpty()) return;
+    emit tablesStarted(tag);
+}
+
+void AppContext::handleTablesBatch(const QString& requestId, const QVariantMap& batch)
+{
+    const auto* handle = m_scheduler ? m_scheduler->request(requestId) : nullptr;
+    if (!handle) return;
+    emit tablesBatch(handle->tag, batch);
+}
+
+void AppContext::handleTablesFinished(const QString& requestId, const QVariantMap& result)
+{
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    emit tablesFinished(tag, result);
+}
+
+void AppContext::handleTablesError(const QString& requestId, const QString& error)
+{
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    emit tablesError(tag, sanitizeDriverErrorSuffix(error));
+}
+
+void AppContext::handleCountStarted(const QString& requestId, int backendPid)
+{
+    const QString tag = startRequest(requestId, backendPid);
+    if (tag.isEmpty()) return;
+    emit countStarted(tag);
+}
+
+void AppContext::handleCountFinished(const QString& requestId, qint64 total)
+{
+    // Cached even when the request was superseded: the number is still right.
+    const QString key = m_pendingRowCounts.take(requestId);
+    if (!key.isEmpty()) {
+        m_rowCounts.insert(key, total);
+    }
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    emit countFinished(tag, (double)total);
+}
+
+void AppContext::handleCountError(const QString& requestId, const QString& error)
+{
+    m_pendingRowCounts.remove(requestId);
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    emit countError(tag, sanitizeDriverErrorSuffix(error));
+}
+
+void AppContext::handleImportStarted(const QString& requestId, int backendPid)
+{
+    const QString tag = startRequest(requestId, backendPid);
+    if (tag.isEmpty()) return;
+    emit importStarted(tag);
+}
+
+void AppContext::handleImportProgress(const QString& requestId, const QVariantMap& progress)
+{
+    const auto* handle = m_scheduler ? m_scheduler->request(requestId) : nullptr;
+    if (!handle) return;
+    emit importProgress(handle->tag, progress);
+}
+
+void AppContext::handleImportFinished(const QString& requestId, const QVariantMap& result)
+{
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    invalidateRowCounts();
+    if (m_logger) {
+        m_logger->info(QString("\x1b[32m📥 Import\x1b[0m %1 rows, %2 rows/s")
+                           .arg(result.value("rows").toLongLong())
+                           .arg(result.value("rowsPerSecond").toDouble(), 0, 'f', 0));
+    }
+    emit importFinished(tag, result);
+}
+
+void AppContext::handleImportError(const QString& requestId, const QString& error)
+{
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    emit importError(tag, sanitizeDriverErrorSuffix(error));
+}
+
+void AppContext::handleExportStarted(const QString& requestId, int backendPid)
+{
+    const QString tag = startRequest(requestId, backendPid);
+    if (tag.isEmpty()) return;
+    emit exportStarted(tag);
+}
+
+void AppContext::handleExportProgress(const QString& requestId, const QVariantMap& progress)
+{
+    const auto* handle = m_scheduler ? m_scheduler->request(requestId) : nullptr;
+    if (!handle) return;
+    emit exportProgress(handle->tag, progress);
+}
+
+void AppContext::handleExportFinished(const QString& requestId, const QVariantMap& result)
+{
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    if (m_logger) {
+        m_logger->info(QString("\x1b[32m📤 Export\x1b[0m %1 rows, %2 rows/s -> %3")
+                           .arg(result.value("rows").toLongLong())
+                           .arg(result.value("rowsPerSecond").toDouble(), 0, 'f', 0)
+                           .arg(result.value("filePath").toString()));
+    }
+    emit exportFinished(tag, result);
 }
 
-void AppContext::handleCountFinished(const QString& requestTag, int total)
+void AppContext::handleExportError(const QString& requestId, const QString& error)
 {
-    emit countFinished(requestTag, total);
+    const QString tag = takeRequest(requestId);
+    if (tag.isEmpty()) return;
+    emit exportError(tag, sanitizeDriverErrorSuffix(error));
 }
 
 }
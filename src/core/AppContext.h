@@ -7,12 +7,16 @@
 #include "ILocalStoreService.h"
 #include "ISecretsService.h"
 #include "AddonHost.h"
+#include <QHash>
+#include <QSet>
+#include <QTimer>
 #include <QVariantList>
 #include <QVariantMap>
 #include <QStringList>
 #include <QString>
-#include <QThread>
-#include "QueryWorker.h"
+#include "QueryScheduler.h"
+#include "CatalogTreeModel.h"
+#include "CatalogSearchModel.h"
 
 namespace Sofa::Core {
 
@@ -23,6 +27,8 @@ class AppContext : public QObject {
     Q_PROPERTY(int activeConnectionId READ activeConnectionId NOTIFY activeConnectionIdChanged)
     Q_PROPERTY(QString lastError READ lastError NOTIFY lastErrorChanged)
     Q_PROPERTY(bool queryRunning READ queryRunning NOTIFY queryRunningChanged)
+    Q_PROPERTY(Sofa::Core::CatalogTreeModel* catalogModel READ catalogModel CONSTANT)
+    Q_PROPERTY(Sofa::Core::CatalogSearchModel* catalogSearch READ catalogSearch CONSTANT)
 
 public:
     explicit AppContext(std::shared_ptr<ICommandService> commandService,
@@ -54,17 +60,53 @@ public:
     Q_INVOKABLE QStringList getSchemas();
     Q_INVOKABLE QStringList getHiddenSchemas();
     Q_INVOKABLE QVariantList getTables(const QString& schema);
+    // The explorer tree for the active connection, loaded through the async
+    // catalog requests below and kept in sync with catalogChanged.
+    CatalogTreeModel* catalogModel() const { return m_catalogModel; }
+    // Quick-open matches over every table, column and index read so far.
+    CatalogSearchModel* catalogSearch() const { return m_catalogSearch; }
+    // Async versions for the explorer: schemasFinished carries { schemas, hiddenSchemas };
+    // tables stream in tablesBatch { schema, tables, reset } before tablesFinished { schema, count }.
+    Q_INVOKABLE bool getSchemasAsync(const QString& requestTag = "schemas");
+    Q_INVOKABLE bool getTablesAsync(const QString& schema, const QString& requestTag = "tables");
     
     // Query API
     Q_INVOKABLE QVariantMap runQuery(const QString& queryText);
     Q_INVOKABLE QVariantList getQueryHistory(int connectionId);
     Q_INVOKABLE QVariantMap getDataset(const QString& schema, const QString& table, int limit = 100, int offset = 0, const QString& sortColumn = QString(), bool sortAscending = true, const QString& filterClause = QString());
-    Q_INVOKABLE bool runQueryAsync(const QString& queryText, const QString& requestTag = "sql");
-    Q_INVOKABLE bool getDatasetAsync(const QString& schema, const QString& table, int limit = 100, int offset = 0, const QString& sortColumn = QString(), bool sortAscending = true, const QString& requestTag = "table", const QString& filterClause = QString());
+    // limits may override statementTimeoutMs / maxRows / maxBytes for this run;
+    // the rest comes from the query_* settings (see queryLimits()).
+    Q_INVOKABLE bool runQueryAsync(const QString& queryText, const QString& requestTag = "sql", const QVariantMap& limits = QVariantMap());
+    Q_INVOKABLE bool getDatasetAsync(const QString& schema, const QString& table, int limit = 100, int offset = 0, const QString& sortColumn = QString(), bool sortAscending = true, const QString& requestTag = "table", const QString& filterClause = QString(), const QString& pagingKey = QString(), const QString& cursor = QString(), bool withCount = false);
+    Q_INVOKABLE void closeDatasetCursor(const QString& pagingKey);
     Q_INVOKABLE bool getTableSchemaAsync(const QString& schema, const QString& table, const QString& requestTag = "schema");
     Q_INVOKABLE bool getTableIndexesAsync(const QString& schema, const QString& table, const QString& requestTag = "indexes");
-    Q_INVOKABLE void getCount(const QString& schema, const QString& table, const QString& requestTag);
+    // Every index of the schema as one "indexes" request: tableIndexesFinished
+    // carries { schema, tables: { table: [index, ...] } }.
+    Q_INVOKABLE bool getSchemaIndexesAsync(const QString& schema, const QString& requestTag = "schemaIndexes");
+    // Exact count in the background (cancellable with cancelRequest). Results are
+    // cached per (table, filter) until invalidateRowCounts() or any SQL console run.
+    Q_INVOKABLE void getCount(const QString& schema, const QString& table, const QString& filterClause, const QString& requestTag);
+    // Cached exact count, or -1.
+    Q_INVOKABLE double cachedRowCount(const QString& schema, const QString& table, const QString& filterClause) const;
+    Q_INVOKABLE void invalidateRowCounts(const QString& schema = QString(), const QString& table = QString());
+    // Drops cached catalog metadata (see CatalogCache) after DDL; no schema drops
+    // everything for the connection. Emits catalogChanged.
+    Q_INVOKABLE void invalidateCatalog(const QString& schema = QString(), const QString& table = QString());
+    // Loads a CSV/TSV file (path or file:// URL) into schema.table with COPY.
+    // options: format ("csv"|"tsv"), delimiter, hasHeader (default true) and
+    // columnMapping {fileColumn: tableColumn}. Cancel with cancelRequest(requestTag).
+    Q_INVOKABLE bool importFileAsync(const QString& schema, const QString& table, const QString& filePath, const QVariantMap& options = QVariantMap(), const QString& requestTag = "import");
+    // Writes a query result to a file (path or file:// URL) with COPY TO STDOUT.
+    // source: {sql} or {schema, table, filter}. options: format ("csv"|"jsonl"|"sql"),
+    // insertBatchRows and insertTable for sql; parallel (connections for large
+    // tables, default: export_parallel_connections setting, 4) and shards (one
+    // file per range). Cancel with cancelRequest(requestTag).
+    Q_INVOKABLE bool exportAsync(const QVariantMap& source, const QString& filePath, const QVariantMap& options = QVariantMap(), const QString& requestTag = "export");
     Q_INVOKABLE bool cancelActiveQuery();
+    // notify = false cancels without the *Canceled signal, for requests the
+    // caller abandons itself (tab closed, filter changed).
+    Q_INVOKABLE bool cancelRequest(const QString& requestTag, bool notify = true);
     
     // App State API
     Q_INVOKABLE void saveAppState(const QVariantMap& state);
@@ -79,6 +121,7 @@ signals:
     void lastErrorChanged();
     void queryRunningChanged();
     void sqlStarted(const QString& requestTag);
+    void sqlBatch(const QString& requestTag, const QVariantMap& batch);
     void sqlFinished(const QString& requestTag, const QVariantMap& result);
     void sqlError(const QString& requestTag, const QString& error);
     void sqlCanceled(const QString& requestTag);
@@ -89,11 +132,36 @@ signals:
     void tableSchemaStarted(const QString& requestTag);
     void tableSchemaFinished(const QString& requestTag, const QVariantMap& result);
     void tableSchemaError(const QString& requestTag, const QString& error);
+    void tableSchemaCanceled(const QString& requestTag);
     void tableIndexesStarted(const QString& requestTag);
     void tableIndexesFinished(const QString& requestTag, const QVariantMap& result);
     void tableIndexesError(const QString& requestTag, const QString& error);
-    void countFinished(const QString& requestTag, int total);
+    void tableIndexesCanceled(const QString& requestTag);
+    void schemasStarted(const QString& requestTag);
+    void schemasFinished(const QString& requestTag, const QVariantMap& result);
+    void schemasError(const QString& requestTag, const QString& error);
+    void schemasCanceled(const QString& requestTag);
+    void tablesStarted(const QString& requestTag);
+    void tablesBatch(const QString& requestTag, const QVariantMap& batch);
+    void tablesFinished(const QString& requestTag, const QVariantMap& result);
+    void tablesError(const QString& requestTag, const QString& error);
+    void tablesCanceled(const QString& requestTag);
+    void countStarted(const QString& requestTag);
+    void countFinished(const QString& requestTag, double total);
     void countError(const QString& requestTag, const QString& error);
+    void countCanceled(const QString& requestTag);
+    void importStarted(const QString& requestTag);
+    void importProgress(const QString& requestTag, const QVariantMap& progress);
+    void importFinished(const QString& requestTag, const QVariantMap& result);
+    void importError(const QString& requestTag, const QString& error);
+    void importCanceled(const QString& requestTag);
+    void exportStarted(const QString& requestTag);
+    void exportProgress(const QString& requestTag, const QVariantMap& progress);
+    void exportFinished(const QString& requestTag, const QVariantMap& result);
+    void exportError(const QString& requestTag, const QString& error);
+    void exportCanceled(const QString& requestTag);
+    // Cached catalog entries were dropped; an empty schema means all of them.
+    void catalogChanged(const QString& schema, const QString& table);
 
 private:
     std::shared_ptr<ICommandService> m_commandService;
@@ -106,18 +174,39 @@ private:
     int m_currentConnectionId = -1;
     QString m_lastError;
     bool m_queryRunning = false;
-    int m_activeBackendPid = -1;
-    QString m_activeRequestTag;
-    QString m_activeRequestType;
     QVariantMap m_activeConnectionInfo;
-    QueryWorker* m_worker = nullptr;
-    QThread m_workerThread;
+    QueryScheduler* m_scheduler = nullptr;
+    // Exact counts by rowCountKey(); the pending map remembers which key a running count fills.
+    QHash<QString, qint64> m_rowCounts;
+    QHash<QString, QString> m_pendingRowCounts;
+    std::shared_ptr<CatalogCache> m_catalogCache;
+    CatalogTreeModel* m_catalogModel = nullptr;
+    CatalogSearchModel* m_catalogSearch = nullptr;
+    // Console requests whose SQL looked like DDL: the catalog is dropped when they end.
+    QSet<QString> m_ddlRequests;
+    // Polls the driver's catalog version (catalog_poll_interval_ms, 0 = off).
+    QTimer m_catalogPollTimer;
     
+
     void refreshConnections();
     void setLastError(const QString& error);
+    QString asyncUnavailableReason() const;
+    bool cancelRequestById(const QString& requestId, bool notify = true);
+    QString startRequest(const QString& requestId, int backendPid);
+    QString takeRequest(const QString& requestId);
+    QString rowCountKey(const QString& schema, const QString& table, const QString& filterClause) const;
+    // query_statement_timeout_ms / query_max_rows / query_max_bytes, where
+    // connection_<id>_<setting> wins over the global one and overrides win over both.
+    QueryLimits queryLimits(const QVariantMap& overrides = QVariantMap()) const;
+    QString catalogCacheKey() const;
+    void checkCatalogVersion();
+    // Persists the active connection's catalog lists (catalog_snapshot setting).
+    void saveCatalogSnapshot();
 
 private slots:
+    void updateQueryRunning();
     void handleSqlStarted(const QString& requestTag, int backendPid);
+    void handleSqlBatch(const QString& requestTag, const QVariantMap& batch);
     void handleSqlFinished(const QString& requestTag, const QVariantMap& result);
     void handleSqlError(const QString& requestTag, const QString& error);
     void handleDatasetStarted(const QString& requestTag, int backendPid);
@@ -129,7 +218,25 @@ private slots:
     void handleTableIndexesStarted(const QString& requestTag, int backendPid);
     void handleTableIndexesFinished(const QString& requestTag, const QVariantMap& result);
     void handleTableIndexesError(const QString& requestTag, const QString& error);
-    void handleCountFinished(const QString& requestTag, int total);
+    void handleSchemasStarted(const QString& requestTag, int backendPid);
+    void handleSchemasFinished(const QString& requestTag, const QVariantMap& result);
+    void handleSchemasError(const QString& requestTag, const QString& error);
+    void handleTablesStarted(const QString& requestTag, int backendPid);
+    void handleTablesBatch(const QString& requestTag, const QVariantMap& batch);
+    void handleTablesFinished(const QString& requestTag, const QVariantMap& result);
+    void handleTablesError(const QString& requestTag, const QString& error);
+    void handleCountStarted(const QString& requestTag, int backendPid);
+    void handleCountFinished(const QString& requestTag, qint64 total);
+    void handleCountError(const QString& requestTag, const QString& error);
+    void handleImportStarted(const QString& requestTag, int backendPid);
+    void handleImportProgress(const QString& requestTag, const QVariantMap& progress);
+    void handleImportFinished(const QString& requestTag, const QVariantMap& result);
+    void handleImportError(const QString& requestTag, const QString& error);
+    void handleExportStarted(const QString& requestTag, int backendPid);
+    void handleExportProgress(const QString& requestTag, const QVariantMap& progress);
+    void handleExportFinished(const QString& requestTag, const QVariantMap& result);
+    void handleExportError(const QString& requestTag, const QString& error);
+    void handleCatalogVersion(const QString& requestTag, const QString& version);
 
 };
 
@@ -0,0 +1,55 @@
+#include "CancelToken.h"
+
+namespace Sofa::Core {
+
+CancelToken::CancelToken(std::unique_ptr<ICancelHandle> handle)
+    : m_handle(std::move(handle))
+{
+}
+
+bool CancelToken::cancel(QString* error)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_handle) {
+        if (error) *error = "Request is no longer running";
+        return false;
+    }
+    return m_handle->cancel(error);
+}
+
+void CancelToken::release()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_handle.reset();
+}
+
+bool CancelToken::isActive() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_handle != nullptr;
+}
+
+void CancelHandleGroup::add(std::unique_ptr<ICancelHandle> handle)
+{
+    if (!handle) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_canceled) {
+        handle->cancel(nullptr);
+    }
+    m_handles.push_back(std::move(handle));
+}
+
+bool CancelHandleGroup::cancel(QString* error)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_canceled = true;
+    bool canceled = false;
+    for (const auto& handle : m_handles) {
+        canceled = handle->cancel(error) || canceled;
+    }
+    return canceled || m_handles.empty();
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "addons/IAddon.h"
+
+namespace Sofa::Core {
+
+// Cancels one running request through the driver's out-of-band mechanism
+// (libpq's PQcancel for Postgres), without a second session or SQL round trip.
+// The worker releases the token when the request's job returns, before the
+// connection can serve anything else, so a late cancel never hits the next request.
+class CancelToken {
+public:
+    explicit CancelToken(std::unique_ptr<ICancelHandle> handle);
+
+    // Safe from any thread. False once released, or if the driver refused.
+    bool cancel(QString* error = nullptr);
+    void release();
+    bool isActive() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::unique_ptr<ICancelHandle> m_handle;
+};
+
+using CancelTokenPtr = std::shared_ptr<CancelToken>;
+
+// One request spread over several connections (e.g. a parallel export):
+// cancelling it cancels all of them. Handles added after a cancel are
+// cancelled right away, so a connection that joins late is not missed.
+class CancelHandleGroup : public ICancelHandle {
+public:
+    // Safe from any thread, like cancel().
+    void add(std::unique_ptr<ICancelHandle> handle);
+    bool cancel(QString* error) override;
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<ICancelHandle>> m_handles;
+    bool m_canceled = false;
+};
+
+}
+
+Q_DECLARE_METATYPE(Sofa::Core::CancelTokenPtr)
@@ -0,0 +1,318 @@
+#include "CatalogCache.h"
+#include <QChar>
+#include <QDataStream>
+#include <QIODevice>
+
+namespace {
+
+// Bumped whenever the snapshot layout changes; older snapshots are ignored.
+constexpr quint32 kSnapshotFormat = 1;
+
+} // namespace
+
+namespace Sofa::Core {
+
+QString CatalogCache::nameKey(const QString& schema, const QString& table)
+{
+    return schema + QChar(0x1f) + table;
+}
+
+const CatalogCache::TableEntry* CatalogCache::findTable(const ConnectionEntry& entry, const QString& schema, const QString& table)
+{
+    const QString key = nameKey(schema, table);
+    const auto oid = entry.oidByName.constFind(key);
+    if (oid != entry.oidByName.constEnd()) {
+        const auto it = entry.tablesByOid.find(oid.value());
+        return it != entry.tablesByOid.end() ? &it->second : nullptr;
+    }
+    const auto it = entry.tablesByName.constFind(key);
+    return it != entry.tablesByName.constEnd() ? &it.value() : nullptr;
+}
+
+CatalogCache::TableEntry& CatalogCache::tableEntry(ConnectionEntry& entry, const QString& schema, const QString& table, quint32 oid)
+{
+    const QString key = nameKey(schema, table);
+    if (oid == 0) {
+        oid = entry.oidByName.value(key, 0);
+    }
+    if (oid == 0) {
+        return entry.tablesByName[key];
+    }
+    entry.oidByName.insert(key, oid);
+    // A name entry made before the OID was known moves under it.
+    auto byName = entry.tablesByName.find(key);
+    if (byName != entry.tablesByName.end()) {
+        TableEntry moved = std::move(byName.value());
+        entry.tablesByName.erase(byName);
+        return entry.tablesByOid[oid] = std::move(moved);
+    }
+    return entry.tablesByOid[oid];
+}
+
+CatalogCache::ConnectionEntry* CatalogCache::currentEntry(const QString& connection, quint64 generation)
+{
+    ConnectionEntry& entry = m_connections[connection];
+    return entry.generation == generation ? &entry : nullptr;
+}
+
+quint64 CatalogCache::generation(const QString& connection) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_connections.find(connection);
+    return it != m_connections.end() ? it->second.generation : 1;
+}
+
+bool CatalogCache::schemas(const QString& connection, QStringList* schemas, QStringList* hiddenSchemas) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_connections.find(connection);
+    if (it == m_connections.end() || !it->second.hasSchemas) {
+        return false;
+    }
+    *schemas = it->second.schemas;
+    *hiddenSchemas = it->second.hiddenSchemas;
+    return true;
+}
+
+void CatalogCache::storeSchemas(const QString& connection, const QStringList& schemas, const QStringList& hiddenSchemas, quint64 generation)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ConnectionEntry* entry = currentEntry(connection, generation)) {
+        entry->schemas = schemas;
+        entry->hiddenSchemas = hiddenSchemas;
+        entry->hasSchemas = true;
+    }
+}
+
+bool CatalogCache::tables(const QString& connection, const QString& schema, std::vector<CatalogTable>* tables) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_connections.find(connection);
+    if (it == m_connections.end()) {
+        return false;
+    }
+    const auto cached = it->second.tablesBySchema.constFind(schema);
+    if (cached == it->second.tablesBySchema.constEnd()) {
+        return false;
+    }
+    *tables = cached.value();
+    return true;
+}
+
+void CatalogCache::storeTables(const QString& connection, const QString& schema, const std::vector<CatalogTable>& tables, quint64 generation)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ConnectionEntry* entry = currentEntry(connection, generation);
+    if (!entry) {
+        return;
+    }
+    entry->tablesBySchema.insert(schema, tables);
+    for (const auto& table : tables) {
+        if (table.oid != 0) {
+            tableEntry(*entry, schema, table.name, table.oid);
+        }
+    }
+}
+
+bool CatalogCache::tableSchema(const QString& connection, const QString& schema, const QString& table, TableSchema* tableSchema) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_connections.find(connection);
+    if (it == m_connections.end()) {
+        return false;
+    }
+    const TableEntry* entry = findTable(it->second, schema, table);
+    if (!entry || !entry->hasSchema) {
+        return false;
+    }
+    *tableSchema = entry->schema;
+    return true;
+}
+
+void CatalogCache::storeTableSchema(const QString& connection, const TableSchema& tableSchema, quint64 generation)
+{
+    // An empty column list means the table was not found: not worth keeping.
+    if (tableSchema.columns.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ConnectionEntry* entry = currentEntry(connection, generation)) {
+        TableEntry& table = tableEntry(*entry, tableSchema.schema, tableSchema.name, tableSchema.oid);
+        table.schema = tableSchema;
+        table.hasSchema = true;
+    }
+}
+
+bool CatalogCache::tableIndexes(const QString& connection, const QString& schema, const QString& table, std::vector<TableIndex>* indexes) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_connections.find(connection);
+    if (it == m_connections.end()) {
+        return false;
+    }
+    const TableEntry* entry = findTable(it->second, schema, table);
+    if (!entry || !entry->hasIndexes) {
+        return false;
+    }
+    *indexes = entry->indexes;
+    return true;
+}
+
+void CatalogCache::storeTableIndexes(const QString& connection, const QString& schema, const QString& table, const std::vector<TableIndex>& indexes, quint64 generation)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ConnectionEntry* entry = currentEntry(connection, generation)) {
+        TableEntry& cached = tableEntry(*entry, schema, table);
+        cached.indexes = indexes;
+        cached.hasIndexes = true;
+    }
+}
+
+void CatalogCache::invalidate(const QString& connection, const QString& schema, const QString& table)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ConnectionEntry& entry = m_connections[connection];
+    // Readers that started before this point must not store what they read.
+    ++entry.generation;
+
+    if (schema.isEmpty()) {
+        const quint64 generation = entry.generation;
+        const QString version = entry.version;
+        entry = ConnectionEntry();
+        entry.generation = generation;
+        entry.version = version;
+        return;
+    }
+
+    entry.tablesBySchema.remove(schema);
+    if (!table.isEmpty()) {
+        const QString key = nameKey(schema, table);
+        entry.tablesByOid.erase(entry.oidByName.value(key, 0));
+        entry.oidByName.remove(key);
+        entry.tablesByName.remove(key);
+        return;
+    }
+
+    // The whole schema (and possibly its list of schemas) changed.
+    entry.hasSchemas = false;
+    const QString prefix = schema + QChar(0x1f);
+    for (auto oid = entry.oidByName.begin(); oid != entry.oidByName.end();) {
+        if (oid.key().startsWith(prefix)) {
+            entry.tablesByOid.erase(oid.value());
+            oid = entry.oidByName.erase(oid);
+        } else {
+            ++oid;
+        }
+    }
+    for (auto named = entry.tablesByName.begin(); named != entry.tablesByName.end();) {
+        if (named.key().startsWith(prefix)) {
+            named = entry.tablesByName.erase(named);
+        } else {
+            ++named;
+        }
+    }
+}
+
+bool CatalogCache::checkVersion(const QString& connection, const QString& version)
+{
+    if (version.isEmpty()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ConnectionEntry& entry = m_connections[connection];
+        if (entry.version.isEmpty() || entry.version == version) {
+            entry.version = version;
+            return false;
+        }
+        entry.version = version;
+    }
+    invalidate(connection);
+    return true;
+}
+
+QByteArray CatalogCache::snapshot(const QString& connection) const
+{
+    QByteArray data;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_connections.find(connection);
+        if (it == m_connections.end() || it->second.version.isEmpty() || !it->second.hasSchemas) {
+            return QByteArray();
+        }
+        const ConnectionEntry& entry = it->second;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << kSnapshotFormat << entry.version << entry.schemas << entry.hiddenSchemas;
+        out << static_cast<quint32>(entry.tablesBySchema.size());
+        for (auto schema = entry.tablesBySchema.cbegin(); schema != entry.tablesBySchema.cend(); ++schema) {
+            out << schema.key() << static_cast<quint32>(schema.value().size());
+            for (const auto& table : schema.value()) {
+                out << table.name << table.oid << table.hasPrimaryKey << table.kind
+                    << static_cast<qint64>(table.estimatedRows) << static_cast<qint64>(table.estimatedBytes);
+            }
+        }
+    }
+    return qCompress(data);
+}
+
+bool CatalogCache::restore(const QString& connection, const QByteArray& snapshot)
+{
+    if (snapshot.isEmpty()) {
+        return false;
+    }
+    const QByteArray data = qUncompress(snapshot);
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 format = 0;
+    QString version;
+    QStringList schemas;
+    QStringList hiddenSchemas;
+    quint32 schemaCount = 0;
+    in >> format;
+    if (format != kSnapshotFormat) {
+        return false;
+    }
+    in >> version >> schemas >> hiddenSchemas >> schemaCount;
+    QHash<QString, std::vector<CatalogTable>> tablesBySchema;
+    for (quint32 i = 0; i < schemaCount && in.status() == QDataStream::Ok; ++i) {
+        QString schema;
+        quint32 tableCount = 0;
+        in >> schema >> tableCount;
+        std::vector<CatalogTable> tables;
+        for (quint32 j = 0; j < tableCount && in.status() == QDataStream::Ok; ++j) {
+            CatalogTable table;
+            qint64 estimatedRows = -1;
+            qint64 estimatedBytes = -1;
+            in >> table.name >> table.oid >> table.hasPrimaryKey >> table.kind >> estimatedRows >> estimatedBytes;
+            table.estimatedRows = estimatedRows;
+            table.estimatedBytes = estimatedBytes;
+            tables.push_back(table);
+        }
+        tablesBySchema.insert(schema, std::move(tables));
+    }
+    if (in.status() != QDataStream::Ok || version.isEmpty()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ConnectionEntry& entry = m_connections[connection];
+    if (entry.hasSchemas || !entry.tablesBySchema.isEmpty()) {
+        return false;
+    }
+    entry.version = version;
+    entry.schemas = schemas;
+    entry.hiddenSchemas = hiddenSchemas;
+    entry.hasSchemas = true;
+    for (auto schema = tablesBySchema.cbegin(); schema != tablesBySchema.cend(); ++schema) {
+        for (const auto& table : schema.value()) {
+            if (table.oid != 0) {
+                tableEntry(entry, schema.key(), table.name, table.oid);
+            }
+        }
+    }
+    entry.tablesBySchema = std::move(tablesBySchema);
+    return true;
+}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "udm/UDM.h"
+
+namespace Sofa::Core {
+
+// Catalog metadata already read from a connection (keyed by
+// ConnectionPool::keyFor), so the explorer, table tabs and structure views
+// don't go back to the server for objects they have seen. Tables are keyed by
+// OID when the driver reports one, by name otherwise.
+// Shared by the UI thread and the query workers; every call locks.
+//
+// Entries are dropped by invalidate() after DDL, or when the driver's catalog
+// version changes (checkVersion()). A reader takes generation() before going to
+// the server and passes it to store*: a result read across an invalidation is
+// discarded instead of bringing stale metadata back.
+class CatalogCache {
+public:
+    quint64 generation(const QString& connection) const;
+
+    // Visible and hidden schema lists, as the explorer shows them.
+    bool schemas(const QString& connection, QStringList* schemas, QStringList* hiddenSchemas) const;
+    void storeSchemas(const QString& connection, const QStringList& schemas, const QStringList& hiddenSchemas, quint64 generation);
+
+    bool tables(const QString& connection, const QString& schema, std::vector<CatalogTable>* tables) const;
+    void storeTables(const QString& connection, const QString& schema, const std::vector<CatalogTable>& tables, quint64 generation);
+
+    bool tableSchema(const QString& connection, const QString& schema, const QString& table, TableSchema* tableSchema) const;
+    void storeTableSchema(const QString& connection, const TableSchema& tableSchema, quint64 generation);
+
+    bool tableIndexes(const QString& connection, const QString& schema, const QString& table, std::vector<TableIndex>* indexes) const;
+    void storeTableIndexes(const QString& connection, const QString& schema, const QString& table, const std::vector<TableIndex>& indexes, quint64 generation);
+
+    // A table drops its own entries and its schema's table list; a schema drops
+    // its tables; no schema drops everything for the connection.
+    void invalidate(const QString& connection, const QString& schema = QString(), const QString& table = QString());
+    // Records the catalog version the entries belong to. Returns true (and
+    // drops everything) when it differs from the previous one.
+    bool checkVersion(const QString& connection, const QString& version);
+
+    // Schema and table lists with the catalog version they were read under,
+    // to be persisted across sessions. Empty when there is no list or no
+    // version to check it against.
+    QByteArray snapshot(const QString& connection) const;
+    // Loads a snapshot into an entry that holds no lists yet. Its version is
+    // then compared by checkVersion(), which drops it if the server moved on.
+    bool restore(const QString& connection, const QByteArray& snapshot);
+
+private:
+    struct TableEntry {
+        bool hasSchema = false;
+        TableSchema schema;
+        bool hasIndexes = false;
+        std::vector<TableIndex> indexes;
+    };
+
+    struct ConnectionEntry {
+        quint64 generation = 1;
+        QString version;
+        bool hasSchemas = false;
+        QStringList schemas;
+        QStringList hiddenSchemas;
+        QHash<QString, std::vector<CatalogTable>> tablesBySchema;
+        QHash<QString, quint32> oidByName;
+        std::map<quint32, TableEntry> tablesByOid;
+        QHash<QString, TableEntry> tablesByName;
+    };
+
+    static QString nameKey(const QString& schema, const QString& table);
+    static const TableEntry* findTable(const ConnectionEntry& entry, const QString& schema, const QString& table);
+    static TableEntry& tableEntry(ConnectionEntry& entry, const QString& schema, const QString& table, quint32 oid = 0);
+    // The connection's entry when generation is still current, else nullptr.
+    ConnectionEntry* currentEntry(const QString& connection, quint64 generation);
+
+    mutable std::mutex m_mutex;
+    std::map<QString, ConnectionEntry> m_connections;
+};
+
+}
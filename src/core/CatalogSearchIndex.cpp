@@ -0,0 +1,387 @@
+#include "CatalogSearchIndex.h"
+#include <QChar>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Tombstones are swept once they outnumber live entries (and are worth it).
+constexpr int kCompactMinDead = 4096;
+// Fuzzy matches never outrank a substring match.
+constexpr int kSubstringScore = 500;
+constexpr int kMaxFuzzyScore = 400;
+// Alternative alignments tried per entry, starting at word starts.
+constexpr int kMaxFuzzyStarts = 8;
+// A match inside the object's own name beats any match needing its prefix.
+constexpr int kNameMatchBonus = 1000;
+
+bool isSeparator(QChar c)
+{
+    return c == u'.' || c == u'_' || c == u'-' || c == u' ' || c == u'$';
+}
+
+} // namespace
+
+namespace Sofa::Core {
+
+quint64 CatalogSearchIndex::charMask(QStringView text)
+{
+    quint64 mask = 0;
+    for (const QChar c : text) {
+        const char16_t u = c.unicode();
+        if (u >= u'a' && u <= u'z') {
+            mask |= quint64(1) << (u - u'a');
+        } else if (u >= u'0' && u <= u'9') {
+            mask |= quint64(1) << (26 + u - u'0');
+        } else if (u == u'_') {
+            mask |= quint64(1) << 36;
+        } else if (u == u'.') {
+            mask |= quint64(1) << 37;
+        } else {
+            mask |= quint64(1) << 63;
+        }
+    }
+    return mask;
+}
+
+QString CatalogSearchIndex::groupKey(const QString& schema, const QString& table)
+{
+    return schema + QChar(0x1f) + table;
+}
+
+QString CatalogSearchIndex::name(int entry) const
+{
+    const Entry& e = m_entries[entry];
+    return m_text.mid(e.offset + e.nameStart, e.length - e.nameStart);
+}
+
+QString CatalogSearchIndex::text(int entry) const
+{
+    const Entry& e = m_entries[entry];
+    return m_text.mid(e.offset, e.length);
+}
+
+void CatalogSearchIndex::changed()
+{
+    ++m_generation;
+}
+
+int CatalogSearchIndex::groupFor(const QString& schema, const QString& table)
+{
+    const QString key = groupKey(schema, table);
+    const auto it = m_groupByKey.constFind(key);
+    if (it != m_groupByKey.constEnd()) {
+        return it.value();
+    }
+    const int group = static_cast<int>(m_groups.size());
+    Group g;
+    g.schema = schema;
+    g.table = table;
+    m_groups.push_back(std::move(g));
+    m_groupByKey.insert(key, group);
+    m_groupsBySchema[schema].push_back(group);
+    m_groups[group].tableEntry = addEntry(group, Kind::Table, table);
+    return group;
+}
+
+int CatalogSearchIndex::addEntry(int group, Kind kind, const QString& name)
+{
+    const Group& g = m_groups[group];
+    QString text = g.schema + u'.';
+    if (kind != Kind::Table) {
+        text += g.table + u'.';
+    }
+    Entry entry;
+    entry.offset = static_cast<int>(m_text.size());
+    entry.nameStart = static_cast<int>(text.size());
+    text += name;
+    entry.length = static_cast<int>(text.size());
+    entry.group = group;
+    entry.kind = kind;
+
+    m_text += text;
+    // Folded one QChar at a time so offsets stay the same in both buffers.
+    for (const QChar c : std::as_const(text)) {
+        m_folded += c.toLower();
+    }
+    entry.mask = charMask(QStringView(m_folded).mid(entry.offset, entry.length));
+
+    m_entries.push_back(entry);
+    changed();
+    return static_cast<int>(m_entries.size()) - 1;
+}
+
+void CatalogSearchIndex::removeEntries(std::vector<int>& entries)
+{
+    for (const int id : entries) {
+        if (m_entries[id].alive) {
+            m_entries[id].alive = false;
+            ++m_dead;
+        }
+    }
+    if (!entries.empty()) {
+        entries.clear();
+        changed();
+    }
+}
+
+void CatalogSearchIndex::removeGroup(int group)
+{
+    Group& g = m_groups[group];
+    if (!g.alive) {
+        return;
+    }
+    removeEntries(g.columns);
+    removeEntries(g.indexes);
+    std::vector<int> table { g.tableEntry };
+    removeEntries(table);
+    g.alive = false;
+    m_groupByKey.remove(groupKey(g.schema, g.table));
+}
+
+void CatalogSearchIndex::beginTables(const QString& schema)
+{
+    ++m_schemaPass[schema];
+}
+
+void CatalogSearchIndex::addTables(const QString& schema, const QStringList& tables)
+{
+    const quint32 pass = m_schemaPass.value(schema, 0);
+    for (const auto& table : tables) {
+        const int group = groupFor(schema, table);
+        m_groups[group].pass = pass;
+    }
+}
+
+void CatalogSearchIndex::endTables(const QString& schema)
+{
+    const quint32 pass = m_schemaPass.value(schema, 0);
+    const std::vector<int> groups = m_groupsBySchema.value(schema);
+    for (const int group : groups) {
+        if (m_groups[group].alive && m_groups[group].pass != pass) {
+            removeGroup(group);
+        }
+    }
+    compact();
+}
+
+void CatalogSearchIndex::removeSchema(const QString& schema)
+{
+    const std::vector<int> groups = m_groupsBySchema.value(schema);
+    for (const int group : groups) {
+        removeGroup(group);
+    }
+    m_groupsBySchema.remove(schema);
+    m_schemaPass.remove(schema);
+    compact();
+}
+
+void CatalogSearchIndex::setColumns(const QString& schema, const QString& table, const QStringList& columns)
+{
+    const int group = groupFor(schema, table);
+    removeEntries(m_groups[group].columns);
+    for (const auto& column : columns) {
+        const int entry = addEntry(group, Kind::Column, column);
+        m_groups[group].columns.push_back(entry);
+    }
+}
+
+void CatalogSearchIndex::setIndexes(const QString& schema, const QString& table, const QStringList& indexes)
+{
+    const int group = groupFor(schema, table);
+    removeEntries(m_groups[group].indexes);
+    for (const auto& index : indexes) {
+        const int entry = addEntry(group, Kind::Index, index);
+        m_groups[group].indexes.push_back(entry);
+    }
+}
+
+void CatalogSearchIndex::removeTableDetails(const QString& schema, const QString& table)
+{
+    const auto it = m_groupByKey.constFind(groupKey(schema, table));
+    if (it == m_groupByKey.constEnd()) {
+        return;
+    }
+    removeEntries(m_groups[it.value()].columns);
+    removeEntries(m_groups[it.value()].indexes);
+}
+
+void CatalogSearchIndex::clear()
+{
+    m_text.clear();
+    m_folded.clear();
+    m_entries.clear();
+    m_groups.clear();
+    m_groupByKey.clear();
+    m_groupsBySchema.clear();
+    m_schemaPass.clear();
+    m_dead = 0;
+    changed();
+}
+
+void CatalogSearchIndex::compact()
+{
+    if (m_dead < kCompactMinDead || m_dead < size()) {
+        return;
+    }
+    struct Saved {
+        QString schema;
+        QString table;
+        QStringList columns;
+        QStringList indexes;
+        quint32 pass = 0;
+    };
+    std::vector<Saved> saved;
+    for (const auto& g : m_groups) {
+        if (!g.alive) {
+            continue;
+        }
+        Saved s { g.schema, g.table, {}, {}, g.pass };
+        for (const int id : g.columns) s.columns.append(name(id));
+        for (const int id : g.indexes) s.indexes.append(name(id));
+        saved.push_back(std::move(s));
+    }
+    const QHash<QString, quint32> passes = m_schemaPass;
+    clear();
+    m_schemaPass = passes;
+    for (const auto& s : saved) {
+        const int group = groupFor(s.schema, s.table);
+        m_groups[group].pass = s.pass;
+        for (const auto& column : s.columns) m_groups[group].columns.push_back(addEntry(group, Kind::Column, column));
+        for (const auto& index : s.indexes) m_groups[group].indexes.push_back(addEntry(group, Kind::Index, index));
+    }
+}
+
+int CatalogSearchIndex::scoreIn(QStringView text, QStringView query)
+{
+    const int n = static_cast<int>(text.size());
+    const int m = static_cast<int>(query.size());
+    if (m == 0 || m > n) {
+        return -1;
+    }
+    auto wordStart = [&text](int i) { return i == 0 || isSeparator(text[i - 1]); };
+
+    const int at = static_cast<int>(text.indexOf(query));
+    if (at >= 0) {
+        int score = kSubstringScore - at - (n - m) / 2;
+        if (wordStart(at)) score += 100;
+        if (at == 0) score += 100;
+        if (n == m) score += 200;
+        return score;
+    }
+
+    // Greedy alignment from a given start; -1 when the rest doesn't fit.
+    auto alignFrom = [&](int start) {
+        int score = wordStart(start) ? 16 : 0;
+        int prev = start;
+        for (int k = 1; k < m; ++k) {
+            int j = prev + 1;
+            while (j < n && text[j] != query[k]) {
+                ++j;
+            }
+            if (j == n) {
+                return -1;
+            }
+            if (j == prev + 1) {
+                score += 8;
+            } else {
+                score -= std::min(j - prev - 1, 8);
+            }
+            if (wordStart(j)) {
+                score += 16;
+            }
+            prev = j;
+        }
+        return score - (n - m) / 4;
+    };
+
+    const int first = static_cast<int>(text.indexOf(query[0]));
+    if (first < 0) {
+        return -1;
+    }
+    // The leftmost start is the most permissive: if it fails, all do.
+    int best = alignFrom(first);
+    if (best < 0) {
+        return -1;
+    }
+    int tries = 0;
+    for (int i = first + 1; i < n && tries < kMaxFuzzyStarts; ++i) {
+        if (text[i] == query[0] && wordStart(i)) {
+            ++tries;
+            best = std::max(best, alignFrom(i));
+        }
+    }
+    return std::min(std::max(best, 0), kMaxFuzzyScore);
+}
+
+int CatalogSearchIndex::score(const Entry& entry, QStringView query) const
+{
+    const QStringView text = QStringView(m_folded).mid(entry.offset, entry.length);
+    const int inName = scoreIn(text.mid(entry.nameStart), query);
+    if (inName >= 0) {
+        return inName + kNameMatchBonus;
+    }
+    return scoreIn(text, query);
+}
+
+std::vector<CatalogSearchIndex::Match> CatalogSearchIndex::search(const QString& query, int limit) const
+{
+    QString folded;
+    folded.reserve(query.size());
+    for (const QChar c : query) {
+        if (!c.isSpace()) {
+            folded += c.toLower();
+        }
+    }
+    if (folded.isEmpty() || limit <= 0) {
+        return {};
+    }
+    const quint64 queryMask = charMask(folded);
+
+    std::vector<int> matched;
+    std::vector<Match> results;
+    auto consider = [&](int id) {
+        const Entry& entry = m_entries[id];
+        if (!entry.alive || (entry.mask & queryMask) != queryMask) {
+            return;
+        }
+        const int s = score(entry, folded);
+        if (s < 0) {
+            return;
+        }
+        matched.push_back(id);
+        results.push_back({ id, s });
+    };
+
+    // Anything matching the longer query matched the shorter one too.
+    if (m_lastGeneration == m_generation && !m_lastQuery.isEmpty() && folded.startsWith(m_lastQuery)) {
+        for (const int id : m_lastMatches) {
+            consider(id);
+        }
+    } else {
+        for (int id = 0; id < static_cast<int>(m_entries.size()); ++id) {
+            consider(id);
+        }
+    }
+    m_lastQuery = folded;
+    m_lastGeneration = m_generation;
+    m_lastMatches = std::move(matched);
+
+    auto better = [this](const Match& a, const Match& b) {
+        if (a.score != b.score) return a.score > b.score;
+        const Entry& ea = m_entries[a.entry];
+        const Entry& eb = m_entries[b.entry];
+        if (ea.length != eb.length) return ea.length < eb.length;
+        if (ea.kind != eb.kind) return ea.kind < eb.kind;
+        return a.entry < b.entry;
+    };
+    if (static_cast<int>(results.size()) > limit) {
+        std::partial_sort(results.begin(), results.begin() + limit, results.end(), better);
+        results.resize(static_cast<size_t>(limit));
+    } else {
+        std::sort(results.begin(), results.end(), better);
+    }
+    return results;
+}
+
+}
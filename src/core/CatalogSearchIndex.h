@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+namespace Sofa::Core {
+
+// Quick-open index over the catalog objects of one connection: tables as
+// "schema.table", columns and indexes as "schema.table.name". Filled piece by
+// piece as the catalog is read; lives on the GUI thread.
+//
+// A query matches an object when its characters appear in order in the
+// object's text (case-insensitive, spaces ignored). Matches inside the
+// object's own name rank above ones that need the schema/table prefix; then
+// substrings, word starts ("_", ".") and consecutive runs score higher.
+// Each entry keeps a bitmask of the characters it contains so most entries
+// are rejected without touching the text, and a query that extends the
+// previous one only rescans the previous matches.
+class CatalogSearchIndex {
+public:
+    enum class Kind : quint8 { Table, Column, Index };
+
+    struct Match {
+        int entry = -1;
+        int score = 0;
+    };
+
+    // Replacing a schema's table list: tables added between beginTables and
+    // endTables stay (with their columns and indexes), the others go.
+    void beginTables(const QString& schema);
+    void addTables(const QString& schema, const QStringList& tables);
+    void endTables(const QString& schema);
+    void removeSchema(const QString& schema);
+    void setColumns(const QString& schema, const QString& table, const QStringList& columns);
+    void setIndexes(const QString& schema, const QString& table, const QStringList& indexes);
+    // Drops a table's columns and indexes, keeping the table itself.
+    void removeTableDetails(const QString& schema, const QString& table);
+    void clear();
+
+    // Best matches first, at most limit of them.
+    std::vector<Match> search(const QString& query, int limit) const;
+
+    int size() const { return static_cast<int>(m_entries.size()) - m_dead; }
+    Kind kind(int entry) const { return m_entries[entry].kind; }
+    QString schema(int entry) const { return m_groups[m_entries[entry].group].schema; }
+    QString table(int entry) const { return m_groups[m_entries[entry].group].table; }
+    QString name(int entry) const;
+    QString text(int entry) const;
+
+private:
+    struct Entry {
+        int offset = 0;      // into m_text / m_folded
+        int length = 0;
+        int nameStart = 0;   // offset of the object's own name within its text
+        int group = -1;
+        quint64 mask = 0;
+        Kind kind = Kind::Table;
+        bool alive = true;
+    };
+
+    // A table with its columns and indexes.
+    struct Group {
+        QString schema;
+        QString table;
+        int tableEntry = -1;
+        std::vector<int> columns;
+        std::vector<int> indexes;
+        quint32 pass = 0;
+        bool alive = true;
+    };
+
+    static quint64 charMask(QStringView text);
+    static QString groupKey(const QString& schema, const QString& table);
+    int groupFor(const QString& schema, const QString& table);
+    int addEntry(int group, Kind kind, const QString& name);
+    void removeEntries(std::vector<int>& entries);
+    void removeGroup(int group);
+    void changed();
+    void compact();
+    int score(const Entry& entry, QStringView query) const;
+    static int scoreIn(QStringView text, QStringView query);
+
+    QString m_text;
+    QString m_folded;
+    std::vector<Entry> m_entries;
+    std::vector<Group> m_groups;
+    QHash<QString, int> m_groupByKey;
+    QHash<QString, std::vector<int>> m_groupsBySchema;
+    QHash<QString, quint32> m_schemaPass;
+    int m_dead = 0;
+    quint64 m_generation = 0;
+
+    // Narrowing: the previous query and every entry it matched.
+    mutable QString m_lastQuery;
+    mutable quint64 m_lastGeneration = 0;
+    mutable std::vector<int> m_lastMatches;
+};
+
+}
@@ -0,0 +1,222 @@
+#include "CatalogSearchModel.h"
+#include <QStringList>
+#include <QVariantList>
+
+namespace {
+
+const QString kSchemasTag = QStringLiteral("catalogsearch:schemas");
+const QString kTablesTagPrefix = QStringLiteral("catalogsearch:tables:");
+
+QStringList namesOf(const QVariantList& items)
+{
+    QStringList names;
+    names.reserve(items.size());
+    for (const auto& item : items) {
+        names.append(item.toMap().value("name").toString());
+    }
+    return names;
+}
+
+} // namespace
+
+namespace Sofa::Core {
+
+CatalogSearchModel::CatalogSearchModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(0);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &CatalogSearchModel::refresh);
+}
+
+int CatalogSearchModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+QVariant CatalogSearchModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= static_cast<int>(m_rows.size())) {
+        return QVariant();
+    }
+    const Row& row = m_rows[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return row.name;
+    case KindRole:
+        switch (row.kind) {
+        case CatalogSearchIndex::Kind::Column: return QStringLiteral("column");
+        case CatalogSearchIndex::Kind::Index: return QStringLiteral("index");
+        default: return QStringLiteral("table");
+        }
+    case SchemaRole:
+        return row.schema;
+    case TableRole:
+        return row.table;
+    case TextRole:
+        return row.text;
+    case ScoreRole:
+        return row.score;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> CatalogSearchModel::roleNames() const
+{
+    return {
+        { NameRole, "name" },
+        { KindRole, "kind" },
+        { SchemaRole, "schema" },
+        { TableRole, "table" },
+        { TextRole, "text" },
+        { ScoreRole, "score" },
+    };
+}
+
+void CatalogSearchModel::setQuery(const QString& query)
+{
+    if (m_query == query) {
+        return;
+    }
+    m_query = query;
+    emit queryChanged();
+    // Keystrokes are answered right away; only index updates are coalesced.
+    m_refreshTimer.stop();
+    refresh();
+}
+
+void CatalogSearchModel::setLimit(int limit)
+{
+    if (m_limit == limit) {
+        return;
+    }
+    m_limit = limit;
+    emit limitChanged();
+    scheduleRefresh();
+}
+
+void CatalogSearchModel::scheduleRefresh()
+{
+    emit objectCountChanged();
+    if (!m_query.trimmed().isEmpty() || !m_rows.empty()) {
+        m_refreshTimer.start();
+    }
+}
+
+void CatalogSearchModel::refresh()
+{
+    std::vector<Row> rows;
+    const auto matches = m_index.search(m_query, m_limit);
+    rows.reserve(matches.size());
+    for (const auto& match : matches) {
+        Row row;
+        row.kind = m_index.kind(match.entry);
+        row.name = m_index.name(match.entry);
+        row.schema = m_index.schema(match.entry);
+        row.table = m_index.table(match.entry);
+        row.text = m_index.text(match.entry);
+        row.score = match.score;
+        rows.push_back(std::move(row));
+    }
+    beginResetModel();
+    m_rows = std::move(rows);
+    endResetModel();
+}
+
+void CatalogSearchModel::loadCatalog()
+{
+    emit schemasRequested(kSchemasTag);
+}
+
+void CatalogSearchModel::clear()
+{
+    m_index.clear();
+    m_loadedSchemas.clear();
+    scheduleRefresh();
+}
+
+void CatalogSearchModel::handleSchemasFinished(const QString& requestTag, const QVariantMap& result)
+{
+    if (requestTag != kSchemasTag) {
+        return;
+    }
+    // Hidden (system) schemas are left to the explorer.
+    const QStringList schemas = result.value("schemas").toStringList();
+    for (const auto& schema : schemas) {
+        if (!m_loadedSchemas.contains(schema)) {
+            emit tablesRequested(schema, kTablesTagPrefix + schema);
+        }
+    }
+}
+
+void CatalogSearchModel::handleTablesBatch(const QString& requestTag, const QVariantMap& batch)
+{
+    // Every table list counts, whoever asked for it (the explorer tree too).
+    (void)requestTag;
+    const QString schema = batch.value("schema").toString();
+    if (batch.value("reset").toBool()) {
+        m_index.beginTables(schema);
+    }
+    m_index.addTables(schema, namesOf(batch.value("tables").toList()));
+    scheduleRefresh();
+}
+
+void CatalogSearchModel::handleTablesFinished(const QString& requestTag, const QVariantMap& result)
+{
+    (void)requestTag;
+    const QString schema = result.value("schema").toString();
+    if (result.value("count").toInt() == 0) {
+        // No batch came: the schema is empty now.
+        m_index.beginTables(schema);
+    }
+    m_index.endTables(schema);
+    m_loadedSchemas.insert(schema);
+    scheduleRefresh();
+}
+
+void CatalogSearchModel::handleTableSchemaFinished(const QString& requestTag, const QVariantMap& result)
+{
+    (void)requestTag;
+    const QVariantList columns = result.value("columns").toList();
+    if (columns.isEmpty()) {
+        return;
+    }
+    m_index.setColumns(result.value("schema").toString(), result.value("table").toString(), namesOf(columns));
+    scheduleRefresh();
+}
+
+void CatalogSearchModel::handleTableIndexesFinished(const QString& requestTag, const QVariantMap& result)
+{
+    (void)requestTag;
+    const QString schema = result.value("schema").toString();
+    const QString table = result.value("table").toString();
+    if (!table.isEmpty()) {
+        m_index.setIndexes(schema, table, namesOf(result.value("indexes").toList()));
+    } else {
+        // A schema-wide batch: indexes by table.
+        const QVariantMap tables = result.value("tables").toMap();
+        for (auto it = tables.cbegin(); it != tables.cend(); ++it) {
+            m_index.setIndexes(schema, it.key(), namesOf(it.value().toList()));
+        }
+    }
+    scheduleRefresh();
+}
+
+void CatalogSearchModel::handleCatalogChanged(const QString& schema, const QString& table)
+{
+    if (schema.isEmpty()) {
+        clear();
+        return;
+    }
+    if (!table.isEmpty()) {
+        m_index.removeTableDetails(schema, table);
+    } else {
+        m_index.removeSchema(schema);
+        m_loadedSchemas.remove(schema);
+    }
+    scheduleRefresh();
+}
+
+}
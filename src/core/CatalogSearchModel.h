@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <QVariantMap>
+#include <vector>
+#include "CatalogSearchIndex.h"
+
+namespace Sofa::Core {
+
+// Results of the quick-open palette: the best CatalogSearchIndex matches for
+// query. The index is fed by its owner (AppContext) with every table list,
+// table schema and index list the app reads; loadCatalog() additionally asks
+// for the table lists of schemas nobody has opened yet.
+class CatalogSearchModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+    Q_PROPERTY(int limit READ limit WRITE setLimit NOTIFY limitChanged)
+    Q_PROPERTY(int objectCount READ objectCount NOTIFY objectCountChanged)
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        KindRole, // "table", "column" or "index"
+        SchemaRole,
+        TableRole,
+        TextRole, // schema.table[.name]
+        ScoreRole
+    };
+
+    explicit CatalogSearchModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QString query() const { return m_query; }
+    void setQuery(const QString& query);
+    int limit() const { return m_limit; }
+    void setLimit(int limit);
+    int objectCount() const { return m_index.size(); }
+
+    // Requests the table list of every visible schema not indexed yet.
+    Q_INVOKABLE void loadCatalog();
+    void clear();
+
+public slots:
+    void handleSchemasFinished(const QString& requestTag, const QVariantMap& result);
+    void handleTablesBatch(const QString& requestTag, const QVariantMap& batch);
+    void handleTablesFinished(const QString& requestTag, const QVariantMap& result);
+    void handleTableSchemaFinished(const QString& requestTag, const QVariantMap& result);
+    void handleTableIndexesFinished(const QString& requestTag, const QVariantMap& result);
+    void handleCatalogChanged(const QString& schema, const QString& table);
+
+signals:
+    void queryChanged();
+    void limitChanged();
+    void objectCountChanged();
+    void schemasRequested(const QString& requestTag);
+    void tablesRequested(const QString& schema, const QString& requestTag);
+
+private:
+    struct Row {
+        CatalogSearchIndex::Kind kind;
+        QString name;
+        QString schema;
+        QString table;
+        QString text;
+        int score = 0;
+    };
+
+    // Re-runs the query once the current batch of index updates is done.
+    void scheduleRefresh();
+    void refresh();
+
+    CatalogSearchIndex m_index;
+    QSet<QString> m_loadedSchemas;
+    QString m_query;
+    int m_limit = 50;
+    std::vector<Row> m_rows;
+    QTimer m_refreshTimer;
+};
+
+}
@@ -0,0 +1,507 @@
+#include "CatalogTreeModel.h"
+#include <QChar>
+#include <QDebug>
+#include <QSet>
+#include <QVariantList>
+#include <functional>
+#include <utility>
+
+namespace {
+
+const QString kSchemasTag = QStringLiteral("catalogtree:schemas");
+const QString kTablesTagPrefix = QStringLiteral("catalogtree:tables:");
+const QString kHiddenGroupName = QStringLiteral("Hidden Schemas");
+
+Sofa::Core::CatalogTable catalogTableFromVariant(const QVariantMap& map)
+{
+    Sofa::Core::CatalogTable table;
+    table.name = map.value("name").toString();
+    table.oid = map.value("oid").toUInt();
+    table.hasPrimaryKey = map.value("hasPrimaryKey").toBool();
+    table.kind = map.value("kind").toString();
+    table.estimatedRows = static_cast<long long>(map.value("estimatedRows", -1).toDouble());
+    table.estimatedBytes = static_cast<long long>(map.value("estimatedBytes", -1).toDouble());
+    return table;
+}
+
+} // namespace
+
+namespace Sofa::Core {
+
+CatalogTreeModel::CatalogTreeModel(QObject* parent)
+    : QAbstractItemModel(parent)
+    , m_root(std::make_unique<Node>())
+{
+}
+
+CatalogTreeModel::~CatalogTreeModel() = default;
+
+QString CatalogTreeModel::schemasRequestTag()
+{
+    return kSchemasTag;
+}
+
+QString CatalogTreeModel::tablesRequestTag(const QString& schema)
+{
+    return kTablesTagPrefix + schema;
+}
+
+CatalogTreeModel::Node* CatalogTreeModel::nodeFor(const QModelIndex& index) const
+{
+    return index.isValid() ? static_cast<Node*>(index.internalPointer()) : m_root.get();
+}
+
+QModelIndex CatalogTreeModel::indexFor(const Node* node) const
+{
+    if (!node || node == m_root.get()) {
+        return QModelIndex();
+    }
+    return createIndex(node->row, 0, const_cast<Node*>(node));
+}
+
+QModelIndex CatalogTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    const Node* parentNode = nodeFor(parent);
+    if (column != 0 || row < 0 || row >= static_cast<int>(parentNode->children.size())) {
+        return QModelIndex();
+    }
+    return createIndex(row, 0, parentNode->children[row].get());
+}
+
+QModelIndex CatalogTreeModel::parent(const QModelIndex& child) const
+{
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    return indexFor(nodeFor(child)->parent);
+}
+
+int CatalogTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0) {
+        return 0;
+    }
+    return static_cast<int>(nodeFor(parent)->children.size());
+}
+
+int CatalogTreeModel::columnCount(const QModelIndex& parent) const
+{
+    (void)parent;
+    return 1;
+}
+
+bool CatalogTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    const Node* node = nodeFor(parent);
+    switch (node->type) {
+    case NodeType::Schema:
+        // Unknown until the tables were read: keep the expand arrow.
+        return !node->fetched || !node->children.empty();
+    case NodeType::Table:
+        return false;
+    default:
+        return !node->children.empty();
+    }
+}
+
+QVariant CatalogTreeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    const Node* node = nodeFor(index);
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return node->name;
+    case NodeTypeRole:
+        switch (node->type) {
+        case NodeType::Schema: return QStringLiteral("schema");
+        case NodeType::Group: return QStringLiteral("group");
+        case NodeType::Table: return QStringLiteral("table");
+        default: return QVariant();
+        }
+    case SchemaRole:
+        if (node->type == NodeType::Table) return node->parent->name;
+        if (node->type == NodeType::Schema) return node->name;
+        return QString();
+    case OidRole:
+        return node->table.oid;
+    case HasPrimaryKeyRole:
+        return node->table.hasPrimaryKey;
+    case KindRole:
+        return node->table.kind;
+    case EstimatedRowsRole:
+        return static_cast<double>(node->table.estimatedRows);
+    case HiddenRole:
+        return node->hidden;
+    case LoadingRole:
+        return node->loading;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> CatalogTreeModel::roleNames() const
+{
+    return {
+        { NameRole, "name" },
+        { NodeTypeRole, "nodeType" },
+        { SchemaRole, "schema" },
+        { OidRole, "oid" },
+        { HasPrimaryKeyRole, "hasPrimaryKey" },
+        { KindRole, "kind" },
+        { EstimatedRowsRole, "estimatedRows" },
+        { HiddenRole, "hidden" },
+        { LoadingRole, "loading" },
+    };
+}
+
+bool CatalogTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    const Node* node = nodeFor(parent);
+    return node->type == NodeType::Schema && !node->fetched && !node->loading;
+}
+
+void CatalogTreeModel::fetchMore(const QModelIndex& parent)
+{
+    if (canFetchMore(parent)) {
+        requestTables(nodeFor(parent));
+    }
+}
+
+QModelIndex CatalogTreeModel::schemaIndex(const QString& schema) const
+{
+    return indexFor(schemaNode(schema));
+}
+
+CatalogTreeModel::Node* CatalogTreeModel::schemaNode(const QString& schema) const
+{
+    return m_schemas.value(schema, nullptr);
+}
+
+void CatalogTreeModel::reload(const QString& schema)
+{
+    m_active = true;
+    if (schema.isEmpty()) {
+        m_reloadLoaded = true;
+        emit schemasRequested(kSchemasTag);
+        return;
+    }
+    Node* node = schemaNode(schema);
+    if (node && (node->fetched || node->loading)) {
+        requestTables(node);
+    }
+}
+
+void CatalogTreeModel::clear()
+{
+    beginResetModel();
+    m_root->children.clear();
+    m_schemas.clear();
+    m_active = false;
+    m_reloadLoaded = false;
+    endResetModel();
+}
+
+void CatalogTreeModel::requestTables(Node* schema)
+{
+    schema->incoming.clear();
+    setLoading(schema, true);
+    // Same tag per schema: a newer request supersedes one still running.
+    emit tablesRequested(schema->name, tablesRequestTag(schema->name));
+}
+
+void CatalogTreeModel::setLoading(Node* schema, bool loading)
+{
+    if (schema->loading == loading) {
+        return;
+    }
+    schema->loading = loading;
+    const QModelIndex index = indexFor(schema);
+    emit dataChanged(index, index, { LoadingRole });
+}
+
+void CatalogTreeModel::renumber(Node* parent, int from)
+{
+    for (int i = from; i < static_cast<int>(parent->children.size()); ++i) {
+        parent->children[i]->row = i;
+    }
+}
+
+QString CatalogTreeModel::tableKey(const CatalogTable& table)
+{
+    return table.oid != 0 ? QString::number(table.oid) + QChar(0x1f) : table.name;
+}
+
+bool CatalogTreeModel::sameTable(const CatalogTable& a, const CatalogTable& b)
+{
+    return a.name == b.name && a.oid == b.oid && a.hasPrimaryKey == b.hasPrimaryKey && a.kind == b.kind
+        && a.estimatedRows == b.estimatedRows && a.estimatedBytes == b.estimatedBytes;
+}
+
+std::unique_ptr<CatalogTreeModel::Node> CatalogTreeModel::schemaNodeFor(const QString& schema, bool hidden) const
+{
+    auto node = std::make_unique<Node>();
+    node->type = NodeType::Schema;
+    node->name = schema;
+    node->key = schema;
+    node->hidden = hidden;
+    return node;
+}
+
+std::unique_ptr<CatalogTreeModel::Node> CatalogTreeModel::tableNodeFor(const CatalogTable& table) const
+{
+    auto node = std::make_unique<Node>();
+    node->type = NodeType::Table;
+    node->name = table.name;
+    node->key = tableKey(table);
+    node->table = table;
+    return node;
+}
+
+void CatalogTreeModel::appendTables(Node* schema, const std::vector<CatalogTable>& tables)
+{
+    if (tables.empty()) {
+        return;
+    }
+    const int first = static_cast<int>(schema->children.size());
+    beginInsertRows(indexFor(schema), first, first + static_cast<int>(tables.size()) - 1);
+    schema->children.reserve(schema->children.size() + tables.size());
+    for (const auto& table : tables) {
+        auto node = tableNodeFor(table);
+        node->parent = schema;
+        node->row = static_cast<int>(schema->children.size());
+        node->hidden = schema->hidden;
+        schema->children.push_back(std::move(node));
+    }
+    endInsertRows();
+}
+
+void CatalogTreeModel::syncChildren(Node* parent, std::vector<std::unique_ptr<Node>> wanted)
+{
+    const QModelIndex parentIndex = indexFor(parent);
+    auto& children = parent->children;
+
+    std::function<void(Node*)> forget = [this, &forget](Node* node) {
+        if (node->type == NodeType::Schema && m_schemas.value(node->name) == node) {
+            m_schemas.remove(node->name);
+        }
+        for (const auto& child : node->children) {
+            forget(child.get());
+        }
+    };
+    auto remember = [this](Node* node) {
+        if (node->type == NodeType::Schema) {
+            m_schemas.insert(node->name, node);
+        }
+    };
+
+    // 1. Rows no longer listed go, one notification per contiguous run.
+    QSet<QString> wantedKeys;
+    wantedKeys.reserve(static_cast<int>(wanted.size()));
+    for (const auto& node : wanted) {
+        wantedKeys.insert(node->key);
+    }
+    for (int last = static_cast<int>(children.size()) - 1; last >= 0; --last) {
+        if (wantedKeys.contains(children[last]->key)) {
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !wantedKeys.contains(children[first - 1]->key)) {
+            --first;
+        }
+        beginRemoveRows(parentIndex, first, last);
+        for (int i = first; i <= last; ++i) {
+            forget(children[i].get());
+        }
+        children.erase(children.begin() + first, children.begin() + last + 1);
+        endRemoveRows();
+        last = first;
+    }
+    renumber(parent, 0);
+
+    // 2. Walk the wanted order: keep matching rows, move rows that changed
+    // place (a rename), insert runs of new ones.
+    QHash<QString, Node*> existing;
+    existing.reserve(static_cast<int>(children.size()));
+    for (const auto& child : children) {
+        existing.insert(child->key, child.get());
+    }
+    for (int i = 0; i < static_cast<int>(wanted.size()); ++i) {
+        Node* current = existing.value(wanted[i]->key, nullptr);
+        if (!current) {
+            int end = i;
+            while (end < static_cast<int>(wanted.size()) && !existing.contains(wanted[end]->key)) {
+                ++end;
+            }
+            beginInsertRows(parentIndex, i, end - 1);
+            for (int k = i; k < end; ++k) {
+                wanted[k]->parent = parent;
+                remember(wanted[k].get());
+            }
+            children.insert(children.begin() + i,
+                            std::make_move_iterator(wanted.begin() + i),
+                            std::make_move_iterator(wanted.begin() + end));
+            renumber(parent, i);
+            endInsertRows();
+            i = end - 1;
+            continue;
+        }
+        if (current->row != i) {
+            const int from = current->row;
+            beginMoveRows(parentIndex, from, from, parentIndex, i);
+            std::unique_ptr<Node> moved = std::move(children[from]);
+            children.erase(children.begin() + from);
+            children.insert(children.begin() + i, std::move(moved));
+            renumber(parent, i);
+            endMoveRows();
+        }
+        const Node* next = wanted[i].get();
+        bool changed = false;
+        if (current->type == NodeType::Table && !sameTable(current->table, next->table)) {
+            current->table = next->table;
+            current->name = next->name;
+            changed = true;
+        }
+        if (current->hidden != next->hidden) {
+            current->hidden = next->hidden;
+            changed = true;
+        }
+        if (changed) {
+            const QModelIndex index = indexFor(current);
+            emit dataChanged(index, index);
+        }
+    }
+}
+
+void CatalogTreeModel::handleSchemasFinished(const QString& requestTag, const QVariantMap& result)
+{
+    if (requestTag != kSchemasTag || !m_active) {
+        return;
+    }
+    const bool initial = m_root->children.empty();
+    const QStringList visible = result.value("schemas").toStringList();
+    const QStringList hidden = result.value("hiddenSchemas").toStringList();
+
+    std::vector<std::unique_ptr<Node>> schemas;
+    schemas.reserve(static_cast<size_t>(visible.size()) + 1);
+    for (const auto& schema : visible) {
+        schemas.push_back(schemaNodeFor(schema, false));
+    }
+    if (!hidden.isEmpty()) {
+        auto group = std::make_unique<Node>();
+        group->type = NodeType::Group;
+        group->name = kHiddenGroupName;
+        group->key = QString(QChar(0x1f)) + QStringLiteral("hidden");
+        group->hidden = true;
+        schemas.push_back(std::move(group));
+    }
+    syncChildren(m_root.get(), std::move(schemas));
+
+    for (const auto& child : m_root->children) {
+        if (child->type != NodeType::Group) {
+            continue;
+        }
+        std::vector<std::unique_ptr<Node>> hiddenSchemas;
+        hiddenSchemas.reserve(static_cast<size_t>(hidden.size()));
+        for (const auto& schema : hidden) {
+            hiddenSchemas.push_back(schemaNodeFor(schema, true));
+        }
+        syncChildren(child.get(), std::move(hiddenSchemas));
+    }
+
+    if (m_reloadLoaded) {
+        m_reloadLoaded = false;
+        for (Node* schema : std::as_const(m_schemas)) {
+            if (schema->fetched || schema->loading) {
+                requestTables(schema);
+            }
+        }
+    }
+    emit schemasLoaded(initial);
+}
+
+void CatalogTreeModel::handleSchemasError(const QString& requestTag, const QString& error)
+{
+    if (requestTag != kSchemasTag) {
+        return;
+    }
+    m_reloadLoaded = false;
+    qWarning() << "\x1b[33m⚠️ Explorer\x1b[0m falha ao listar schemas:" << error;
+}
+
+void CatalogTreeModel::handleTablesBatch(const QString& requestTag, const QVariantMap& batch)
+{
+    if (!requestTag.startsWith(kTablesTagPrefix)) {
+        return;
+    }
+    Node* schema = schemaNode(batch.value("schema").toString());
+    if (!schema || !schema->loading || requestTag != tablesRequestTag(schema->name)) {
+        return;
+    }
+    const QVariantList rows = batch.value("tables").toList();
+    std::vector<CatalogTable> tables;
+    tables.reserve(static_cast<size_t>(rows.size()));
+    for (const auto& row : rows) {
+        tables.push_back(catalogTableFromVariant(row.toMap()));
+    }
+    const bool reset = batch.value("reset").toBool();
+
+    if (schema->fetched) {
+        // Reload: diffed against the shown rows once complete.
+        if (reset) {
+            schema->incoming.clear();
+        }
+        schema->incoming.insert(schema->incoming.end(), tables.begin(), tables.end());
+        return;
+    }
+    // First load: rows show up as they arrive.
+    if (reset && !schema->children.empty()) {
+        beginRemoveRows(indexFor(schema), 0, static_cast<int>(schema->children.size()) - 1);
+        schema->children.clear();
+        endRemoveRows();
+    }
+    appendTables(schema, tables);
+}
+
+void CatalogTreeModel::handleTablesFinished(const QString& requestTag, const QVariantMap& result)
+{
+    if (!requestTag.startsWith(kTablesTagPrefix)) {
+        return;
+    }
+    Node* schema = schemaNode(result.value("schema").toString());
+    if (!schema || !schema->loading || requestTag != tablesRequestTag(schema->name)) {
+        return;
+    }
+    if (schema->fetched) {
+        std::vector<std::unique_ptr<Node>> tables;
+        tables.reserve(schema->incoming.size());
+        for (const auto& table : schema->incoming) {
+            auto node = tableNodeFor(table);
+            node->hidden = schema->hidden;
+            tables.push_back(std::move(node));
+        }
+        schema->incoming.clear();
+        syncChildren(schema, std::move(tables));
+    }
+    schema->fetched = true;
+    setLoading(schema, false);
+}
+
+void CatalogTreeModel::handleTablesError(const QString& requestTag, const QString& error)
+{
+    if (!requestTag.startsWith(kTablesTagPrefix)) {
+        return;
+    }
+    Node* schema = schemaNode(requestTag.mid(kTablesTagPrefix.size()));
+    if (!schema || !schema->loading) {
+        return;
+    }
+    // Left unfetched (or as it was) so expanding again retries.
+    schema->incoming.clear();
+    setLoading(schema, false);
+    qWarning() << "\x1b[33m⚠️ Explorer\x1b[0m falha ao listar tabelas de" << schema->name << ":" << error;
+}
+
+}
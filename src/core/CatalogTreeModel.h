@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <memory>
+#include <vector>
+#include "udm/UDM.h"
+
+namespace Sofa::Core {
+
+// The explorer tree: schemas, a "Hidden Schemas" group holding the hidden
+// ones, and each schema's tables. Tables are loaded on demand (fetchMore when
+// a schema is first expanded) through the async catalog requests, appended as
+// their batches arrive. Reloads diff the new list against the rows already
+// shown, keyed by table OID (name when the driver reports none), and emit
+// row inserts/moves/removals instead of resetting, so views keep their
+// expansion and scroll position.
+//
+// The model issues requests through schemasRequested/tablesRequested and is
+// fed the replies by its owner (AppContext); replies for tags it didn't
+// request are ignored.
+class CatalogTreeModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        NodeTypeRole, // "schema", "group" or "table"
+        SchemaRole,
+        OidRole,
+        HasPrimaryKeyRole,
+        KindRole,
+        EstimatedRowsRole,
+        HiddenRole,
+        LoadingRole
+    };
+
+    explicit CatalogTreeModel(QObject* parent = nullptr);
+    ~CatalogTreeModel() override;
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    // Index of a schema row (visible or hidden), invalid if not listed.
+    Q_INVOKABLE QModelIndex schemaIndex(const QString& schema) const;
+    // Re-reads the schema list and every schema already loaded, or only the
+    // given schema.
+    Q_INVOKABLE void reload(const QString& schema = QString());
+    // Drops everything (connection closed); replies still in flight are ignored.
+    void clear();
+
+    static QString schemasRequestTag();
+    static QString tablesRequestTag(const QString& schema);
+
+public slots:
+    void handleSchemasFinished(const QString& requestTag, const QVariantMap& result);
+    void handleSchemasError(const QString& requestTag, const QString& error);
+    void handleTablesBatch(const QString& requestTag, const QVariantMap& batch);
+    void handleTablesFinished(const QString& requestTag, const QVariantMap& result);
+    void handleTablesError(const QString& requestTag, const QString& error);
+
+signals:
+    void schemasRequested(const QString& requestTag);
+    void tablesRequested(const QString& schema, const QString& requestTag);
+    // After a schema list was applied; initial when the tree was empty before.
+    void schemasLoaded(bool initial);
+
+private:
+    enum class NodeType { Root, Schema, Group, Table };
+
+    struct Node {
+        NodeType type = NodeType::Root;
+        QString name;
+        QString key;
+        Node* parent = nullptr;
+        int row = 0;
+        std::vector<std::unique_ptr<Node>> children;
+        bool hidden = false;
+        // Tables
+        CatalogTable table;
+        // Schemas
+        bool fetched = false;
+        bool loading = false;
+        std::vector<CatalogTable> incoming; // rows of a reload, applied when it finishes
+    };
+
+    Node* nodeFor(const QModelIndex& index) const;
+    QModelIndex indexFor(const Node* node) const;
+    Node* schemaNode(const QString& schema) const;
+    void requestTables(Node* schema);
+    void setLoading(Node* schema, bool loading);
+    void appendTables(Node* schema, const std::vector<CatalogTable>& tables);
+    // Brings parent's children in line with wanted (same keys, same order).
+    void syncChildren(Node* parent, std::vector<std::unique_ptr<Node>> wanted);
+    std::unique_ptr<Node> schemaNodeFor(const QString& schema, bool hidden) const;
+    std::unique_ptr<Node> tableNodeFor(const CatalogTable& table) const;
+    static QString tableKey(const CatalogTable& table);
+    static bool sameTable(const CatalogTable& a, const CatalogTable& b);
+    static void renumber(Node* parent, int from);
+
+    std::unique_ptr<Node> m_root;
+    QHash<QString, Node*> m_schemas;
+    bool m_active = false;
+    bool m_reloadLoaded = false; // re-read loaded schemas once the schema list arrives
+};
+
+}
@@ -0,0 +1,202 @@
+#include "ConnectionPool.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QStringList>
+
+namespace Sofa::Core {
+
+// --- Lease ---
+
+ConnectionPool::Lease::Lease(ConnectionPool* pool, QString key, std::shared_ptr<IConnectionProvider> connection)
+    : m_pool(pool)
+    , m_key(std::move(key))
+    , m_connection(std::move(connection))
+{
+}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : m_pool(other.m_pool)
+    , m_key(std::move(other.m_key))
+    , m_connection(std::move(other.m_connection))
+    , m_suspect(other.m_suspect)
+{
+    other.m_pool = nullptr;
+    other.m_suspect = false;
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_pool = other.m_pool;
+        m_key = std::move(other.m_key);
+        m_connection = std::move(other.m_connection);
+        m_suspect = other.m_suspect;
+        other.m_pool = nullptr;
+        other.m_suspect = false;
+    }
+    return *this;
+}
+
+ConnectionPool::Lease::~Lease()
+{
+    release();
+}
+
+void ConnectionPool::Lease::release()
+{
+    if (m_pool && m_connection) {
+        m_pool->release(m_key, std::move(m_connection), m_suspect);
+    }
+    m_pool = nullptr;
+    m_connection.reset();
+    m_suspect = false;
+}
+
+// --- ConnectionPool ---
+
+ConnectionPool::ConnectionPool(std::shared_ptr<AddonHost> addonHost)
+    : m_addonHost(std::move(addonHost))
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    clear();
+}
+
+QString ConnectionPool::keyFor(const QVariantMap& connectionInfo)
+{
+    const QByteArray passwordHash = QCryptographicHash::hash(
+        connectionInfo.value("password").toString().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStringList {
+        connectionInfo.value("driverId").toString(),
+        connectionInfo.value("host").toString(),
+        QString::number(connectionInfo.value("port", 5432).toInt()),
+        connectionInfo.value("database").toString(),
+        connectionInfo.value("user").toString(),
+        QString::fromLatin1(passwordHash)
+    }.join(QChar(0x1f));
+}
+
+std::shared_ptr<IConnectionProvider> ConnectionPool::openConnection(const QVariantMap& connectionInfo, QString* error)
+{
+    if (!m_addonHost) {
+        if (error) *error = "AddonHost indisponível.";
+        return nullptr;
+    }
+    QString driverId = connectionInfo.value("driverId").toString();
+    if (!m_addonHost->hasAddon(driverId)) {
+        if (error) *error = "Driver indisponível: " + driverId;
+        return nullptr;
+    }
+    auto addon = m_addonHost->getAddon(driverId);
+    auto connection = addon->createConnection();
+
+    QString host = connectionInfo.value("host").toString();
+    int port = connectionInfo.value("port", 5432).toInt();
+    QString database = connectionInfo.value("database").toString();
+    QString user = connectionInfo.value("user").toString();
+    QString password = connectionInfo.value("password").toString();
+
+    if (!connection->open(host, port, database, user, password)) {
+        if (error) *error = connection->lastError();
+        return nullptr;
+    }
+    return connection;
+}
+
+ConnectionPool::Lease ConnectionPool::acquire(const QVariantMap& connectionInfo, QString* error)
+{
+    evictIdle();
+
+    const QString key = keyFor(connectionInfo);
+    auto it = m_idle.find(key);
+    if (it != m_idle.end()) {
+        auto& entries = it->second;
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        // Most recently released first: the warmest backend is the least likely to have been dropped.
+        while (!entries.empty()) {
+            IdleEntry entry = std::move(entries.back());
+            entries.pop_back();
+            const bool stale = entry.suspect || (now - entry.releasedAtMs) > m_healthCheckAfterMs;
+            if (!entry.connection->isOpen() || (stale && !entry.connection->ping())) {
+                entry.connection->close();
+                continue;
+            }
+            m_leased[key] += 1;
+            return Lease(this, key, std::move(entry.connection));
+        }
+    }
+
+    auto connection = openConnection(connectionInfo, error);
+    if (!connection) {
+        return Lease();
+    }
+    m_leased[key] += 1;
+    return Lease(this, key, std::move(connection));
+}
+
+void ConnectionPool::release(const QString& key, std::shared_ptr<IConnectionProvider> connection, bool suspect)
+{
+    int& leased = m_leased[key];
+    if (leased > 0) {
+        leased -= 1;
+    }
+
+    auto& entries = m_idle[key];
+    const int total = static_cast<int>(entries.size()) + leased;
+    // A transaction left open (or aborted) must not carry over to the next lease.
+    if (!connection->isOpen() || total >= m_maxSize || !connection->resetForReuse()) {
+        connection->close();
+        return;
+    }
+
+    IdleEntry entry;
+    entry.connection = std::move(connection);
+    entry.releasedAtMs = QDateTime::currentMSecsSinceEpoch();
+    entry.suspect = suspect;
+    entries.push_back(std::move(entry));
+}
+
+void ConnectionPool::evictIdle()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = m_idle.begin(); it != m_idle.end();) {
+        auto& entries = it->second;
+        for (auto entryIt = entries.begin(); entryIt != entries.end();) {
+            if ((now - entryIt->releasedAtMs) > m_idleTimeoutMs) {
+                entryIt->connection->close();
+                entryIt = entries.erase(entryIt);
+            } else {
+                ++entryIt;
+            }
+        }
+        if (entries.empty()) {
+            it = m_idle.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ConnectionPool::clear()
+{
+    for (auto& [key, entries] : m_idle) {
+        for (auto& entry : entries) {
+            entry.connection->close();
+        }
+    }
+    m_idle.clear();
+}
+
+int ConnectionPool::idleCount() const
+{
+    int total = 0;
+    for (const auto& [key, entries] : m_idle) {
+        total += static_cast<int>(entries.size());
+    }
+    return total;
+}
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QString>
+#include <QVariantMap>
+#include <map>
+#include <memory>
+#include <vector>
+#include "AddonHost.h"
+#include "addons/IAddon.h"
+
+namespace Sofa::Core {
+
+// Keeps warm connections keyed by connection info so repeated requests reuse
+// an already authenticated backend. Not thread-safe: QtSql handles are bound
+// to the thread that opened them, so the pool must only be used from the
+// thread that owns it (one pool per QueryWorker).
+class ConnectionPool {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(ConnectionPool* pool, QString key, std::shared_ptr<IConnectionProvider> connection);
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        IConnectionProvider* operator->() const { return m_connection.get(); }
+        const std::shared_ptr<IConnectionProvider>& connection() const { return m_connection; }
+        explicit operator bool() const { return m_connection != nullptr; }
+
+        // Forces a health check before the connection is handed out again.
+        void markSuspect() { m_suspect = true; }
+        void release();
+
+    private:
+        ConnectionPool* m_pool = nullptr;
+        QString m_key;
+        std::shared_ptr<IConnectionProvider> m_connection;
+        bool m_suspect = false;
+    };
+
+    explicit ConnectionPool(std::shared_ptr<AddonHost> addonHost);
+    ~ConnectionPool();
+
+    Lease acquire(const QVariantMap& connectionInfo, QString* error = nullptr);
+    void evictIdle();
+    void clear();
+
+    void setMaxSize(int maxSize) { m_maxSize = maxSize; }
+    void setIdleTimeoutMs(qint64 timeoutMs) { m_idleTimeoutMs = timeoutMs; }
+    int idleCount() const;
+
+    static QString keyFor(const QVariantMap& connectionInfo);
+
+private:
+    struct IdleEntry {
+        std::shared_ptr<IConnectionProvider> connection;
+        qint64 releasedAtMs = 0;
+        bool suspect = false;
+    };
+
+    void release(const QString& key, std::shared_ptr<IConnectionProvider> connection, bool suspect);
+    std::shared_ptr<IConnectionProvider> openConnection(const QVariantMap& connectionInfo, QString* error);
+
+    std::shared_ptr<AddonHost> m_addonHost;
+    std::map<QString, std::vector<IdleEntry>> m_idle;
+    std::map<QString, int> m_leased;
+    int m_maxSize = 4;
+    qint64 m_idleTimeoutMs = 5 * 60 * 1000;
+    qint64 m_healthCheckAfterMs = 30 * 1000;
+};
+
+}
@@ -0,0 +1,201 @@
+#include "DataExport.h"
+#include <cstdio>
+
+namespace Sofa::Core {
+
+ExportOptions ExportOptions::fromVariant(const QVariantMap& options)
+{
+    ExportOptions result;
+    result.format = options.value("format", "csv").toString().toLower();
+    if (result.format != "jsonl" && result.format != "sql") {
+        result.format = "csv";
+    }
+    result.insertBatchRows = qMax(1, options.value("insertBatchRows", 500).toInt());
+    result.insertTable = options.value("insertTable").toString().trimmed();
+    result.parallel = qBound(1, options.value("parallel", 1).toInt(), 16);
+    result.shards = options.value("shards", false).toBool();
+    return result;
+}
+
+namespace {
+enum class ValueKind { Text, Number, Boolean, Json };
+
+std::vector<ValueKind> valueKinds(const std::vector<Column>& columns)
+{
+    std::vector<ValueKind> kinds;
+    kinds.reserve(columns.size());
+    for (const auto& column : columns) {
+        if (column.type == DataType::Integer || column.type == DataType::Real) {
+            kinds.push_back(ValueKind::Number);
+        } else if (column.type == DataType::Boolean) {
+            kinds.push_back(ValueKind::Boolean);
+        } else if (column.rawType == "json" || column.rawType == "jsonb") {
+            kinds.push_back(ValueKind::Json);
+        } else {
+            kinds.push_back(ValueKind::Text);
+        }
+    }
+    return kinds;
+}
+
+// NaN and ±Infinity are valid float/numeric values but neither JSON nor SQL numbers.
+bool isFiniteNumber(const QString& text)
+{
+    return !text.isEmpty() && (text.at(0).isDigit() || text.at(0) == '-' || text.at(0) == '.')
+        && !text.endsWith("Infinity");
+}
+
+void appendJsonString(QByteArray& out, const QString& text)
+{
+    const QByteArray utf8 = text.toUtf8();
+    out.append('"');
+    for (const char c : utf8) {
+        switch (c) {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                out.append(escaped);
+            } else {
+                out.append(c);
+            }
+        }
+    }
+    out.append('"');
+}
+
+void appendSqlString(QByteArray& out, const QString& text)
+{
+    out.append('\'');
+    out.append(QString(text).replace('\'', "''").toUtf8());
+    out.append('\'');
+}
+
+QString quoteSqlIdentifier(const QString& identifier)
+{
+    return QString("\"%1\"").arg(QString(identifier).replace("\"", "\"\""));
+}
+
+class JsonLinesFormatter : public ExportFormatter {
+public:
+    explicit JsonLinesFormatter(const std::vector<Column>& columns)
+        : m_kinds(valueKinds(columns))
+    {
+        // Keys are escaped once, not per row.
+        for (const auto& column : columns) {
+            QByteArray key;
+            appendJsonString(key, column.name);
+            key.append(':');
+            m_keys.push_back(key);
+        }
+    }
+
+    void writeRow(const ImportRecord& record, QByteArray& out) override
+    {
+        out.append('{');
+        for (size_t c = 0; c < m_keys.size(); ++c) {
+            if (c > 0) out.append(',');
+            out.append(m_keys[c]);
+            const QVariant value = c < record.size() ? record[c] : QVariant();
+            if (value.isNull()) {
+                out.append("null");
+                continue;
+            }
+            const QString text = value.toString();
+            switch (m_kinds[c]) {
+            case ValueKind::Number:
+                if (isFiniteNumber(text)) out.append(text.toUtf8());
+                else appendJsonString(out, text);
+                break;
+            case ValueKind::Boolean:
+                out.append(text == "t" ? "true" : "false");
+                break;
+            case ValueKind::Json:
+                out.append(text.toUtf8());
+                break;
+            case ValueKind::Text:
+                appendJsonString(out, text);
+                break;
+            }
+        }
+        out.append("}\n");
+    }
+
+private:
+    std::vector<ValueKind> m_kinds;
+    std::vector<QByteArray> m_keys;
+};
+
+class SqlInsertFormatter : public ExportFormatter {
+public:
+    SqlInsertFormatter(const std::vector<Column>& columns, const QString& table, int batchRows)
+        : m_kinds(valueKinds(columns))
+        , m_batchRows(batchRows)
+    {
+        QStringList names;
+        for (const auto& column : columns) {
+            names << quoteSqlIdentifier(column.name);
+        }
+        m_prefix = QString("INSERT INTO %1 (%2) VALUES\n").arg(table, names.join(", ")).toUtf8();
+    }
+
+    void writeRow(const ImportRecord& record, QByteArray& out) override
+    {
+        out.append(m_pendingRows == 0 ? m_prefix : QByteArray(",\n"));
+        out.append('(');
+        for (size_t c = 0; c < m_kinds.size(); ++c) {
+            if (c > 0) out.append(", ");
+            const QVariant value = c < record.size() ? record[c] : QVariant();
+            if (value.isNull()) {
+                out.append("NULL");
+                continue;
+            }
+            const QString text = value.toString();
+            if (m_kinds[c] == ValueKind::Number && isFiniteNumber(text)) {
+                out.append(text.toUtf8());
+            } else if (m_kinds[c] == ValueKind::Boolean) {
+                out.append(text == "t" ? "TRUE" : "FALSE");
+            } else {
+                appendSqlString(out, text);
+            }
+        }
+        out.append(')');
+        if (++m_pendingRows >= m_batchRows) {
+            finish(out);
+        }
+    }
+
+    void finish(QByteArray& out) override
+    {
+        if (m_pendingRows > 0) {
+            out.append(";\n");
+            m_pendingRows = 0;
+        }
+    }
+
+private:
+    std::vector<ValueKind> m_kinds;
+    QByteArray m_prefix;
+    int m_batchRows = 500;
+    int m_pendingRows = 0;
+};
+}
+
+std::unique_ptr<ExportFormatter> ExportFormatter::create(const ExportOptions& options, const std::vector<Column>& columns, const QString& defaultTable)
+{
+    if (options.format == "jsonl") {
+        return std::make_unique<JsonLinesFormatter>(columns);
+    }
+    if (options.format == "sql") {
+        const QString table = options.insertTable.isEmpty() ? defaultTable : options.insertTable;
+        return std::make_unique<SqlInsertFormatter>(columns, table, options.insertBatchRows);
+    }
+    return nullptr;
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <memory>
+#include <vector>
+#include "DataImport.h"
+#include "udm/UDM.h"
+
+namespace Sofa::Core {
+
+struct ExportOptions {
+    QString format = "csv"; // "csv", "jsonl" or "sql"
+    // sql: rows per INSERT statement and the target table (already quoted or
+    // plain; defaults to the source table).
+    int insertBatchRows = 500;
+    QString insertTable;
+    // Connections reading ranges of a table at once (1 = a single COPY), and
+    // whether each range goes to its own file (name.partNNN.ext) instead of one.
+    int parallel = 1;
+    bool shards = false;
+
+    static ExportOptions fromVariant(const QVariantMap& options);
+};
+
+// Turns rows of COPY text data (parsed with DelimitedTextParser in TSV mode,
+// so every value is a QString or NULL) into one output format. Column types
+// decide what is written unquoted: numbers, booleans and, for JSON, json values.
+class ExportFormatter {
+public:
+    virtual ~ExportFormatter() = default;
+    virtual void writeRow(const ImportRecord& record, QByteArray& out) = 0;
+    // Closes whatever the last rows left open (e.g. a pending INSERT).
+    virtual void finish(QByteArray& out) { (void)out; }
+
+    // nullptr for "csv", which the driver writes directly.
+    static std::unique_ptr<ExportFormatter> create(const ExportOptions& options, const std::vector<Column>& columns, const QString& defaultTable);
+};
+
+}
@@ -0,0 +1,187 @@
+#include "DataImport.h"
+#include <QHash>
+#include <QSet>
+
+namespace Sofa::Core {
+
+ImportOptions ImportOptions::fromVariant(const QVariantMap& options)
+{
+    ImportOptions result;
+    result.format = options.value("format", "csv").toString().toLower();
+    if (result.format != "tsv") {
+        result.format = "csv";
+    }
+    result.delimiter = result.format == "tsv" ? '\t' : ',';
+    const QString delimiter = options.value("delimiter").toString();
+    if (delimiter.size() == 1 && delimiter.at(0).unicode() < 0x80) {
+        result.delimiter = delimiter.at(0).toLatin1();
+    }
+    result.hasHeader = options.value("hasHeader", true).toBool();
+    result.columnMapping = options.value("columnMapping").toMap();
+    return result;
+}
+
+// --- DelimitedTextParser ---
+
+DelimitedTextParser::DelimitedTextParser(const ImportOptions& options)
+    : m_csv(options.format != "tsv")
+    , m_delimiter(options.delimiter)
+{
+}
+
+void DelimitedTextParser::endField()
+{
+    const bool isNull = m_csv ? (!m_fieldQuoted && m_field.isEmpty()) : m_fieldNull;
+    if (isNull) {
+        m_record.emplace_back();
+    } else {
+        m_record.emplace_back(QString::fromUtf8(m_field));
+    }
+    m_field.clear();
+    m_fieldQuoted = false;
+    m_fieldNull = false;
+    m_state = State::FieldStart;
+}
+
+void DelimitedTextParser::endRecord(std::vector<ImportRecord>& records)
+{
+    endField();
+    // Blank lines carry no data.
+    const bool blank = m_record.size() == 1 && m_record.front().isNull();
+    if (!blank) {
+        records.push_back(std::move(m_record));
+    }
+    m_record = ImportRecord();
+    m_record.reserve(records.empty() ? 8 : records.back().size());
+}
+
+void DelimitedTextParser::feed(const QByteArray& chunk, std::vector<ImportRecord>& records)
+{
+    const char* data = chunk.constData();
+    qsizetype size = chunk.size();
+    if (m_atFileStart && size > 0) {
+        m_atFileStart = false;
+        if (chunk.startsWith("\xEF\xBB\xBF")) {
+            data += 3;
+            size -= 3;
+        }
+    }
+
+    for (qsizetype i = 0; i < size; ++i) {
+        const char c = data[i];
+        switch (m_state) {
+        case State::FieldStart:
+        case State::Unquoted:
+            if (c == m_delimiter) {
+                endField();
+            } else if (c == '\n') {
+                endRecord(records);
+            } else if (c == '\r') {
+                // CRLF line ends.
+            } else if (m_csv && c == '"' && m_state == State::FieldStart) {
+                m_fieldQuoted = true;
+                m_state = State::Quoted;
+            } else if (!m_csv && c == '\\') {
+                m_state = State::Escape;
+            } else {
+                m_field.append(c);
+                m_state = State::Unquoted;
+            }
+            break;
+        case State::Quoted:
+            if (c == '"') {
+                m_state = State::QuoteInQuoted;
+            } else {
+                m_field.append(c);
+            }
+            break;
+        case State::QuoteInQuoted:
+            if (c == '"') {
+                m_field.append('"');
+                m_state = State::Quoted;
+            } else if (c == m_delimiter) {
+                endField();
+            } else if (c == '\n') {
+                endRecord(records);
+            } else if (c == '\r') {
+                // CRLF line ends.
+            } else {
+                // Text after a closing quote: kept, as most spreadsheets do.
+                m_field.append(c);
+                m_state = State::Unquoted;
+            }
+            break;
+        case State::Escape:
+            switch (c) {
+            case 'N': m_fieldNull = true; break;
+            case 't': m_field.append('\t'); break;
+            case 'n': m_field.append('\n'); break;
+            case 'r': m_field.append('\r'); break;
+            case 'b': m_field.append('\b'); break;
+            case 'f': m_field.append('\f'); break;
+            case 'v': m_field.append('\v'); break;
+            default: m_field.append(c); break;
+            }
+            m_state = State::Unquoted;
+            break;
+        }
+    }
+}
+
+void DelimitedTextParser::finish(std::vector<ImportRecord>& records)
+{
+    if (m_state != State::FieldStart || !m_field.isEmpty() || !m_record.empty()) {
+        endRecord(records);
+    }
+}
+
+// --- ImportColumnMap ---
+
+ImportColumnMap ImportColumnMap::build(const TableSchema& schema, const ImportRecord& firstRecord, const ImportOptions& options, QString* error)
+{
+    ImportColumnMap map;
+    QHash<QString, QString> tableColumnByName;
+    for (const auto& column : schema.columns) {
+        tableColumnByName.insert(column.name.toLower(), column.name);
+    }
+
+    QSet<QString> used;
+    for (int i = 0; i < static_cast<int>(firstRecord.size()); ++i) {
+        const QString sourceName = options.hasHeader ? firstRecord[i].toString().trimmed() : QString::number(i + 1);
+        QString target;
+        if (options.columnMapping.contains(sourceName)) {
+            target = options.columnMapping.value(sourceName).toString();
+        } else if (options.hasHeader) {
+            target = sourceName;
+        } else if (i < static_cast<int>(schema.columns.size())) {
+            target = schema.columns[i].name;
+        }
+
+        const QString column = tableColumnByName.value(target.toLower());
+        if (column.isEmpty() || used.contains(column)) {
+            map.skippedColumns << sourceName;
+            continue;
+        }
+        used.insert(column);
+        map.tableColumns << column;
+        map.sourceIndexes.push_back(i);
+    }
+
+    if (map.tableColumns.isEmpty() && error) {
+        *error = QString("No column of the file matches a column of %1.%2").arg(schema.schema, schema.name);
+    }
+    return map;
+}
+
+ImportRecord ImportColumnMap::project(const ImportRecord& record) const
+{
+    ImportRecord row;
+    row.reserve(sourceIndexes.size());
+    for (int index : sourceIndexes) {
+        // Short records fill the missing columns with NULL.
+        row.push_back(index < static_cast<int>(record.size()) ? record[index] : QVariant());
+    }
+    return row;
+}
+
+}
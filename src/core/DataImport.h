@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantMap>
+#include <vector>
+#include "udm/UDM.h"
+
+namespace Sofa::Core {
+
+using ImportRecord = std::vector<QVariant>;
+
+struct ImportOptions {
+    QString format = "csv"; // "csv" or "tsv"
+    char delimiter = ',';
+    bool hasHeader = true;
+    // File column (header name, or 1-based position without a header) -> table column.
+    QVariantMap columnMapping;
+
+    static ImportOptions fromVariant(const QVariantMap& options);
+};
+
+// Incremental CSV/TSV reader: feed() takes the file in arbitrary chunks (a
+// record may span several) and returns the records completed so far.
+// CSV follows RFC 4180; an unquoted empty field is NULL, "" is an empty string.
+// TSV follows Postgres' text format: \N is NULL, \t \n \r \\ are escapes.
+class DelimitedTextParser {
+public:
+    explicit DelimitedTextParser(const ImportOptions& options);
+
+    void feed(const QByteArray& chunk, std::vector<ImportRecord>& records);
+    // Flushes a last record that has no trailing newline.
+    void finish(std::vector<ImportRecord>& records);
+
+private:
+    enum class State { FieldStart, Unquoted, Quoted, QuoteInQuoted, Escape };
+
+    void endField();
+    void endRecord(std::vector<ImportRecord>& records);
+
+    bool m_csv = true;
+    char m_delimiter = ',';
+    bool m_atFileStart = true;
+    State m_state = State::FieldStart;
+    QByteArray m_field;
+    bool m_fieldQuoted = false;
+    bool m_fieldNull = false;
+    ImportRecord m_record;
+};
+
+// Which file column feeds each table column. Built from the header names
+// (case-insensitive, or columnMapping) or, without a header, by position.
+struct ImportColumnMap {
+    QStringList tableColumns;       // target columns, in COPY order
+    std::vector<int> sourceIndexes; // file column for each target column
+    QStringList skippedColumns;     // file columns the table doesn't have
+
+    static ImportColumnMap build(const TableSchema& schema, const ImportRecord& firstRecord, const ImportOptions& options, QString* error);
+    ImportRecord project(const ImportRecord& record) const;
+};
+
+}
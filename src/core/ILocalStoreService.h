@@ -1,4 +1,5 @@
 #pragma once
+#include <QByteArray>
 #include <QString>
 #include <QDateTime>
 #include <QVariant>
@@ -41,6 +42,12 @@ public:
     // Settings / Key-Value Store
     virtual void saveSetting(const QString& key, const QVariant& value) = 0;
     virtual QVariant getSetting(const QString& key, const QVariant& defaultValue = QVariant()) = 0;
+
+    // Catalog snapshot of a saved connection (CatalogCache::snapshot), shown
+    // on the next open while it is revalidated. Dropped with the connection
+    // or when its details change.
+    virtual void saveCatalogSnapshot(int connectionId, const QByteArray& snapshot) = 0;
+    virtual QByteArray getCatalogSnapshot(int connectionId) = 0;
 };
 
 }
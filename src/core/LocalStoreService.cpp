@@ -106,6 +106,18 @@ void LocalStoreService::init()
     if (!query.exec(createSettingsTable)) {
         m_logger->error("Failed to create settings table: " + query.lastError().text());
     }
+
+    QString createCatalogSnapshotsTable = R"(
+        CREATE TABLE IF NOT EXISTS catalog_snapshots (
+            connection_id INTEGER PRIMARY KEY,
+            snapshot BLOB,
+            updated_at DATETIME
+        )
+    )";
+
+    if (!query.exec(createCatalogSnapshotsTable)) {
+        m_logger->error("Failed to create catalog_snapshots table: " + query.lastError().text());
+    }
 }
 
 void LocalStoreService::saveSetting(const QString& key, const QVariant& value)
@@ -145,6 +157,53 @@ QVariant LocalStoreService::getSetting(const QString& key, const QVariant& defau
     return defaultValue;
 }
 
+void LocalStoreService::saveCatalogSnapshot(int connectionId, const QByteArray& snapshot)
+{
+    auto db = getDatabase();
+    if (!db.isOpen() && !db.open()) return;
+
+    if (snapshot.isEmpty()) {
+        deleteCatalogSnapshot(db, connectionId);
+        return;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("INSERT OR REPLACE INTO catalog_snapshots (connection_id, snapshot, updated_at) VALUES (?, ?, ?)");
+    query.addBindValue(connectionId);
+    query.addBindValue(snapshot);
+    query.addBindValue(QDateTime::currentDateTime());
+
+    if (!query.exec()) {
+        m_logger->error("Failed to save catalog snapshot: " + query.lastError().text());
+    }
+}
+
+QByteArray LocalStoreService::getCatalogSnapshot(int connectionId)
+{
+    auto db = getDatabase();
+    if (!db.isOpen() && !db.open()) return QByteArray();
+
+    QSqlQuery query(db);
+    query.prepare("SELECT snapshot FROM catalog_snapshots WHERE connection_id = ?");
+    query.addBindValue(connectionId);
+
+    if (query.exec() && query.next()) {
+        return query.value(0).toByteArray();
+    }
+    return QByteArray();
+}
+
+void LocalStoreService::deleteCatalogSnapshot(QSqlDatabase& db, int connectionId)
+{
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM catalog_snapshots WHERE connection_id = ?");
+    query.addBindValue(connectionId);
+
+    if (!query.exec()) {
+        m_logger->error("Failed to delete catalog snapshot: " + query.lastError().text());
+    }
+}
+
 std::vector<ConnectionData> LocalStoreService::getAllConnections()
 {
     std::vector<ConnectionData> results;
@@ -212,6 +271,8 @@ int LocalStoreService::saveConnection(const ConnectionData& data)
         if (data.id == -1) {
             return query.lastInsertId().toInt();
         }
+        // Host or database may have changed: the snapshot may describe another catalog.
+        deleteCatalogSnapshot(db, data.id);
         return data.id;
     } else {
         m_logger->error("Failed to save connection: " + query.lastError().text());
@@ -231,6 +292,7 @@ void LocalStoreService::deleteConnection(int id)
     if (!query.exec()) {
         m_logger->error("Failed to delete connection: " + query.lastError().text());
     }
+    deleteCatalogSnapshot(db, id);
 }
 
 void LocalStoreService::saveQueryHistory(const QueryHistoryItem& item)
@@ -23,11 +23,15 @@ public:
     void saveSetting(const QString& key, const QVariant& value) override;
     QVariant getSetting(const QString& key, const QVariant& defaultValue = QVariant()) override;
 
+    void saveCatalogSnapshot(int connectionId, const QByteArray& snapshot) override;
+    QByteArray getCatalogSnapshot(int connectionId) override;
+
 private:
     std::shared_ptr<ILogger> m_logger;
     QString m_dbPath;
     
     QSqlDatabase getDatabase();
+    void deleteCatalogSnapshot(QSqlDatabase& db, int connectionId);
 };
 
 }
@@ -0,0 +1,295 @@
+#include "QueryScheduler.h"
+#include <QThread>
+#include <algorithm>
+
+namespace Sofa::Core {
+
+QueryScheduler::QueryScheduler(std::shared_ptr<AddonHost> addonHost, int workerCount, QObject* parent, std::shared_ptr<CatalogCache> catalogCache)
+    : QObject(parent)
+{
+    qRegisterMetaType<CancelTokenPtr>();
+    qRegisterMetaType<DatasetPagePtr>();
+    const int count = std::max(1, workerCount);
+    for (int i = 0; i < count; ++i) {
+        auto* thread = new QThread(this);
+        thread->setObjectName(QString("sofa-query-worker-%1").arg(i));
+        auto* worker = new QueryWorker(addonHost);
+        worker->setCatalogCache(catalogCache);
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        connect(worker, &QueryWorker::cancelTokenReady, this, &QueryScheduler::onCancelTokenReady);
+        m_threads.push_back(thread);
+        m_workers.push_back(worker);
+        m_busy.push_back(false);
+        thread->start();
+    }
+
+    m_ioThread = new QThread(this);
+    m_ioThread->setObjectName("sofa-query-io");
+    m_ioWorker = new QueryWorker(addonHost);
+    m_ioWorker->setCatalogCache(catalogCache);
+    m_ioWorker->setAsyncIo(true);
+    m_ioWorker->moveToThread(m_ioThread);
+    connect(m_ioThread, &QThread::finished, m_ioWorker, &QObject::deleteLater);
+    connect(m_ioWorker, &QueryWorker::cancelTokenReady, this, &QueryScheduler::onCancelTokenReady);
+    m_ioThread->start();
+}
+
+QueryScheduler::~QueryScheduler()
+{
+    for (auto* thread : m_threads) {
+        if (thread->isRunning()) {
+            thread->quit();
+            thread->wait();
+        }
+    }
+    if (m_ioThread->isRunning()) {
+        m_ioThread->quit();
+        m_ioThread->wait();
+    }
+}
+
+int QueryScheduler::defaultWorkerCount()
+{
+    return std::clamp(QThread::idealThreadCount(), 2, 4);
+}
+
+QString QueryScheduler::addRequest(const QString& requestTag, const QString& type)
+{
+    const quint64 serial = m_nextSerial++;
+    const QString requestId = requestTag + "#" + QString::number(serial);
+
+    const QString previous = m_latestByTag.value(requestTag);
+    if (!previous.isEmpty()) {
+        cancel(previous);
+        drop(previous);
+    }
+
+    RequestHandle handle;
+    handle.id = requestId;
+    handle.tag = requestTag;
+    handle.type = type;
+    handle.serial = serial;
+    m_requests.insert(requestId, handle);
+    m_latestByTag.insert(requestTag, requestId);
+    return requestId;
+}
+
+QString QueryScheduler::submit(const QString& requestTag, const QString& type, Job job, const QString& affinityKey)
+{
+    const QString requestId = addRequest(requestTag, type);
+    m_queue.push_back({ requestId, affinityKey, std::move(job) });
+    if (!affinityKey.isEmpty()) {
+        // A new job for the key wants the binding kept.
+        m_pendingAffinityRelease.remove(affinityKey);
+    }
+
+    dispatch();
+    emit activeRequestsChanged();
+    return requestId;
+}
+
+int QueryScheduler::pickWorker(const QString& affinityKey) const
+{
+    if (!affinityKey.isEmpty()) {
+        auto bound = m_affinity.constFind(affinityKey);
+        if (bound != m_affinity.constEnd()) {
+            return m_busy[bound.value()] ? -1 : bound.value();
+        }
+    }
+    for (int i = 0; i < static_cast<int>(m_workers.size()); ++i) {
+        if (!m_busy[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void QueryScheduler::dispatch()
+{
+    // FIFO, except that a job pinned to a busy worker lets later jobs go first.
+    for (auto queued = m_queue.begin(); queued != m_queue.end();) {
+        auto it = m_requests.find(queued->requestId);
+        if (it == m_requests.end()) {
+            // Dropped while queued.
+            queued = m_queue.erase(queued);
+            continue;
+        }
+        const int i = pickWorker(queued->affinityKey);
+        if (i < 0) {
+            ++queued;
+            continue;
+        }
+        PendingJob pending = std::move(*queued);
+        queued = m_queue.erase(queued);
+
+        if (!pending.affinityKey.isEmpty()) {
+            m_affinity.insert(pending.affinityKey, i);
+            const QString key = pending.affinityKey;
+            const bool stillQueued = std::any_of(m_queue.begin(), m_queue.end(),
+                                                 [&key](const PendingJob& job) { return job.affinityKey == key; });
+            if (!stillQueued && m_pendingAffinityRelease.remove(key)) {
+                m_affinity.remove(key);
+            }
+        }
+        it->workerIndex = i;
+        m_busy[i] = true;
+
+        QueryWorker* worker = m_workers[i];
+        QMetaObject::invokeMethod(worker, [this, worker, i, pending = std::move(pending)]() {
+            pending.job(worker, pending.requestId);
+            worker->releaseCancelToken();
+            // Queued back to the scheduler thread, after every signal the job emitted.
+            const QString requestId = pending.requestId;
+            QMetaObject::invokeMethod(this, [this, i, requestId]() { onWorkerIdle(i, requestId); }, Qt::QueuedConnection);
+        }, Qt::QueuedConnection);
+    }
+}
+
+QString QueryScheduler::submitIo(const QString& requestTag, const QString& type, Job job)
+{
+    const QString requestId = addRequest(requestTag, type);
+    m_requests[requestId].workerIndex = kIoWorkerIndex;
+
+    QueryWorker* worker = m_ioWorker;
+    QMetaObject::invokeMethod(worker, [this, worker, requestId, job = std::move(job)]() {
+        job(worker, requestId);
+        worker->releaseCancelToken();
+        // A statement still being read ends with its own terminal signal.
+        if (worker->isRunningAsync(requestId)) {
+            return;
+        }
+        QMetaObject::invokeMethod(this, [this, requestId]() { drop(requestId); }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+
+    emit activeRequestsChanged();
+    return requestId;
+}
+
+void QueryScheduler::releaseAffinity(const QString& affinityKey)
+{
+    const bool queued = std::any_of(m_queue.begin(), m_queue.end(),
+                                    [&affinityKey](const PendingJob& job) { return job.affinityKey == affinityKey; });
+    if (queued) {
+        m_pendingAffinityRelease.insert(affinityKey);
+    } else {
+        m_affinity.remove(affinityKey);
+    }
+}
+
+void QueryScheduler::clearAffinity()
+{
+    m_affinity.clear();
+    m_pendingAffinityRelease.clear();
+}
+
+void QueryScheduler::onWorkerIdle(int workerIndex, const QString& requestId)
+{
+    if (workerIndex < 0 || workerIndex >= static_cast<int>(m_busy.size())) {
+        return;
+    }
+    m_busy[workerIndex] = false;
+    // Jobs that end without a terminal signal (e.g. a failed count) must not stay active.
+    drop(requestId);
+    dispatch();
+}
+
+const QueryScheduler::RequestHandle* QueryScheduler::request(const QString& requestId) const
+{
+    auto it = m_requests.constFind(requestId);
+    if (it == m_requests.constEnd()) {
+        return nullptr;
+    }
+    return &it.value();
+}
+
+QString QueryScheduler::latestRequestId(const QString& requestTag) const
+{
+    return m_latestByTag.value(requestTag);
+}
+
+QString QueryScheduler::latestStartedRequestId() const
+{
+    const RequestHandle* latest = nullptr;
+    for (const auto& handle : m_requests) {
+        if (handle.started && (!latest || handle.serial > latest->serial)) {
+            latest = &handle;
+        }
+    }
+    return latest ? latest->id : QString();
+}
+
+void QueryScheduler::markStarted(const QString& requestId, int backendPid)
+{
+    auto it = m_requests.find(requestId);
+    if (it == m_requests.end()) {
+        return;
+    }
+    it->started = true;
+    it->backendPid = backendPid;
+}
+
+void QueryScheduler::finish(const QString& requestId)
+{
+    drop(requestId);
+}
+
+bool QueryScheduler::cancel(const QString& requestId, QString* error)
+{
+    auto it = m_requests.constFind(requestId);
+    if (it == m_requests.constEnd() || !it->cancelToken) {
+        return false;
+    }
+    return it->cancelToken->cancel(error);
+}
+
+void QueryScheduler::onCancelTokenReady(const QString& requestId, CancelTokenPtr token)
+{
+    auto it = m_requests.find(requestId);
+    if (it == m_requests.end()) {
+        // Dropped (superseded or cancelled) before it reached the server: stop it there too.
+        if (token) token->cancel();
+        return;
+    }
+    it->cancelToken = std::move(token);
+}
+
+bool QueryScheduler::drop(const QString& requestId)
+{
+    auto it = m_requests.find(requestId);
+    if (it == m_requests.end()) {
+        return false;
+    }
+    const bool queued = it->workerIndex == -1;
+    if (m_latestByTag.value(it->tag) == requestId) {
+        m_latestByTag.remove(it->tag);
+    }
+    m_requests.erase(it);
+    if (queued) {
+        m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(),
+                                     [&requestId](const PendingJob& job) { return job.requestId == requestId; }),
+                      m_queue.end());
+    }
+    emit activeRequestsChanged();
+    return queued;
+}
+
+bool QueryScheduler::hasActiveRequests(const QStringList& types) const
+{
+    for (const auto& handle : m_requests) {
+        if (types.isEmpty() || types.contains(handle.type)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void QueryScheduler::broadcast(const char* slot)
+{
+    for (auto* worker : m_workers) {
+        QMetaObject::invokeMethod(worker, slot, Qt::QueuedConnection);
+    }
+    QMetaObject::invokeMethod(m_ioWorker, slot, Qt::QueuedConnection);
+}
+
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "AddonHost.h"
+#include "QueryWorker.h"
+
+class QThread;
+
+namespace Sofa::Core {
+
+// Runs requests on a fixed set of QueryWorkers, each on its own thread, so a
+// long query in one tab does not hold up work coming from the others. A
+// separate async I/O worker multiplexes console statements on one thread.
+// Requests are addressed by a scheduler-generated id; the caller's requestTag
+// is kept on the handle so results can be routed back to the UI.
+class QueryScheduler : public QObject {
+    Q_OBJECT
+public:
+    using Job = std::function<void(QueryWorker* worker, const QString& requestId)>;
+
+    struct RequestHandle {
+        QString id;
+        QString tag;
+        QString type;
+        int backendPid = -1;
+        CancelTokenPtr cancelToken;
+        int workerIndex = -1; // -1 while queued, kIoWorkerIndex on the I/O worker
+        quint64 serial = 0;
+        bool started = false;
+    };
+
+    static constexpr int kIoWorkerIndex = -2;
+
+    // catalogCache (optional) is shared by every worker.
+    explicit QueryScheduler(std::shared_ptr<AddonHost> addonHost, int workerCount = defaultWorkerCount(), QObject* parent = nullptr, std::shared_ptr<CatalogCache> catalogCache = nullptr);
+    ~QueryScheduler() override;
+
+    static int defaultWorkerCount();
+
+    const std::vector<QueryWorker*>& workers() const { return m_workers; }
+    QueryWorker* ioWorker() const { return m_ioWorker; }
+
+    // Queues a job and returns its request id. A request submitted with a tag
+    // that is still pending supersedes it: the older one is cancelled on the
+    // server if it is running, and its result will be dropped.
+    // Jobs sharing an affinityKey always run on the same worker, for state that
+    // lives on one worker's connection (e.g. a server-side cursor).
+    QString submit(const QString& requestTag, const QString& type, Job job, const QString& affinityKey = QString());
+    // Runs the job on the async I/O worker right away, with no queueing: it is
+    // never busy, because its statements are read from the event loop. Jobs the
+    // worker can't run asynchronously block it, so only submit sql here.
+    QString submitIo(const QString& requestTag, const QString& type, Job job);
+    // Unbinds an affinity key once the jobs already queued for it have started.
+    void releaseAffinity(const QString& affinityKey);
+    void clearAffinity();
+
+    // Looks up a live request; returns nullptr once it finished or was dropped.
+    const RequestHandle* request(const QString& requestId) const;
+    QString latestRequestId(const QString& requestTag) const;
+    QString latestStartedRequestId() const;
+    void markStarted(const QString& requestId, int backendPid);
+    void finish(const QString& requestId);
+    // Interrupts a running request through its cancel token. False when it has
+    // none (not started yet, or the driver has no out-of-band cancel).
+    bool cancel(const QString& requestId, QString* error = nullptr);
+    // Forgets a request; returns true when it had not reached a worker yet.
+    bool drop(const QString& requestId);
+
+    bool hasActiveRequests(const QStringList& types = {}) const;
+    void broadcast(const char* slot);
+
+signals:
+    void activeRequestsChanged();
+
+private:
+    struct PendingJob {
+        QString requestId;
+        QString affinityKey;
+        Job job;
+    };
+
+    QString addRequest(const QString& requestTag, const QString& type);
+    void dispatch();
+    int pickWorker(const QString& affinityKey) const;
+    void onWorkerIdle(int workerIndex, const QString& requestId);
+    void onCancelTokenReady(const QString& requestId, CancelTokenPtr token);
+
+    std::vector<QueryWorker*> m_workers;
+    std::vector<QThread*> m_threads;
+    QueryWorker* m_ioWorker = nullptr;
+    QThread* m_ioThread = nullptr;
+    std::vector<bool> m_busy;
+    std::deque<PendingJob> m_queue;
+    QHash<QString, RequestHandle> m_requests;
+    QHash<QString, QString> m_latestByTag;
+    QHash<QString, int> m_affinity;
+    QSet<QString> m_pendingAffinityRelease;
+    quint64 m_nextSerial = 1;
+};
+
+}
@@ -1,15 +1,127 @@
 #include "QueryWorker.h"
+#include "DataExport.h"
+#include "DataImport.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
 #include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+#include <deque>
 
 namespace Sofa::Core {
+namespace {
+// A small first batch gets rows on screen quickly; later batches are larger to
+// keep the number of cross-thread signals down.
+constexpr int kFirstSqlBatchRows = 200;
+constexpr int kSqlBatchRows = 2000;
+// Explorer table lists follow the same pattern.
+constexpr int kFirstTablesBatch = 200;
+constexpr int kTablesBatch = 2000;
+// The console grid keeps every streamed row, so reading stops here.
+constexpr int kMaxStreamedSqlRows = 200000;
+// Connections an async worker keeps warm; it may lease many more at once.
+constexpr int kAsyncIdleConnections = 8;
+// Imports read and parse the file in fixed-size chunks, so memory stays flat.
+constexpr qint64 kImportChunkBytes = 1024 * 1024;
+constexpr qint64 kImportProgressIntervalMs = 250;
+// Exports write each chunk of COPY data before reading the next one.
+constexpr qint64 kExportChunkBytes = 256 * 1024;
+// A pager holds a transaction (and its snapshot) open on the server, so an
+// abandoned one must not linger.
+constexpr qint64 kPagerIdleTimeoutMs = 2 * 60 * 1000;
+
+// Output of the ranges of a parallel export, handed from the range threads to
+// the one that writes the file. push() waits while the queue is full.
+struct ExportChunk {
+    size_t range = 0;
+    QByteArray data;
+    int rows = 0;
+    bool last = false;
+    QString error;
+};
+
+class ExportChunkQueue {
+public:
+    explicit ExportChunkQueue(size_t capacity) : m_capacity(capacity) {}
+
+    // False once stopped: the chunk was not queued. force queues it anyway
+    // (a range's final chunk, which the writer counts).
+    bool push(ExportChunk chunk, bool force = false)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!force && !m_stopped && m_chunks.size() >= m_capacity) {
+            m_notFull.wait(&m_mutex);
+        }
+        if (m_stopped && !force) {
+            return false;
+        }
+        m_chunks.push_back(std::move(chunk));
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    ExportChunk pop()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_chunks.empty()) {
+            m_notEmpty.wait(&m_mutex);
+        }
+        ExportChunk chunk = std::move(m_chunks.front());
+        m_chunks.pop_front();
+        m_notFull.wakeOne();
+        return chunk;
+    }
+
+    void stop()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopped = true;
+        m_notFull.wakeAll();
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    std::deque<ExportChunk> m_chunks;
+    size_t m_capacity = 1;
+    bool m_stopped = false;
+};
+
+// The grid cap is a row limit like any other, so the cursor names it when it trips.
+QueryLimits streamedSqlLimits(const QueryLimits& limits)
+{
+    QueryLimits cursorLimits = limits;
+    if (cursorLimits.maxRows <= 0 || cursorLimits.maxRows > kMaxStreamedSqlRows) {
+        cursorLimits.maxRows = kMaxStreamedSqlRows;
+    }
+    return cursorLimits;
+}
+}
 
 QueryWorker::QueryWorker(std::shared_ptr<AddonHost> addonHost, QObject* parent)
     : QObject(parent)
-    , m_addonHost(std::move(addonHost))
+    , m_addonHost(addonHost)
+    , m_pool(std::move(addonHost))
 {
+    // Child of the worker so it follows it to the worker thread on moveToThread().
+    m_poolSweepTimer = new QTimer(this);
+    m_poolSweepTimer->setInterval(30 * 1000);
+    connect(m_poolSweepTimer, &QTimer::timeout, this, [this]() {
+        evictIdlePagers();
+        m_pool.evictIdle();
+    });
 }
 
-QVariantMap QueryWorker::datasetToVariant(const DatasetPage& page)
+QVariantMap QueryWorker::datasetToVariant(DatasetPage page)
 {
     QVariantMap result;
     if (!page.warning.isEmpty()) {
@@ -17,6 +129,13 @@ QVariantMap QueryWorker::datasetToVariant(const DatasetPage& page)
     }
     result["executionTime"] = (double)page.executionTimeMs;
     result["hasMore"] = page.hasMore;
+    if (!page.nextCursor.isEmpty()) {
+        result["nextCursor"] = page.nextCursor;
+    }
+    if (page.totalRows >= 0) {
+        result["totalRows"] = (double)page.totalRows;
+        result["totalRowsEstimated"] = page.totalRowsEstimated;
+    }
 
     QVariantList columns;
     for (const auto& col : page.columns) {
@@ -34,20 +153,8 @@ QVariantMap QueryWorker::datasetToVariant(const DatasetPage& page)
     }
     result["columns"] = columns;
 
-    QVariantList rows;
-    QVariantList nulls;
-    for (const auto& row : page.rows) {
-        QVariantList rowList;
-        QVariantList nullRow;
-        for (const auto& val : row) {
-            rowList.append(val);
-            nullRow.append(val.isNull());
-        }
-        rows.append(QVariant(rowList));
-        nulls.append(QVariant(nullRow));
-    }
-    result["rows"] = rows;
-    result["nulls"] = nulls;
+    result["rowCount"] = page.rowCount();
+    result["page"] = QVariant::fromValue(DatasetPagePtr(std::make_shared<const DatasetPage>(std::move(page))));
 
     return result;
 }
@@ -105,28 +212,129 @@ QVariantMap QueryWorker::tableIndexesToVariant(const QString& schema, const QStr
     return result;
 }
 
-void QueryWorker::runSql(const QVariantMap& connectionInfo, const QString& queryText, const QString& requestTag)
+void QueryWorker::schemaLists(ICatalogProvider& catalog, QStringList* visible, QStringList* hidden)
 {
-    if (!m_addonHost) {
-        emit sqlError(requestTag, "AddonHost indisponível.");
-        return;
+    auto publicFirst = [](const std::vector<QString>& schemas, const QSet<QString>& skip) {
+        QStringList list;
+        bool publicFound = false;
+        for (const auto& s : schemas) {
+            if (skip.contains(s)) {
+                continue;
+            }
+            if (s == "public") {
+                publicFound = true;
+            } else {
+                list.append(s);
+            }
+        }
+        if (publicFound) {
+            list.prepend("public");
+        }
+        return list;
+    };
+
+    const std::vector<QString> hiddenSchemas = catalog.listHiddenSchemas();
+    QSet<QString> hiddenSet;
+    for (const auto& s : hiddenSchemas) {
+        hiddenSet.insert(s);
+    }
+    if (visible) {
+        *visible = publicFirst(catalog.listSchemas(), hiddenSet);
+    }
+    if (hidden) {
+        *hidden = publicFirst(hiddenSchemas, {});
+    }
+}
+
+QVariantMap QueryWorker::catalogTableToVariant(const CatalogTable& t)
+{
+    QVariantMap table;
+    table["name"] = t.name;
+    table["oid"] = t.oid;
+    table["hasPrimaryKey"] = t.hasPrimaryKey;
+    table["kind"] = t.kind;
+    table["estimatedRows"] = (double)t.estimatedRows;
+    table["estimatedBytes"] = (double)t.estimatedBytes;
+    return table;
+}
+
+ConnectionPool::Lease QueryWorker::acquireConnection(const QVariantMap& connectionInfo, QString* error, int statementTimeoutMs)
+{
+    // The timer lives on the worker thread, so it can only be started from here.
+    if (!m_poolSweepTimer->isActive()) {
+        m_poolSweepTimer->start();
+    }
+    auto connection = m_pool.acquire(connectionInfo, error);
+    if (connection) {
+        if (auto queryProvider = connection->query()) {
+            queryProvider->setStatementTimeout(statementTimeoutMs);
+        }
     }
-    QString driverId = connectionInfo.value("driverId").toString();
-    if (!m_addonHost->hasAddon(driverId)) {
-        emit sqlError(requestTag, "Driver indisponível: " + driverId);
+    return connection;
+}
+
+void QueryWorker::closePager(const QString& pagingKey)
+{
+    // Erasing the session closes the cursor before the lease returns the connection.
+    m_pagers.erase(pagingKey);
+}
+
+void QueryWorker::evictIdlePagers()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = m_pagers.begin(); it != m_pagers.end();) {
+        if ((now - it->second.lastUsedMs) > kPagerIdleTimeoutMs) {
+            it = m_pagers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void QueryWorker::armCancelToken(const QString& requestTag, const ConnectionPool::Lease& connection)
+{
+    releaseCancelToken();
+    auto handle = connection->cancelHandle();
+    if (!handle) {
         return;
     }
-    auto addon = m_addonHost->getAddon(driverId);
-    auto connection = addon->createConnection();
+    m_cancelToken = std::make_shared<CancelToken>(std::move(handle));
+    emit cancelTokenReady(requestTag, m_cancelToken);
+}
+
+void QueryWorker::releaseCancelToken()
+{
+    if (m_cancelToken) {
+        m_cancelToken->release();
+        m_cancelToken.reset();
+    }
+}
+
+void QueryWorker::setAsyncIo(bool enabled)
+{
+    m_asyncIo = enabled;
+    m_pool.setMaxSize(enabled ? kAsyncIdleConnections : 4);
+}
 
-    QString host = connectionInfo.value("host").toString();
-    int port = connectionInfo.value("port", 5432).toInt();
-    QString database = connectionInfo.value("database").toString();
-    QString user = connectionInfo.value("user").toString();
-    QString password = connectionInfo.value("password").toString();
+void QueryWorker::releaseConnections()
+{
+    // Statements still in flight are stopped; their requests were dropped with the connection.
+    while (!m_asyncRuns.empty()) {
+        finishAsyncSql(m_asyncRuns.begin()->first, "Connection closed");
+    }
+    m_pagers.clear();
+    m_pool.clear();
+    if (m_poolSweepTimer->isActive()) {
+        m_poolSweepTimer->stop();
+    }
+}
 
-    if (!connection->open(host, port, database, user, password)) {
-        emit sqlError(requestTag, connection->lastError());
+void QueryWorker::runSql(const QVariantMap& connectionInfo, const QString& queryText, const QString& requestTag, const QueryLimits& limits)
+{
+    QString error;
+    auto connection = acquireConnection(connectionInfo, &error, limits.statementTimeoutMs);
+    if (!connection) {
+        emit sqlError(requestTag, error);
         return;
     }
     auto queryProvider = connection->query();
@@ -135,42 +343,278 @@ void QueryWorker::runSql(const QVariantMap& connectionInfo, const QString& query
         return;
     }
 
+    if (m_asyncIo && startAsyncSql(connection, queryProvider.get(), queryText, requestTag, limits)) {
+        return;
+    }
+
     int backendPid = queryProvider->backendPid();
+    armCancelToken(requestTag, connection);
     emit sqlStarted(requestTag, backendPid);
 
+    if (streamSql(queryProvider.get(), connection, queryText, requestTag, limits)) {
+        return;
+    }
+
     DatasetRequest request;
+    request.limits = limits;
     DatasetPage page = queryProvider->execute(queryText, request);
     if (!page.warning.isEmpty() && page.columns.empty()) {
+        connection.markSuspect();
         emit sqlError(requestTag, page.warning);
         return;
     }
 
-    QVariantMap result = datasetToVariant(page);
+    QVariantMap result = datasetToVariant(std::move(page));
+    emit sqlFinished(requestTag, result);
+}
+
+bool QueryWorker::streamSql(IQueryProvider* queryProvider, ConnectionPool::Lease& connection, const QString& queryText, const QString& requestTag, const QueryLimits& limits)
+{
+    auto cursor = queryProvider->openCursor(queryText, streamedSqlLimits(limits));
+    if (!cursor) {
+        return false;
+    }
+
+    DatasetPage batch = cursor->fetchNext(kFirstSqlBatchRows);
+    if (!batch.warning.isEmpty() && batch.rowCount() == 0 && cursor->columns().empty()) {
+        connection.markSuspect();
+        emit sqlError(requestTag, batch.warning);
+        return true;
+    }
+
+    batch.columns = cursor->columns();
+    int streamed = batch.rowCount();
+    QString warning = batch.warning;
+    qint64 executionTimeMs = batch.executionTimeMs;
+    bool hasMore = batch.hasMore;
+    QVariantMap payload = datasetToVariant(std::move(batch));
+    payload["reset"] = true;
+    emit sqlBatch(requestTag, payload);
+
+    while (!cursor->atEnd() && streamed < kMaxStreamedSqlRows) {
+        DatasetPage next = cursor->fetchNext(qMin(kSqlBatchRows, kMaxStreamedSqlRows - streamed));
+        const int rows = next.rowCount();
+        streamed += rows;
+        warning = next.warning;
+        executionTimeMs = next.executionTimeMs;
+        hasMore = next.hasMore;
+        if (rows > 0) {
+            emit sqlBatch(requestTag, datasetToVariant(std::move(next)));
+        }
+    }
+
+    const bool truncated = !cursor->atEnd() || hasMore;
+    cursor->close();
+    if (!warning.isEmpty()) {
+        connection.markSuspect();
+    }
+
+    QVariantMap result;
+    if (!warning.isEmpty()) {
+        result["warning"] = warning;
+    }
+    result["executionTime"] = (double)executionTimeMs;
+    result["hasMore"] = truncated;
+    result["rowCount"] = streamed;
+    result["streamed"] = true;
     emit sqlFinished(requestTag, result);
+    return true;
+}
+
+bool QueryWorker::startAsyncSql(ConnectionPool::Lease& connection, IQueryProvider* queryProvider, const QString& queryText, const QString& requestTag, const QueryLimits& limits)
+{
+    auto cursor = queryProvider->openAsyncCursor(queryText, streamedSqlLimits(limits));
+    if (!cursor) {
+        return false;
+    }
+
+    // Each run owns its token: the worker's single token belongs to blocking jobs.
+    AsyncSqlRun run;
+    if (auto handle = connection->cancelHandle()) {
+        run.cancelToken = std::make_shared<CancelToken>(std::move(handle));
+        emit cancelTokenReady(requestTag, run.cancelToken);
+    }
+    emit sqlStarted(requestTag, queryProvider->backendPid());
+
+    const qintptr socket = cursor->socket();
+    if (socket >= 0) {
+        run.readNotifier = std::make_unique<QSocketNotifier>(socket, QSocketNotifier::Read);
+        connect(run.readNotifier.get(), &QSocketNotifier::activated, this, [this, requestTag]() { pumpAsyncSql(requestTag); });
+        run.writeNotifier = std::make_unique<QSocketNotifier>(socket, QSocketNotifier::Write);
+        run.writeNotifier->setEnabled(cursor->wantsWrite());
+        connect(run.writeNotifier.get(), &QSocketNotifier::activated, this, [this, requestTag]() { pumpAsyncSql(requestTag); });
+    }
+    run.connection = std::move(connection);
+    run.cursor = std::move(cursor);
+    m_asyncRuns[requestTag] = std::move(run);
+
+    // A failed send, or a reply that is already buffered, is handled right away.
+    pumpAsyncSql(requestTag);
+    return true;
 }
 
-void QueryWorker::runDataset(const QVariantMap& connectionInfo, const QString& schema, const QString& table, int limit, int offset, const QString& sortColumn, bool sortAscending, const QString& requestTag, const QString& filterClause)
+void QueryWorker::pumpAsyncSql(const QString& requestTag)
 {
-    if (!m_addonHost) {
-        emit datasetError(requestTag, "AddonHost indisponível.");
+    auto it = m_asyncRuns.find(requestTag);
+    if (it == m_asyncRuns.end()) {
         return;
     }
-    QString driverId = connectionInfo.value("driverId").toString();
-    if (!m_addonHost->hasAddon(driverId)) {
-        emit datasetError(requestTag, "Driver indisponível: " + driverId);
+    AsyncSqlRun& run = it->second;
+    IAsyncResultCursor* cursor = run.cursor.get();
+    if (!run.readNotifier) {
+        finishAsyncSql(requestTag, "Connection has no socket to watch");
+        return;
+    }
+    cursor->poll();
+
+    // Hands out everything already received; fetchNext() never waits for the network here.
+    while (true) {
+        DatasetPage batch = cursor->fetchNext(run.sentColumns ? kSqlBatchRows : kFirstSqlBatchRows);
+        run.warning = batch.warning;
+        run.hasMore = batch.hasMore;
+        run.executionTimeMs = batch.executionTimeMs;
+
+        const int rows = batch.rowCount();
+        if (!run.sentColumns && (!cursor->columns().empty() || cursor->atEnd())) {
+            if (cursor->columns().empty() && !batch.warning.isEmpty()) {
+                finishAsyncSql(requestTag, batch.warning);
+                return;
+            }
+            batch.columns = cursor->columns();
+            QVariantMap payload = datasetToVariant(std::move(batch));
+            payload["reset"] = true;
+            emit sqlBatch(requestTag, payload);
+            run.sentColumns = true;
+            run.streamed += rows;
+        } else if (rows > 0) {
+            emit sqlBatch(requestTag, datasetToVariant(std::move(batch)));
+            run.streamed += rows;
+        }
+
+        if (cursor->atEnd()) {
+            finishAsyncSql(requestTag);
+            return;
+        }
+        if (rows == 0) {
+            break;
+        }
+    }
+    run.writeNotifier->setEnabled(cursor->wantsWrite());
+}
+
+void QueryWorker::finishAsyncSql(const QString& requestTag, const QString& error)
+{
+    auto it = m_asyncRuns.find(requestTag);
+    if (it == m_asyncRuns.end()) {
         return;
     }
-    auto addon = m_addonHost->getAddon(driverId);
-    auto connection = addon->createConnection();
+    AsyncSqlRun run = std::move(it->second);
+    m_asyncRuns.erase(it);
 
-    QString host = connectionInfo.value("host").toString();
-    int port = connectionInfo.value("port", 5432).toInt();
-    QString database = connectionInfo.value("database").toString();
-    QString user = connectionInfo.value("user").toString();
-    QString password = connectionInfo.value("password").toString();
+    // Stop watching before the socket can serve another statement.
+    run.readNotifier.reset();
+    run.writeNotifier.reset();
+    run.cursor->close();
+    if (run.cancelToken) {
+        run.cancelToken->release();
+    }
 
-    if (!connection->open(host, port, database, user, password)) {
-        emit datasetError(requestTag, connection->lastError());
+    if (!error.isEmpty()) {
+        run.connection.markSuspect();
+        emit sqlError(requestTag, error);
+        return;
+    }
+    if (!run.warning.isEmpty()) {
+        run.connection.markSuspect();
+    }
+
+    QVariantMap result;
+    if (!run.warning.isEmpty()) {
+        result["warning"] = run.warning;
+    }
+    result["executionTime"] = (double)run.executionTimeMs;
+    result["hasMore"] = run.hasMore;
+    result["rowCount"] = run.streamed;
+    result["streamed"] = true;
+    emit sqlFinished(requestTag, result);
+}
+
+bool QueryWorker::runPagedDataset(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const DatasetRequest& request, const QString& requestTag, const QString& pagingKey)
+{
+    // Anything that changes the cursor's query invalidates it.
+    const QString signature = QStringList {
+        ConnectionPool::keyFor(connectionInfo),
+        schema,
+        table,
+        request.hasSort ? request.sortColumn : QString(),
+        request.sortAscending ? "asc" : "desc",
+        request.filter.trimmed()
+    }.join(QChar(0x1f));
+
+    auto it = m_pagers.find(pagingKey);
+    if (it != m_pagers.end() && it->second.signature != signature) {
+        m_pagers.erase(it);
+        it = m_pagers.end();
+    }
+
+    if (it == m_pagers.end()) {
+        PagerSession session;
+        // Set before openPager: the transaction it opens keeps the timeout for every page.
+        session.connection = acquireConnection(connectionInfo, nullptr, request.limits.statementTimeoutMs);
+        if (!session.connection) {
+            return false;
+        }
+        auto queryProvider = session.connection->query();
+        if (!queryProvider) {
+            return false;
+        }
+        session.pager = queryProvider->openPager(schema, table, request);
+        if (!session.pager) {
+            // Unsupported or failed to declare: plain getDataset reports the error, if any.
+            return false;
+        }
+        session.signature = signature;
+        it = m_pagers.emplace(pagingKey, std::move(session)).first;
+    }
+
+    PagerSession& session = it->second;
+    session.lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+    auto queryProvider = session.connection->query();
+    armCancelToken(requestTag, session.connection);
+    emit datasetStarted(requestTag, queryProvider ? queryProvider->backendPid() : -1);
+
+    DatasetPage page = session.pager->fetchPage(request.offset, request.limit);
+    if (!page.warning.isEmpty() && page.columns.empty()) {
+        session.connection.markSuspect();
+        m_pagers.erase(it);
+        emit datasetError(requestTag, page.warning);
+        return true;
+    }
+
+    emit datasetFinished(requestTag, datasetToVariant(std::move(page)));
+    return true;
+}
+
+void QueryWorker::runDataset(const QVariantMap& connectionInfo, const QString& schema, const QString& table, int limit, int offset, const QString& sortColumn, bool sortAscending, const QString& requestTag, const QString& filterClause, const QString& pagingKey, const QString& cursor, bool withCount, const QueryLimits& limits)
+{
+    if (!pagingKey.isEmpty()) {
+        DatasetRequest request;
+        request.limit = limit;
+        request.offset = offset;
+        request.hasSort = !sortColumn.isEmpty();
+        request.sortColumn = sortColumn;
+        request.sortAscending = sortAscending;
+        request.filter = filterClause;
+        request.limits = limits;
+        if (runPagedDataset(connectionInfo, schema, table, request, requestTag, pagingKey)) {
+            return;
+        }
+    }
+
+    QString error;
+    auto connection = acquireConnection(connectionInfo, &error, limits.statementTimeoutMs);
+    if (!connection) {
+        emit datasetError(requestTag, error);
         return;
     }
     auto queryProvider = connection->query();
@@ -180,6 +624,7 @@ void QueryWorker::runDataset(const QVariantMap& connectionInfo, const QString& s
     }
 
     int backendPid = queryProvider->backendPid();
+    armCancelToken(requestTag, connection);
     emit datasetStarted(requestTag, backendPid);
 
     DatasetRequest request;
@@ -189,38 +634,35 @@ void QueryWorker::runDataset(const QVariantMap& connectionInfo, const QString& s
     request.sortColumn = sortColumn;
     request.sortAscending = sortAscending;
     request.filter = filterClause;
+    request.cursor = cursor;
+    request.withCount = withCount;
+    request.limits = limits;
     DatasetPage page = queryProvider->getDataset(schema, table, request);
     if (!page.warning.isEmpty() && page.columns.empty()) {
+        connection.markSuspect();
         emit datasetError(requestTag, page.warning);
         return;
     }
 
-    QVariantMap result = datasetToVariant(page);
+    QVariantMap result = datasetToVariant(std::move(page));
     emit datasetFinished(requestTag, result);
 }
 
 void QueryWorker::runTableSchema(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const QString& requestTag)
 {
-    if (!m_addonHost) {
-        emit tableSchemaError(requestTag, "AddonHost indisponível.");
-        return;
-    }
-    QString driverId = connectionInfo.value("driverId").toString();
-    if (!m_addonHost->hasAddon(driverId)) {
-        emit tableSchemaError(requestTag, "Driver indisponível: " + driverId);
+    const QString cacheKey = ConnectionPool::keyFor(connectionInfo);
+    TableSchema ts;
+    if (m_catalogCache && m_catalogCache->tableSchema(cacheKey, schema, table, &ts)) {
+        emit tableSchemaStarted(requestTag, -1);
+        emit tableSchemaFinished(requestTag, tableSchemaToVariant(ts));
         return;
     }
-    auto addon = m_addonHost->getAddon(driverId);
-    auto connection = addon->createConnection();
-
-    QString host = connectionInfo.value("host").toString();
-    int port = connectionInfo.value("port", 5432).toInt();
-    QString database = connectionInfo.value("database").toString();
-    QString user = connectionInfo.value("user").toString();
-    QString password = connectionInfo.value("password").toString();
+    const quint64 cacheGeneration = m_catalogCache ? m_catalogCache->generation(cacheKey) : 0;
 
-    if (!connection->open(host, port, database, user, password)) {
-        emit tableSchemaError(requestTag, connection->lastError());
+    QString error;
+    auto connection = acquireConnection(connectionInfo, &error);
+    if (!connection) {
+        emit tableSchemaError(requestTag, error);
         return;
     }
 
@@ -228,6 +670,7 @@ void QueryWorker::runTableSchema(const QVariantMap& connectionInfo, const QStrin
     if (auto queryProvider = connection->query()) {
         backendPid = queryProvider->backendPid();
     }
+    armCancelToken(requestTag, connection);
     emit tableSchemaStarted(requestTag, backendPid);
 
     auto catalog = connection->catalog();
@@ -236,35 +679,189 @@ void QueryWorker::runTableSchema(const QVariantMap& connectionInfo, const QStrin
         return;
     }
 
-    TableSchema ts = catalog->getTableSchema(schema, table);
+    ts = catalog->getTableSchema(schema, table);
+    if (m_catalogCache) {
+        m_catalogCache->storeTableSchema(cacheKey, ts, cacheGeneration);
+    }
     QVariantMap result = tableSchemaToVariant(ts);
     emit tableSchemaFinished(requestTag, result);
 }
 
 void QueryWorker::runTableIndexes(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const QString& requestTag)
 {
-    if (!m_addonHost) {
-        emit tableIndexesError(requestTag, "AddonHost indisponível.");
+    const QString cacheKey = ConnectionPool::keyFor(connectionInfo);
+    std::vector<TableIndex> indexes;
+    if (m_catalogCache && m_catalogCache->tableIndexes(cacheKey, schema, table, &indexes)) {
+        emit tableIndexesStarted(requestTag, -1);
+        emit tableIndexesFinished(requestTag, tableIndexesToVariant(schema, table, indexes));
+        return;
+    }
+    const quint64 cacheGeneration = m_catalogCache ? m_catalogCache->generation(cacheKey) : 0;
+
+    QString error;
+    auto connection = acquireConnection(connectionInfo, &error);
+    if (!connection) {
+        emit tableIndexesError(requestTag, error);
+        return;
+    }
+
+    int backendPid = -1;
+    if (auto queryProvider = connection->query()) {
+        backendPid = queryProvider->backendPid();
+    }
+    armCancelToken(requestTag, connection);
+    emit tableIndexesStarted(requestTag, backendPid);
+
+    auto catalog = connection->catalog();
+    if (!catalog) {
+        emit tableIndexesError(requestTag, "Catalog provider indisponível.");
+        return;
+    }
+
+    error.clear();
+    indexes = catalog->getTableIndexes(schema, table, &error);
+    if (!error.isEmpty()) {
+        // Not cached: an empty list would read as "no indexes" until the next DDL.
+        connection.markSuspect();
+        emit tableIndexesError(requestTag, error);
+        return;
+    }
+    if (m_catalogCache) {
+        m_catalogCache->storeTableIndexes(cacheKey, schema, table, indexes, cacheGeneration);
+    }
+    QVariantMap result = tableIndexesToVariant(schema, table, indexes);
+    emit tableIndexesFinished(requestTag, result);
+}
+
+void QueryWorker::runSchemas(const QVariantMap& connectionInfo, const QString& requestTag)
+{
+    const QString cacheKey = ConnectionPool::keyFor(connectionInfo);
+    QStringList visible;
+    QStringList hidden;
+    if (!m_catalogCache || !m_catalogCache->schemas(cacheKey, &visible, &hidden)) {
+        const quint64 cacheGeneration = m_catalogCache ? m_catalogCache->generation(cacheKey) : 0;
+        QString error;
+        auto connection = acquireConnection(connectionInfo, &error);
+        if (!connection) {
+            emit schemasError(requestTag, error);
+            return;
+        }
+        int backendPid = -1;
+        if (auto queryProvider = connection->query()) {
+            backendPid = queryProvider->backendPid();
+        }
+        armCancelToken(requestTag, connection);
+        emit schemasStarted(requestTag, backendPid);
+
+        auto catalog = connection->catalog();
+        if (!catalog) {
+            emit schemasError(requestTag, "Catalog provider indisponível.");
+            return;
+        }
+        schemaLists(*catalog, &visible, &hidden);
+        if (m_catalogCache) {
+            m_catalogCache->storeSchemas(cacheKey, visible, hidden, cacheGeneration);
+        }
+    } else {
+        emit schemasStarted(requestTag, -1);
+    }
+
+    QVariantMap result;
+    result["schemas"] = visible;
+    result["hiddenSchemas"] = hidden;
+    emit schemasFinished(requestTag, result);
+}
+
+void QueryWorker::runTables(const QVariantMap& connectionInfo, const QString& schema, const QString& requestTag)
+{
+    int sent = 0;
+    auto emitBatch = [this, &schema, &requestTag, &sent](const std::vector<CatalogTable>& tables) {
+        QVariantList list;
+        list.reserve(static_cast<int>(tables.size()));
+        for (const auto& t : tables) {
+            list.append(catalogTableToVariant(t));
+        }
+        QVariantMap batch;
+        batch["schema"] = schema;
+        batch["tables"] = list;
+        batch["reset"] = sent == 0;
+        sent += static_cast<int>(tables.size());
+        emit tablesBatch(requestTag, batch);
+    };
+    auto finish = [&schema, &requestTag, &sent, this]() {
+        QVariantMap result;
+        result["schema"] = schema;
+        result["count"] = sent;
+        emit tablesFinished(requestTag, result);
+    };
+
+    const QString cacheKey = ConnectionPool::keyFor(connectionInfo);
+    std::vector<CatalogTable> cached;
+    if (m_catalogCache && m_catalogCache->tables(cacheKey, schema, &cached)) {
+        emit tablesStarted(requestTag, -1);
+        for (size_t first = 0; first < cached.size();) {
+            const size_t size = qMin(cached.size() - first, static_cast<size_t>(first == 0 ? kFirstTablesBatch : kTablesBatch));
+            emitBatch(std::vector<CatalogTable>(cached.begin() + first, cached.begin() + first + size));
+            first += size;
+        }
+        finish();
+        return;
+    }
+    const quint64 cacheGeneration = m_catalogCache ? m_catalogCache->generation(cacheKey) : 0;
+
+    QString error;
+    auto connection = acquireConnection(connectionInfo, &error);
+    if (!connection) {
+        emit tablesError(requestTag, error);
         return;
     }
+    int backendPid = -1;
+    if (auto queryProvider = connection->query()) {
+        backendPid = queryProvider->backendPid();
+    }
+    armCancelToken(requestTag, connection);
+    emit tablesStarted(requestTag, backendPid);
 
-    QString driverId = connectionInfo.value("driverId").toString();
-    if (!m_addonHost->hasAddon(driverId)) {
-        emit tableIndexesError(requestTag, "Driver indisponível: " + driverId);
+    auto catalog = connection->catalog();
+    if (!catalog) {
+        emit tablesError(requestTag, "Catalog provider indisponível.");
         return;
     }
 
-    auto addon = m_addonHost->getAddon(driverId);
-    auto connection = addon->createConnection();
+    // The provider reads in small batches so the first rows go out right away;
+    // later ones are coalesced. The whole list is kept for the cache.
+    std::vector<CatalogTable> all;
+    size_t pendingFrom = 0;
+    const bool ok = catalog->streamTables(schema, kFirstTablesBatch, [&](std::vector<CatalogTable>& tables) {
+        all.insert(all.end(), tables.begin(), tables.end());
+        if (sent == 0 || all.size() - pendingFrom >= static_cast<size_t>(kTablesBatch)) {
+            emitBatch(std::vector<CatalogTable>(all.begin() + pendingFrom, all.end()));
+            pendingFrom = all.size();
+        }
+        return true;
+    });
+    if (ok && pendingFrom < all.size()) {
+        emitBatch(std::vector<CatalogTable>(all.begin() + pendingFrom, all.end()));
+    }
+    if (!ok) {
+        emit tablesError(requestTag, "Não foi possível listar as tabelas de " + schema + ".");
+        return;
+    }
+    if (m_catalogCache) {
+        m_catalogCache->storeTables(cacheKey, schema, all, cacheGeneration);
+    }
+    finish();
+}
 
-    QString host = connectionInfo.value("host").toString();
-    int port = connectionInfo.value("port", 5432).toInt();
-    QString database = connectionInfo.value("database").toString();
-    QString user = connectionInfo.value("user").toString();
-    QString password = connectionInfo.value("password").toString();
+void QueryWorker::runSchemaIndexes(const QVariantMap& connectionInfo, const QString& schema, const QString& requestTag)
+{
+    const QString cacheKey = ConnectionPool::keyFor(connectionInfo);
+    const quint64 cacheGeneration = m_catalogCache ? m_catalogCache->generation(cacheKey) : 0;
 
-    if (!connection->open(host, port, database, user, password)) {
-        emit tableIndexesError(requestTag, connection->lastError());
+    QString error;
+    auto connection = acquireConnection(connectionInfo, &error);
+    if (!connection) {
+        emit tableIndexesError(requestTag, error);
         return;
     }
 
@@ -272,6 +869,7 @@ void QueryWorker::runTableIndexes(const QVariantMap& connectionInfo, const QStri
     if (auto queryProvider = connection->query()) {
         backendPid = queryProvider->backendPid();
     }
+    armCancelToken(requestTag, connection);
     emit tableIndexesStarted(requestTag, backendPid);
 
     auto catalog = connection->catalog();
@@ -280,41 +878,563 @@ void QueryWorker::runTableIndexes(const QVariantMap& connectionInfo, const QStri
         return;
     }
 
-    std::vector<TableIndex> indexes = catalog->getTableIndexes(schema, table);
-    QVariantMap result = tableIndexesToVariant(schema, table, indexes);
+    error.clear();
+    const auto schemaIndexes = catalog->getSchemaIndexes(schema, &error);
+    if (!error.isEmpty()) {
+        connection.markSuspect();
+        emit tableIndexesError(requestTag, error);
+        return;
+    }
+    QVariantMap tables;
+    for (const auto& [table, indexes] : schemaIndexes) {
+        if (m_catalogCache) {
+            m_catalogCache->storeTableIndexes(cacheKey, schema, table, indexes, cacheGeneration);
+        }
+        tables.insert(table, tableIndexesToVariant(schema, table, indexes).value("indexes"));
+    }
+    QVariantMap result;
+    result["schema"] = schema;
+    result["table"] = QString();
+    result["tables"] = tables;
     emit tableIndexesFinished(requestTag, result);
 }
 
-void QueryWorker::runCount(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const QString& requestTag) {
-    if (!m_addonHost) {
-        // Silent error or emit error if needed, but count is often auxiliary
+void QueryWorker::runCatalogVersion(const QVariantMap& connectionInfo, const QString& requestTag)
+{
+    QString error;
+    auto connection = acquireConnection(connectionInfo, &error);
+    auto catalog = connection ? connection->catalog() : nullptr;
+    emit catalogVersionFinished(requestTag, catalog ? catalog->catalogVersion() : QString());
+}
+
+void QueryWorker::runCount(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const QString& filterClause, const QString& requestTag) {
+    QString error;
+    auto connection = acquireConnection(connectionInfo, &error);
+    if (!connection) {
+        emit countError(requestTag, error);
+        return;
+    }
+    auto queryProvider = connection->query();
+    if (!queryProvider) {
+        emit countError(requestTag, "Query provider indisponível.");
+        return;
+    }
+
+    // The exact count can scan the whole table; reporting the pid makes it cancellable.
+    armCancelToken(requestTag, connection);
+    emit countStarted(requestTag, queryProvider->backendPid());
+
+    const RowCount count = queryProvider->countRows(schema, table, filterClause, CountStrategy::Exact);
+    if (count.total >= 0) {
+        emit countFinished(requestTag, count.total);
+    } else {
+        connection.markSuspect();
+        emit countError(requestTag, "Count failed");
+    }
+}
+
+void QueryWorker::runImport(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const QString& filePath, const QVariantMap& options, const QString& requestTag)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit importError(requestTag, QString("Cannot open %1: %2").arg(filePath, file.errorString()));
+        return;
+    }
+
+    QString error;
+    auto connection = acquireConnection(connectionInfo, &error);
+    if (!connection) {
+        emit importError(requestTag, error);
+        return;
+    }
+    auto queryProvider = connection->query();
+    auto catalog = connection->catalog();
+    if (!queryProvider || !catalog) {
+        emit importError(requestTag, "Query provider indisponível.");
+        return;
+    }
+
+    // Cancelling sends a server cancel: the COPY fails and the next write reports it.
+    armCancelToken(requestTag, connection);
+    emit importStarted(requestTag, queryProvider->backendPid());
+
+    const TableSchema tableSchema = catalog->getTableSchema(schema, table);
+    if (tableSchema.columns.empty()) {
+        emit importError(requestTag, QString("Table %1.%2 not found").arg(schema, table));
+        return;
+    }
+
+    const ImportOptions importOptions = ImportOptions::fromVariant(options);
+    DelimitedTextParser parser(importOptions);
+    ImportColumnMap columnMap;
+    std::unique_ptr<IBulkWriter> writer;
+    std::vector<ImportRecord> records;
+    std::vector<ImportRecord> rows;
+    long long rowsWritten = 0;
+    qint64 bytesRead = 0;
+    const qint64 totalBytes = file.size();
+    QElapsedTimer elapsed;
+    elapsed.start();
+    qint64 lastProgressMs = 0;
+
+    auto rowsPerSecond = [&]() {
+        const qint64 ms = qMax<qint64>(1, elapsed.elapsed());
+        return static_cast<double>(rowsWritten) * 1000.0 / ms;
+    };
+
+    // Returns false once the load failed; the error has been emitted.
+    auto writeRecords = [&]() {
+        size_t first = 0;
+        if (!writer && !records.empty()) {
+            QString mapError;
+            columnMap = ImportColumnMap::build(tableSchema, records.front(), importOptions, &mapError);
+            if (columnMap.tableColumns.isEmpty()) {
+                emit importError(requestTag, mapError);
+                return false;
+            }
+            writer = queryProvider->openBulkWriter(schema, table, columnMap.tableColumns, &error);
+            if (!writer) {
+                connection.markSuspect();
+                emit importError(requestTag, error);
+                return false;
+            }
+            first = importOptions.hasHeader ? 1 : 0;
+        }
+        rows.clear();
+        rows.reserve(records.size());
+        for (size_t i = first; i < records.size(); ++i) {
+            rows.push_back(columnMap.project(records[i]));
+        }
+        records.clear();
+        if (rows.empty()) {
+            return true;
+        }
+        if (!writer->writeRows(rows)) {
+            connection.markSuspect();
+            emit importError(requestTag, writer->lastError());
+            return false;
+        }
+        rowsWritten += static_cast<long long>(rows.size());
+        return true;
+    };
+
+    QByteArray chunk;
+    while (!file.atEnd()) {
+        chunk = file.read(kImportChunkBytes);
+        if (chunk.isEmpty() && file.error() != QFileDevice::NoError) {
+            if (writer) writer->abort("Read error");
+            emit importError(requestTag, QString("Cannot read %1: %2").arg(filePath, file.errorString()));
+            return;
+        }
+        bytesRead += chunk.size();
+        parser.feed(chunk, records);
+        if (!writeRecords()) {
+            return;
+        }
+
+        if (elapsed.elapsed() - lastProgressMs >= kImportProgressIntervalMs) {
+            lastProgressMs = elapsed.elapsed();
+            QVariantMap progress;
+            progress["rows"] = (double)rowsWritten;
+            progress["bytesRead"] = (double)bytesRead;
+            progress["totalBytes"] = (double)totalBytes;
+            progress["rowsPerSecond"] = rowsPerSecond();
+            emit importProgress(requestTag, progress);
+        }
+    }
+    parser.finish(records);
+    if (!writeRecords()) {
+        return;
+    }
+    if (!writer) {
+        emit importError(requestTag, "The file has no rows");
         return;
     }
-    QString driverId = connectionInfo.value("driverId").toString();
-    if (!m_addonHost->hasAddon(driverId)) {
+
+    const long long stored = writer->finish();
+    if (stored < 0) {
+        connection.markSuspect();
+        emit importError(requestTag, writer->lastError());
         return;
     }
-    auto addon = m_addonHost->getAddon(driverId);
-    auto connection = addon->createConnection();
 
-    QString host = connectionInfo.value("host").toString();
-    int port = connectionInfo.value("port", 5432).toInt();
-    QString database = connectionInfo.value("database").toString();
-    QString user = connectionInfo.value("user").toString();
-    QString password = connectionInfo.value("password").toString();
+    QVariantMap result;
+    result["rows"] = (double)stored;
+    result["bytesRead"] = (double)bytesRead;
+    result["executionTime"] = (double)elapsed.elapsed();
+    result["rowsPerSecond"] = rowsPerSecond();
+    result["columns"] = columnMap.tableColumns;
+    if (!columnMap.skippedColumns.isEmpty()) {
+        result["skippedColumns"] = columnMap.skippedColumns;
+    }
+    emit importFinished(requestTag, result);
+}
 
-    if (!connection->open(host, port, database, user, password)) {
+void QueryWorker::runExport(const QVariantMap& connectionInfo, const QVariantMap& source, const QString& filePath, const QVariantMap& options, const QString& requestTag)
+{
+    QString error;
+    auto connection = acquireConnection(connectionInfo, &error);
+    if (!connection) {
+        emit exportError(requestTag, error);
         return;
     }
     auto queryProvider = connection->query();
     if (!queryProvider) {
+        emit exportError(requestTag, "Query provider indisponível.");
+        return;
+    }
+
+    CopySource copySource;
+    copySource.sql = source.value("sql").toString();
+    copySource.schema = source.value("schema").toString();
+    copySource.table = source.value("table").toString();
+    copySource.filter = source.value("filter").toString();
+    const ExportOptions exportOptions = ExportOptions::fromVariant(options);
+    QString defaultTable = "export";
+    if (copySource.sql.trimmed().isEmpty()) {
+        auto quote = [](QString identifier) { return QString("\"%1\"").arg(identifier.replace("\"", "\"\"")); };
+        defaultTable = QString("%1.%2").arg(quote(copySource.schema), quote(copySource.table));
+    }
+
+    // Large tables: ranges over several connections. Returns false, having
+    // emitted nothing, when the table is not split.
+    if (exportOptions.parallel > 1 && copySource.sql.trimmed().isEmpty()
+        && runParallelExport(connectionInfo, connection, copySource, defaultTable, filePath, exportOptions, requestTag)) {
+        return;
+    }
+    error.clear();
+
+    // Written next to the target and renamed on success, so a failed or
+    // cancelled export never leaves a truncated file behind.
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        emit exportError(requestTag, QString("Cannot write %1: %2").arg(filePath, file.errorString()));
+        return;
+    }
+
+    armCancelToken(requestTag, connection);
+    emit exportStarted(requestTag, queryProvider->backendPid());
+
+    const CopyFormat copyFormat = exportOptions.format == "csv" ? CopyFormat::Csv : CopyFormat::Text;
+    auto reader = queryProvider->openCopyOut(copySource, copyFormat, &error);
+    if (!reader) {
+        file.cancelWriting();
+        emit exportError(requestTag, error);
+        return;
+    }
+
+    auto formatter = ExportFormatter::create(exportOptions, reader->columns(), defaultTable);
+    ImportOptions textOptions;
+    textOptions.format = "tsv";
+    textOptions.delimiter = '\t';
+    DelimitedTextParser parser(textOptions);
+    std::vector<ImportRecord> records;
+
+    long long rowsWritten = 0;
+    qint64 bytesWritten = 0;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    qint64 lastProgressMs = 0;
+    auto rowsPerSecond = [&]() {
+        const qint64 ms = qMax<qint64>(1, elapsed.elapsed());
+        return static_cast<double>(rowsWritten) * 1000.0 / ms;
+    };
+
+    QByteArray out;
+    auto writeOut = [&]() {
+        if (out.isEmpty()) {
+            return true;
+        }
+        if (file.write(out) != out.size()) {
+            error = QString("Cannot write %1: %2").arg(filePath, file.errorString());
+            return false;
+        }
+        bytesWritten += out.size();
+        out.clear();
+        return true;
+    };
+    auto fail = [&](const QString& message) {
+        reader->close();
+        file.cancelWriting();
+        emit exportError(requestTag, message);
+    };
+
+    while (!reader->atEnd()) {
+        int rows = 0;
+        QByteArray chunk = reader->read(kExportChunkBytes, &rows);
+        if (formatter) {
+            parser.feed(chunk, records);
+            for (const auto& record : records) {
+                formatter->writeRow(record, out);
+            }
+            records.clear();
+        } else {
+            out = std::move(chunk);
+        }
+        if (!writeOut()) {
+            fail(error);
+            return;
+        }
+        rowsWritten += rows;
+
+        if (elapsed.elapsed() - lastProgressMs >= kImportProgressIntervalMs) {
+            lastProgressMs = elapsed.elapsed();
+            QVariantMap progress;
+            progress["rows"] = (double)rowsWritten;
+            progress["bytesWritten"] = (double)bytesWritten;
+            progress["rowsPerSecond"] = rowsPerSecond();
+            emit exportProgress(requestTag, progress);
+        }
+    }
+    if (!reader->lastError().isEmpty()) {
+        connection.markSuspect();
+        fail(reader->lastError());
         return;
     }
 
-    int total = queryProvider->count(schema, table);
-    if (total != -1) {
-        emit countFinished(requestTag, total);
+    if (formatter) {
+        parser.finish(records);
+        for (const auto& record : records) {
+            formatter->writeRow(record, out);
+        }
+        formatter->finish(out);
+    }
+    if (!writeOut() || !file.commit()) {
+        emit exportError(requestTag, error.isEmpty() ? QString("Cannot write %1: %2").arg(filePath, file.errorString()) : error);
+        return;
+    }
+
+    QVariantMap result;
+    result["rows"] = (double)rowsWritten;
+    result["bytesWritten"] = (double)bytesWritten;
+    result["executionTime"] = (double)elapsed.elapsed();
+    result["rowsPerSecond"] = rowsPerSecond();
+    result["filePath"] = filePath;
+    emit exportFinished(requestTag, result);
+}
+
+bool QueryWorker::runParallelExport(const QVariantMap& connectionInfo, ConnectionPool::Lease& coordinator, const CopySource& source, const QString& defaultTable, const QString& filePath, const ExportOptions& options, const QString& requestTag)
+{
+    auto queryProvider = coordinator->query();
+    QString error;
+    // The coordinator's transaction pins the snapshot until every range adopted it.
+    const QString snapshot = queryProvider->exportSnapshot(&error);
+    if (snapshot.isEmpty()) {
+        qWarning() << "\x1b[33m⚠️ Export\x1b[0m sem snapshot, exportando em uma conexão:" << error;
+        return false;
+    }
+    std::vector<CopySource> ranges = queryProvider->planExportRanges(source, options.parallel);
+    if (ranges.size() < 2) {
+        queryProvider->releaseSnapshot();
+        return false;
+    }
+
+    auto cancelGroup = std::make_unique<CancelHandleGroup>();
+    CancelHandleGroup* cancelHandles = cancelGroup.get();
+    cancelHandles->add(coordinator->cancelHandle());
+    releaseCancelToken();
+    m_cancelToken = std::make_shared<CancelToken>(std::move(cancelGroup));
+    emit cancelTokenReady(requestTag, m_cancelToken);
+    emit exportStarted(requestTag, queryProvider->backendPid());
+
+    // One connection per range, all reading the coordinator's snapshot.
+    std::vector<ConnectionPool::Lease> leases;
+    std::vector<std::unique_ptr<ICopyOutReader>> readers;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        auto lease = acquireConnection(connectionInfo, &error);
+        auto provider = lease ? lease->query() : nullptr;
+        if (!provider) {
+            if (error.isEmpty()) error = "Query provider indisponível.";
+            break;
+        }
+        cancelHandles->add(lease->cancelHandle());
+        ranges[i].snapshot = snapshot;
+        CopyFormat format = CopyFormat::Text;
+        if (options.format == "csv") {
+            format = i == 0 || options.shards ? CopyFormat::Csv : CopyFormat::CsvNoHeader;
+        }
+        auto reader = provider->openCopyOut(ranges[i], format, &error);
+        if (!reader) {
+            lease.markSuspect();
+            break;
+        }
+        readers.push_back(std::move(reader));
+        leases.push_back(std::move(lease));
+    }
+    queryProvider->releaseSnapshot();
+    if (readers.size() != ranges.size()) {
+        for (auto& reader : readers) reader->close();
+        for (auto& lease : leases) lease.markSuspect();
+        emit exportError(requestTag, error);
+        return true;
+    }
+    qInfo() << "\x1b[36m📤 Export\x1b[0m" << readers.size() << "ranges em paralelo";
+
+    // Shards are numbered from 1 next to the requested file.
+    QStringList paths;
+    if (options.shards) {
+        const QFileInfo target(filePath);
+        const QString suffix = target.suffix().isEmpty() ? QString() : "." + target.suffix();
+        for (size_t i = 0; i < readers.size(); ++i) {
+            paths << target.dir().filePath(QString("%1.part%2%3").arg(target.completeBaseName()).arg(i + 1, 3, 10, QChar('0')).arg(suffix));
+        }
+    } else {
+        paths << filePath;
+    }
+    std::vector<std::unique_ptr<QSaveFile>> files;
+    for (const QString& path : paths) {
+        auto file = std::make_unique<QSaveFile>(path);
+        if (!file->open(QIODevice::WriteOnly)) {
+            error = QString("Cannot write %1: %2").arg(path, file->errorString());
+            for (auto& reader : readers) reader->close();
+            emit exportError(requestTag, error);
+            return true;
+        }
+        files.push_back(std::move(file));
+    }
+
+    // Range threads read and format; this thread writes. The queue is bounded,
+    // so a slow disk holds the readers back instead of filling memory.
+    ExportChunkQueue queue(2 * readers.size());
+    ImportOptions textOptions;
+    textOptions.format = "tsv";
+    textOptions.delimiter = '\t';
+    std::vector<QThread*> threads;
+    for (size_t i = 0; i < readers.size(); ++i) {
+        ICopyOutReader* reader = readers[i].get();
+        threads.push_back(QThread::create([&queue, &options, &defaultTable, textOptions, reader, i]() {
+            auto formatter = ExportFormatter::create(options, reader->columns(), defaultTable);
+            DelimitedTextParser parser(textOptions);
+            std::vector<ImportRecord> records;
+            bool stopped = false;
+            while (!reader->atEnd()) {
+                ExportChunk chunk;
+                chunk.range = i;
+                QByteArray data = reader->read(kExportChunkBytes, &chunk.rows);
+                if (formatter) {
+                    parser.feed(data, records);
+                    for (const auto& record : records) {
+                        formatter->writeRow(record, chunk.data);
+                    }
+                    records.clear();
+                } else {
+                    chunk.data = std::move(data);
+                }
+                if (!queue.push(std::move(chunk))) {
+                    stopped = true;
+                    break;
+                }
+            }
+            ExportChunk last;
+            last.range = i;
+            last.last = true;
+            if (stopped) {
+                reader->close();
+            } else {
+                last.error = reader->lastError();
+            }
+            if (formatter && last.error.isEmpty() && !stopped) {
+                parser.finish(records);
+                for (const auto& record : records) {
+                    formatter->writeRow(record, last.data);
+                }
+                formatter->finish(last.data);
+            }
+            queue.push(std::move(last), true);
+        }));
+    }
+    // A merged CSV gets its header from range 0 only, so the other ranges start
+    // once range 0's first chunk is in the file; until then their COPYs wait on
+    // the server instead of piling up here.
+    bool headerWritten = options.format != "csv" || options.shards;
+    for (size_t i = 0; i < threads.size(); ++i) {
+        if (i == 0 || headerWritten) threads[i]->start();
+    }
+
+    long long rowsWritten = 0;
+    qint64 bytesWritten = 0;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    qint64 lastProgressMs = 0;
+    auto rowsPerSecond = [&]() {
+        const qint64 ms = qMax<qint64>(1, elapsed.elapsed());
+        return static_cast<double>(rowsWritten) * 1000.0 / ms;
+    };
+
+    QString failure;
+    auto stop = [&](const QString& message) {
+        if (!failure.isEmpty()) return;
+        failure = message;
+        queue.stop();
+        // Ranges still running are stopped on the server instead of read to the end.
+        cancelHandles->cancel(nullptr);
+    };
+
+    size_t finished = 0;
+    auto consume = [&](const ExportChunk& chunk) {
+        if (failure.isEmpty() && !chunk.data.isEmpty()) {
+            QSaveFile* file = files[options.shards ? chunk.range : 0].get();
+            if (file->write(chunk.data) != chunk.data.size()) {
+                stop(QString("Cannot write %1: %2").arg(file->fileName(), file->errorString()));
+            } else {
+                bytesWritten += chunk.data.size();
+            }
+        }
+        rowsWritten += chunk.rows;
+        if (chunk.last) {
+            ++finished;
+            if (!chunk.error.isEmpty()) stop(chunk.error);
+        }
+    };
+
+    while (finished < readers.size()) {
+        ExportChunk chunk = queue.pop();
+        consume(chunk);
+        if (!headerWritten && (!chunk.data.isEmpty() || chunk.last)) {
+            headerWritten = true;
+            for (size_t i = 1; i < threads.size(); ++i) {
+                threads[i]->start();
+            }
+        }
+
+        if (failure.isEmpty() && elapsed.elapsed() - lastProgressMs >= kImportProgressIntervalMs) {
+            lastProgressMs = elapsed.elapsed();
+            QVariantMap progress;
+            progress["rows"] = (double)rowsWritten;
+            progress["bytesWritten"] = (double)bytesWritten;
+            progress["rowsPerSecond"] = rowsPerSecond();
+            emit exportProgress(requestTag, progress);
+        }
+    }
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    for (const auto& file : files) {
+        if (failure.isEmpty() && !file->commit()) {
+            failure = QString("Cannot write %1: %2").arg(file->fileName(), file->errorString());
+        }
+    }
+    if (!failure.isEmpty()) {
+        for (const auto& file : files) file->cancelWriting();
+        for (auto& lease : leases) lease.markSuspect();
+        emit exportError(requestTag, failure);
+        return true;
+    }
+
+    QVariantMap result;
+    result["rows"] = (double)rowsWritten;
+    result["bytesWritten"] = (double)bytesWritten;
+    result["executionTime"] = (double)elapsed.elapsed();
+    result["rowsPerSecond"] = rowsPerSecond();
+    result["filePath"] = options.shards ? paths.first() : filePath;
+    result["ranges"] = static_cast<int>(readers.size());
+    if (options.shards) {
+        result["files"] = paths;
     }
+    emit exportFinished(requestTag, result);
+    return true;
 }
 
 }
@@ -1,11 +1,19 @@
 #pragma once
 
 #include <QObject>
+#include <QSocketNotifier>
 #include <QVariantMap>
+#include <map>
 #include <memory>
 #include "AddonHost.h"
+#include "CancelToken.h"
+#include "CatalogCache.h"
+#include "ConnectionPool.h"
+#include "DataExport.h"
 #include "addons/IAddon.h"
 
+class QTimer;
+
 namespace Sofa::Core {
 
 class QueryWorker : public QObject {
@@ -13,15 +21,54 @@ class QueryWorker : public QObject {
 public:
     explicit QueryWorker(std::shared_ptr<AddonHost> addonHost, QObject* parent = nullptr);
 
+    // Called on the worker thread once a job returns, before its connection can
+    // serve another request: later cancels of that request become no-ops.
+    void releaseCancelToken();
+
+    // An async worker runs console statements without blocking its thread:
+    // runSql() returns once the query is sent and the result is read from the
+    // event loop, so one thread serves any number of statements at a time.
+    // Set before moving the worker to its thread.
+    void setAsyncIo(bool enabled);
+    // Table schemas and indexes are served from (and stored in) the cache.
+    // Set before moving the worker to its thread.
+    void setCatalogCache(std::shared_ptr<CatalogCache> catalogCache) { m_catalogCache = std::move(catalogCache); }
+    // The explorer's schema lists: hidden schemas left out of the visible list,
+    // "public" first in both.
+    static void schemaLists(ICatalogProvider& catalog, QStringList* visible, QStringList* hidden);
+    static QVariantMap catalogTableToVariant(const CatalogTable& table);
+    // True while runSql() for requestTag has returned but its result is still being read.
+    bool isRunningAsync(const QString& requestTag) const { return m_asyncRuns.count(requestTag) > 0; }
+
 public slots:
-    void runSql(const QVariantMap& connectionInfo, const QString& queryText, const QString& requestTag);
-    void runDataset(const QVariantMap& connectionInfo, const QString& schema, const QString& table, int limit, int offset, const QString& sortColumn, bool sortAscending, const QString& requestTag, const QString& filterClause);
+    void runSql(const QVariantMap& connectionInfo, const QString& queryText, const QString& requestTag, const QueryLimits& limits = QueryLimits());
+    void runDataset(const QVariantMap& connectionInfo, const QString& schema, const QString& table, int limit, int offset, const QString& sortColumn, bool sortAscending, const QString& requestTag, const QString& filterClause, const QString& pagingKey = QString(), const QString& cursor = QString(), bool withCount = false, const QueryLimits& limits = QueryLimits());
     void runTableSchema(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const QString& requestTag);
     void runTableIndexes(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const QString& requestTag);
-    void runCount(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const QString& requestTag);
+    void runCount(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const QString& filterClause, const QString& requestTag);
+    void runSchemas(const QVariantMap& connectionInfo, const QString& requestTag);
+    // Tables stream in tablesBatch signals (the first one has "reset": true).
+    void runTables(const QVariantMap& connectionInfo, const QString& schema, const QString& requestTag);
+    // All indexes of a schema in one catalog query; reported through the
+    // tableIndexes* signals with an empty "table" and a "tables" map.
+    void runSchemaIndexes(const QVariantMap& connectionInfo, const QString& schema, const QString& requestTag);
+    void runCatalogVersion(const QVariantMap& connectionInfo, const QString& requestTag);
+    // Streams a CSV/TSV file into schema.table through IBulkWriter (see DataImport.h for options).
+    void runImport(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const QString& filePath, const QVariantMap& options, const QString& requestTag);
+    // Streams source (sql, or schema + table [+ filter]) to a csv/jsonl/sql file
+    // through ICopyOutReader (see DataExport.h for options).
+    void runExport(const QVariantMap& connectionInfo, const QVariantMap& source, const QString& filePath, const QVariantMap& options, const QString& requestTag);
+    void closePager(const QString& pagingKey);
+    void releaseConnections();
 
 signals:
+    // Precedes the *Started signal of every request that reached a connection
+    // whose driver supports out-of-band cancel.
+    void cancelTokenReady(const QString& requestTag, Sofa::Core::CancelTokenPtr token);
     void sqlStarted(const QString& requestTag, int backendPid);
+    // Streamed results arrive as batches; the first one carries the columns
+    // ("reset": true) and sqlFinished then only reports the totals.
+    void sqlBatch(const QString& requestTag, const QVariantMap& batch);
     void sqlFinished(const QString& requestTag, const QVariantMap& result);
     void sqlError(const QString& requestTag, const QString& error);
     void datasetStarted(const QString& requestTag, int backendPid);
@@ -33,14 +80,82 @@ signals:
     void tableIndexesStarted(const QString& requestTag, int backendPid);
     void tableIndexesFinished(const QString& requestTag, const QVariantMap& result);
     void tableIndexesError(const QString& requestTag, const QString& error);
-    void countFinished(const QString& requestTag, int total);
+    void countStarted(const QString& requestTag, int backendPid);
+    void countFinished(const QString& requestTag, qint64 total);
+    void countError(const QString& requestTag, const QString& error);
+    void schemasStarted(const QString& requestTag, int backendPid);
+    // schemas, hiddenSchemas
+    void schemasFinished(const QString& requestTag, const QVariantMap& result);
+    void schemasError(const QString& requestTag, const QString& error);
+    void tablesStarted(const QString& requestTag, int backendPid);
+    // schema, tables, reset
+    void tablesBatch(const QString& requestTag, const QVariantMap& batch);
+    // schema, count
+    void tablesFinished(const QString& requestTag, const QVariantMap& result);
+    void tablesError(const QString& requestTag, const QString& error);
+    // Empty when the driver has no catalog version or the check failed.
+    void catalogVersionFinished(const QString& requestTag, const QString& version);
+    void importStarted(const QString& requestTag, int backendPid);
+    // rows, bytesRead, totalBytes, rowsPerSecond; at most every 250 ms.
+    void importProgress(const QString& requestTag, const QVariantMap& progress);
+    void importFinished(const QString& requestTag, const QVariantMap& result);
+    void importError(const QString& requestTag, const QString& error);
+    void exportStarted(const QString& requestTag, int backendPid);
+    // rows, bytesWritten, rowsPerSecond; at most every 250 ms.
+    void exportProgress(const QString& requestTag, const QVariantMap& progress);
+    void exportFinished(const QString& requestTag, const QVariantMap& result);
+    void exportError(const QString& requestTag, const QString& error);
 
 private:
-    QVariantMap datasetToVariant(const DatasetPage& page);
+    // A server-side cursor opened for one table tab. The lease keeps the
+    // connection (and its open transaction) out of the pool until it closes.
+    struct PagerSession {
+        ConnectionPool::Lease connection;
+        std::unique_ptr<IDatasetPager> pager;
+        QString signature;
+        qint64 lastUsedMs = 0;
+    };
+
+    // A console statement read from the event loop (async worker only). The
+    // lease keeps its connection out of the pool until the result is complete.
+    struct AsyncSqlRun {
+        ConnectionPool::Lease connection;
+        std::unique_ptr<IAsyncResultCursor> cursor;
+        std::unique_ptr<QSocketNotifier> readNotifier;
+        std::unique_ptr<QSocketNotifier> writeNotifier;
+        CancelTokenPtr cancelToken;
+        int streamed = 0;
+        bool sentColumns = false;
+        bool hasMore = false;
+        QString warning;
+        qint64 executionTimeMs = 0;
+    };
+
+    bool startAsyncSql(ConnectionPool::Lease& connection, IQueryProvider* queryProvider, const QString& queryText, const QString& requestTag, const QueryLimits& limits);
+    void pumpAsyncSql(const QString& requestTag);
+    void finishAsyncSql(const QString& requestTag, const QString& error = QString());
+    bool runParallelExport(const QVariantMap& connectionInfo, ConnectionPool::Lease& coordinator, const CopySource& source, const QString& defaultTable, const QString& filePath, const ExportOptions& options, const QString& requestTag);
+    bool runPagedDataset(const QVariantMap& connectionInfo, const QString& schema, const QString& table, const DatasetRequest& request, const QString& requestTag, const QString& pagingKey);
+    void evictIdlePagers();
+    void armCancelToken(const QString& requestTag, const ConnectionPool::Lease& connection);
+    // Metadata and columns as QVariants; the values stay in the page, handed
+    // out as a DatasetPagePtr under "page".
+    QVariantMap datasetToVariant(DatasetPage page);
+    bool streamSql(IQueryProvider* queryProvider, ConnectionPool::Lease& connection, const QString& queryText, const QString& requestTag, const QueryLimits& limits);
     QVariantMap tableSchemaToVariant(const TableSchema& schema);
     QVariantMap tableIndexesToVariant(const QString& schema, const QString& table, const std::vector<TableIndex>& indexes);
+    // Also sets the session statement_timeout (0 = server default), since a pooled
+    // connection may still carry the timeout of its previous request.
+    ConnectionPool::Lease acquireConnection(const QVariantMap& connectionInfo, QString* error, int statementTimeoutMs = 0);
 
     std::shared_ptr<AddonHost> m_addonHost;
+    ConnectionPool m_pool;
+    QTimer* m_poolSweepTimer = nullptr;
+    std::map<QString, PagerSession> m_pagers;
+    CancelTokenPtr m_cancelToken;
+    bool m_asyncIo = false;
+    std::map<QString, AsyncSqlRun> m_asyncRuns;
+    std::shared_ptr<CatalogCache> m_catalogCache;
 };
 
 }
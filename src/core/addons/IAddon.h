@@ -1,5 +1,8 @@
 #pragma once
 #include <QString>
+#include <QStringList>
+#include <functional>
+#include <map>
 #include <memory>
 #include <vector>
 #include "udm/UDM.h"
@@ -24,17 +27,182 @@ public:
     virtual std::vector<QString> listSchemas() = 0;
     virtual std::vector<QString> listHiddenSchemas() { return {}; }
     virtual std::vector<CatalogTable> listTables(const QString& schema) = 0;
+    // listTables in batches of at most batchSize, handed out as rows are read;
+    // onBatch returns false to stop. Returns false when the listing failed.
+    virtual bool streamTables(const QString& schema, int batchSize, const std::function<bool(std::vector<CatalogTable>&)>& onBatch)
+    {
+        std::vector<CatalogTable> tables = listTables(schema);
+        const size_t step = batchSize > 0 ? static_cast<size_t>(batchSize) : tables.size();
+        for (size_t first = 0; first < tables.size(); first += step) {
+            std::vector<CatalogTable> batch(tables.begin() + first, tables.begin() + qMin(tables.size(), first + step));
+            if (!onBatch(batch)) {
+                break;
+            }
+        }
+        return true;
+    }
     virtual TableSchema getTableSchema(const QString& schema, const QString& table) = 0;
-    virtual std::vector<TableIndex> getTableIndexes(const QString& schema, const QString& table) { (void)schema; (void)table; return {}; }
+    // A failed read sets error (an empty result alone means "no indexes").
+    virtual std::vector<TableIndex> getTableIndexes(const QString& schema, const QString& table, QString* error = nullptr) { (void)schema; (void)table; (void)error; return {}; }
+    // Indexes of every table in the schema, by table name (tables without
+    // indexes are absent). Drivers should answer in one round trip.
+    virtual std::map<QString, std::vector<TableIndex>> getSchemaIndexes(const QString& schema, QString* error = nullptr)
+    {
+        std::map<QString, std::vector<TableIndex>> indexes;
+        for (const auto& table : listTables(schema)) {
+            QString tableError;
+            auto tableIndexes = getTableIndexes(schema, table.name, &tableError);
+            if (!tableError.isEmpty()) {
+                if (error) *error = tableError;
+                return {};
+            }
+            if (!tableIndexes.empty()) {
+                indexes[table.name] = std::move(tableIndexes);
+            }
+        }
+        return indexes;
+    }
+    // Cheap token that changes whenever the catalog does (DDL); empty when the
+    // driver has none. Polled to drop cached metadata after outside changes.
+    virtual QString catalogVersion() { return QString(); }
+};
+
+// Pull-based access to a running result. Rows are handed out in batches so the
+// caller can show the first ones early and stop reading without the driver
+// buffering the whole result.
+class IResultCursor {
+public:
+    virtual ~IResultCursor() = default;
+    virtual const std::vector<Column>& columns() const = 0;
+    // Returns at most batchSize rows. Errors are reported in DatasetPage::warning;
+    // hasMore is false once the result is exhausted.
+    virtual DatasetPage fetchNext(int batchSize) = 0;
+    virtual bool atEnd() const = 0;
+    // Stops the statement if it is still producing rows and frees the connection.
+    virtual void close() = 0;
+};
+
+// A cursor that never blocks: fetchNext() only hands out rows that already
+// arrived. The caller watches socket() in its event loop and calls poll()
+// when it is readable (or writable while wantsWrite()), then fetchNext().
+class IAsyncResultCursor : public IResultCursor {
+public:
+    virtual qintptr socket() const = 0;
+    virtual bool wantsWrite() const = 0;
+    // Sends pending output and reads whatever arrived; false when the
+    // connection failed (the error comes with the next fetchNext()).
+    virtual bool poll() = 0;
+};
+
+// Loads rows into one table in bulk (COPY ... FROM STDIN for Postgres).
+// Values are text as read from the source; a null QVariant is NULL. The load
+// is a single statement: nothing is visible before finish(), and an error or
+// abort() discards everything written so far.
+class IBulkWriter {
+public:
+    virtual ~IBulkWriter() = default;
+    virtual bool writeRows(const std::vector<std::vector<QVariant>>& rows) = 0;
+    // Ends the load; returns the number of rows stored, or -1 (see lastError()).
+    virtual long long finish() = 0;
+    virtual void abort(const QString& reason) = 0;
+    virtual QString lastError() const = 0;
+};
+
+// What an export reads: arbitrary SQL (a single SELECT), or a table with an
+// optional filter (same syntax as DatasetRequest::filter).
+struct CopySource {
+    QString sql;
+    QString schema;
+    QString table;
+    QString filter;
+    // Snapshot from IQueryProvider::exportSnapshot() the COPY must read, so
+    // several connections see the same data; empty = the statement's own.
+    QString snapshot;
+};
+
+enum class CopyFormat {
+    Csv,         // CSV with a header line, ready to be written as is
+    CsvNoHeader, // CSV rows only, for ranges appended after another range's output
+    Text         // tab-separated, \N for NULL, backslash escapes (one line per row)
+};
+
+// Streams a result as raw COPY data (COPY ... TO STDOUT for Postgres), so rows
+// are never decoded into a DatasetPage. Once open, read() and close() only
+// touch the driver's own session handle and may run on another thread.
+class ICopyOutReader {
+public:
+    virtual ~ICopyOutReader() = default;
+    // Result columns (names and types), known before the first read().
+    virtual const std::vector<Column>& columns() const = 0;
+    // Whole rows, at most about maxBytes; rows gets how many. Empty once done
+    // or failed (see lastError()).
+    virtual QByteArray read(qsizetype maxBytes, int* rows) = 0;
+    virtual bool atEnd() const = 0;
+    virtual QString lastError() const = 0;
+    // Stops the statement if it is still producing rows.
+    virtual void close() = 0;
+};
+
+// Pages through one table query with a server-side cursor that stays open on
+// a dedicated connection, so a page costs the same no matter how deep it is.
+class IDatasetPager {
+public:
+    virtual ~IDatasetPager() = default;
+    virtual DatasetPage fetchPage(int offset, int limit) = 0;
+    virtual void close() = 0;
 };
 
 class IQueryProvider {
 public:
     virtual ~IQueryProvider() = default;
     virtual DatasetPage execute(const QString& query, const DatasetRequest& request) = 0;
+    // Streaming alternative to execute(); nullptr when the driver can't stream.
+    // The connection stays busy until the cursor is closed or destroyed.
+    // When limits.maxRows/maxBytes is reached the cursor stops reading, closes
+    // the statement and names the limit in DatasetPage::warning.
+    virtual std::unique_ptr<IResultCursor> openCursor(const QString& query, const QueryLimits& limits = QueryLimits()) { (void)query; (void)limits; return nullptr; }
+    // Starts a bulk load into columns of schema.table; nullptr when unsupported
+    // or the load could not start. The connection is busy until finish()/abort().
+    virtual std::unique_ptr<IBulkWriter> openBulkWriter(const QString& schema, const QString& table, const QStringList& columns, QString* error) { (void)schema; (void)table; (void)columns; if (error) *error = "Bulk import is not supported by this driver"; return nullptr; }
+    // Starts COPY of the source to the client; nullptr (and error) when unsupported
+    // or the statement was rejected. The connection is busy until the reader closes.
+    virtual std::unique_ptr<ICopyOutReader> openCopyOut(const CopySource& source, CopyFormat format, QString* error) { (void)source; (void)format; if (error) *error = "Export is not supported by this driver"; return nullptr; }
+    // Splits a table source into at most `parts` sources that together return
+    // the same rows and can be read on separate connections. Empty when the
+    // source can't (or is too small to) be split.
+    virtual std::vector<CopySource> planExportRanges(const CopySource& source, int parts) { (void)source; (void)parts; return {}; }
+    // Opens a read-only transaction on this connection and returns a snapshot id
+    // other connections can read (CopySource::snapshot) until releaseSnapshot().
+    virtual QString exportSnapshot(QString* error) { if (error) *error = "Snapshots are not supported by this driver"; return QString(); }
+    virtual void releaseSnapshot() {}
+    // Non-blocking variant of openCursor(): returns right after sending the query.
+    virtual std::unique_ptr<IAsyncResultCursor> openAsyncCursor(const QString& query, const QueryLimits& limits = QueryLimits()) { (void)query; (void)limits; return nullptr; }
     virtual DatasetPage getDataset(const QString& schema, const QString& table, const DatasetRequest& request) = 0;
+    // Optional cursor-based alternative to getDataset(); nullptr when unsupported or on failure.
+    // request.limit/offset are ignored: they are passed per page to fetchPage().
+    virtual std::unique_ptr<IDatasetPager> openPager(const QString& schema, const QString& table, const DatasetRequest& request) { (void)schema; (void)table; (void)request; return nullptr; }
     virtual int count(const QString& schema, const QString& table) { return -1; }
+    // Estimated must answer from statistics without scanning; Exact may take as
+    // long as a full scan and is expected to run in the background.
+    virtual RowCount countRows(const QString& schema, const QString& table, const QString& filter, CountStrategy strategy) {
+        RowCount result;
+        if (strategy == CountStrategy::Exact && filter.trimmed().isEmpty()) {
+            result.total = count(schema, table);
+        }
+        return result;
+    }
     virtual int backendPid() { return -1; }
+    // Session-level statement timeout for every following statement; 0 restores
+    // the server default. Returns false when unsupported or rejected.
+    virtual bool setStatementTimeout(int timeoutMs) { (void)timeoutMs; return false; }
+};
+
+// Interrupts whatever statement the connection it was taken from is running.
+// Must be callable from a thread other than the one using the connection.
+class ICancelHandle {
+public:
+    virtual ~ICancelHandle() = default;
+    virtual bool cancel(QString* error) = 0;
 };
 
 class IConnectionProvider {
@@ -47,11 +215,18 @@ public:
     virtual void close() = 0;
     virtual bool isOpen() const = 0;
     virtual QString lastError() const = 0;
+    // Cheap liveness probe used before reusing a pooled connection.
+    virtual bool ping() { return isOpen(); }
+    // Called when a pooled connection is given back: ends any transaction the
+    // last user left open. False when the session cannot be reused.
+    virtual bool resetForReuse() { return isOpen(); }
 
     // Access to capabilities
     virtual std::shared_ptr<ICatalogProvider> catalog() = 0;
     virtual std::shared_ptr<IQueryProvider> query() = 0;
     virtual bool cancelQuery(int backendPid) { (void)backendPid; return false; }
+    // Out-of-band cancel for this connection's current statement; nullptr when unsupported.
+    virtual std::unique_ptr<ICancelHandle> cancelHandle() { return nullptr; }
 };
 
 }
@@ -0,0 +1,107 @@
+// Times CatalogSearchIndex::search keystroke by keystroke on a synthetic
+// catalog of about 100k objects (10k tables with 8 columns and an index each).
+//
+//   sofa-catalog-search-bench [budget-ms]
+//
+// Every prefix of each query is searched in order, as the palette does while
+// typing; each sequence is repeated and the median and worst time per
+// keystroke are printed. Exits with 1 when a keystroke's median is over the
+// budget (default 1 ms).
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+#include "CatalogSearchIndex.h"
+
+using namespace Sofa::Core;
+
+namespace {
+
+constexpr int kSchemas = 50;
+constexpr int kTablesPerSchema = 200;
+constexpr int kColumnsPerTable = 8;
+constexpr int kRepeats = 21;
+constexpr int kLimit = 50;
+
+const QStringList kWords = {
+    "user", "account", "order", "item", "invoice", "payment", "customer", "product", "stock",
+    "shipment", "address", "event", "audit", "log", "session", "token", "price", "tax", "line",
+    "batch", "report", "metric", "daily", "history", "archive", "tenant", "role", "grant",
+};
+
+const QStringList kQueries = {
+    "user_id", "ordit", "invoice.line", "pay", "s12.order", "ix_cust", "acctok", "zzzq",
+};
+
+QString randomName(std::mt19937& random, int words)
+{
+    QStringList parts;
+    for (int i = 0; i < words; ++i) {
+        parts << kWords[random() % kWords.size()];
+    }
+    return parts.join('_');
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    QTextStream out(stdout);
+    const double budgetMs = argc > 1 ? QString::fromLocal8Bit(argv[1]).toDouble() : 1.0;
+
+    CatalogSearchIndex index;
+    std::mt19937 random(42);
+    QElapsedTimer timer;
+    timer.start();
+    for (int s = 0; s < kSchemas; ++s) {
+        const QString schema = QString("s%1_%2").arg(s).arg(kWords[s % kWords.size()]);
+        QStringList tables;
+        for (int t = 0; t < kTablesPerSchema; ++t) {
+            tables << QString("%1_%2").arg(randomName(random, 2)).arg(t);
+        }
+        index.beginTables(schema);
+        index.addTables(schema, tables);
+        index.endTables(schema);
+        for (const QString& table : std::as_const(tables)) {
+            QStringList columns { "id" };
+            for (int c = 1; c < kColumnsPerTable; ++c) {
+                columns << (c % 3 == 0 ? randomName(random, 1) + "_id" : randomName(random, 1 + c % 2));
+            }
+            index.setColumns(schema, table, columns);
+            index.setIndexes(schema, table, { "ix_" + table + "_" + columns[1] });
+        }
+    }
+    out << "objects: " << index.size() << " (built in " << timer.elapsed() << " ms)\n";
+    out << "budget: " << budgetMs << " ms per keystroke\n\n";
+
+    bool overBudget = false;
+    for (const QString& query : kQueries) {
+        // samples[k]: times of the search for the first k + 1 characters.
+        std::vector<std::vector<double>> samples(query.size());
+        std::vector<int> matches(query.size());
+        for (int repeat = 0; repeat < kRepeats; ++repeat) {
+            for (int k = 0; k < query.size(); ++k) {
+                timer.restart();
+                const auto results = index.search(query.left(k + 1), kLimit);
+                samples[k].push_back(timer.nsecsElapsed() / 1e6);
+                matches[k] = static_cast<int>(results.size());
+            }
+        }
+        out << query << "\n";
+        for (int k = 0; k < query.size(); ++k) {
+            std::sort(samples[k].begin(), samples[k].end());
+            const double median = samples[k][samples[k].size() / 2];
+            const bool over = median > budgetMs;
+            overBudget = overBudget || over;
+            out << "  " << qSetFieldWidth(14) << Qt::left << query.left(k + 1) << qSetFieldWidth(0)
+                << " median " << QString::number(median, 'f', 3) << " ms  worst "
+                << QString::number(samples[k].back(), 'f', 3) << " ms  results " << matches[k]
+                << (over ? "  OVER BUDGET" : "") << "\n";
+        }
+    }
+    return overBudget ? 1 : 0;
+}
@@ -0,0 +1,172 @@
+// Unit tests for the SofaCore pieces that need no database: the CSV/TSV
+// reader behind imports (TSV being Postgres' COPY text format) and
+// ColumnData's null handling.
+//
+//   cmake -DSOFA_BUILD_TESTS=ON ... && ctest -R sofa-core-test
+
+#include <QtTest>
+#include "DataImport.h"
+#include "udm/UDM.h"
+
+using namespace Sofa::Core;
+
+namespace {
+
+std::vector<ImportRecord> parse(const QByteArray& data, const QString& format, int chunkBytes = 0)
+{
+    ImportOptions options;
+    options.format = format;
+    options.delimiter = format == "tsv" ? '\t' : ',';
+    DelimitedTextParser parser(options);
+    std::vector<ImportRecord> records;
+    const int step = chunkBytes > 0 ? chunkBytes : static_cast<int>(data.size());
+    for (qsizetype offset = 0; offset < data.size(); offset += step) {
+        parser.feed(data.mid(offset, step), records);
+    }
+    parser.finish(records);
+    return records;
+}
+
+}
+
+class CoreTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void copyTextEscapes_data();
+    void copyTextEscapes();
+    void csvNullsAndQuotes();
+    void nullsBeforeFirstValue();
+    void nullsBeforeFirstText();
+    void nullsKeptWhenWidened();
+    void boolNullsAcrossWords();
+};
+
+void CoreTest::copyTextEscapes_data()
+{
+    QTest::addColumn<int>("chunkBytes");
+    QTest::newRow("whole") << 0;
+    // One byte at a time: every escape is split from its backslash.
+    QTest::newRow("byte by byte") << 1;
+}
+
+void CoreTest::copyTextEscapes()
+{
+    QFETCH(int, chunkBytes);
+    const QByteArray data = "a\\tb\t\\N\tx\\\\y\n"
+                            "l1\\nl2\t\\b\\f\\v\t\\r\n"
+                            "\\\\N\t\tlast";
+    const auto records = parse(data, "tsv", chunkBytes);
+    QCOMPARE(records.size(), size_t(3));
+
+    QCOMPARE(records[0].size(), size_t(3));
+    QCOMPARE(records[0][0].toString(), QString("a\tb"));
+    QVERIFY(records[0][1].isNull());
+    QCOMPARE(records[0][2].toString(), QString("x\\y"));
+
+    QCOMPARE(records[1][0].toString(), QString("l1\nl2"));
+    QCOMPARE(records[1][1].toString(), QString("\b\f\v"));
+    QCOMPARE(records[1][2].toString(), QString("\r"));
+
+    // An escaped backslash before N is text, and an empty field is an empty string.
+    QCOMPARE(records[2][0].toString(), QString("\\N"));
+    QVERIFY(!records[2][1].isNull());
+    QCOMPARE(records[2][1].toString(), QString());
+    // No trailing newline: finish() flushes the record.
+    QCOMPARE(records[2][2].toString(), QString("last"));
+}
+
+void CoreTest::csvNullsAndQuotes()
+{
+    const auto records = parse("a,,\"\"\r\n\"x,\"\"y\"\"\",z\n\n", "csv");
+    QCOMPARE(records.size(), size_t(2));
+    QCOMPARE(records[0][0].toString(), QString("a"));
+    QVERIFY(records[0][1].isNull());
+    QVERIFY(!records[0][2].isNull());
+    QCOMPARE(records[0][2].toString(), QString());
+    QCOMPARE(records[1][0].toString(), QString("x,\"y\""));
+    QCOMPARE(records[1][1].toString(), QString("z"));
+}
+
+void CoreTest::nullsBeforeFirstValue()
+{
+    ColumnData column;
+    column.appendNull();
+    column.appendNull();
+    QCOMPARE(column.storage(), ColumnData::Storage::Unset);
+    column.appendInt64(7);
+    column.appendNull();
+
+    QCOMPARE(column.storage(), ColumnData::Storage::Int64);
+    QCOMPARE(column.size(), 4);
+    QVERIFY(column.isNull(0));
+    QVERIFY(column.isNull(1));
+    QVERIFY(!column.isNull(2));
+    QVERIFY(column.isNull(3));
+    QVERIFY(!column.value(0).isValid());
+    QCOMPARE(column.value(2), QVariant(qlonglong(7)));
+    QCOMPARE(column.int64At(2), qint64(7));
+    QVERIFY(!column.value(4).isValid());
+}
+
+void CoreTest::nullsBeforeFirstText()
+{
+    ColumnData column;
+    column.appendNull();
+    const QByteArray utf8 = QString("héllo").toUtf8();
+    column.appendUtf8(utf8.constData(), static_cast<int>(utf8.size()));
+    column.appendNull();
+    column.appendText(u"x");
+
+    QCOMPARE(column.storage(), ColumnData::Storage::Text);
+    QVERIFY(column.isNull(0));
+    QCOMPARE(column.textAt(1).toString(), QString("héllo"));
+    QVERIFY(column.isNull(2));
+    QCOMPARE(column.textAt(3).toString(), QString("x"));
+    QVERIFY(!column.value(2).isValid());
+}
+
+void CoreTest::nullsKeptWhenWidened()
+{
+    ColumnData column;
+    column.appendInt64(1);
+    column.appendNull();
+    column.appendValue(QString("two"));
+    column.appendValue(QVariant());
+
+    QCOMPARE(column.storage(), ColumnData::Storage::Variant);
+    QCOMPARE(column.size(), 4);
+    QCOMPARE(column.value(0), QVariant(qlonglong(1)));
+    QVERIFY(column.isNull(1));
+    QVERIFY(!column.value(1).isValid());
+    QCOMPARE(column.value(2), QVariant(QString("two")));
+    QVERIFY(column.isNull(3));
+}
+
+void CoreTest::boolNullsAcrossWords()
+{
+    // More than two 64-row words of validity and bool bits.
+    ColumnData column;
+    constexpr int kRows = 150;
+    for (int row = 0; row < kRows; ++row) {
+        if (row % 3 == 0) {
+            column.appendNull();
+        } else {
+            column.appendBool(row % 2 == 0);
+        }
+    }
+    QCOMPARE(column.storage(), ColumnData::Storage::Bool);
+    QCOMPARE(column.size(), kRows);
+    for (int row = 0; row < kRows; ++row) {
+        if (row % 3 == 0) {
+            QVERIFY(column.isNull(row));
+            QVERIFY(!column.value(row).isValid());
+        } else {
+            QVERIFY(!column.isNull(row));
+            QCOMPARE(column.boolAt(row), row % 2 == 0);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(CoreTest)
+#include "CoreTest.moc"
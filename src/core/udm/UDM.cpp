@@ -0,0 +1,290 @@
+#include "UDM.h"
+#include <QStringDecoder>
+#include <utility>
+
+namespace Sofa::Core {
+
+ColumnData::Storage ColumnData::storageFor(int metaTypeId)
+{
+    switch (metaTypeId) {
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::SChar:
+    case QMetaType::UChar:
+        return Storage::Int64;
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return Storage::Double;
+    case QMetaType::Bool:
+        return Storage::Bool;
+    case QMetaType::QString:
+        return Storage::Text;
+    default:
+        return Storage::Variant;
+    }
+}
+
+QStringView ColumnData::textAt(int row) const
+{
+    const qsizetype start = row == 0 ? 0 : m_textEnds[row - 1];
+    return QStringView(m_text).mid(start, m_textEnds[row] - start);
+}
+
+QVariant ColumnData::value(int row) const
+{
+    if (row < 0 || row >= m_size || isNull(row)) {
+        return QVariant();
+    }
+    switch (m_storage) {
+    case Storage::Int64:
+        return static_cast<qlonglong>(m_ints[row]);
+    case Storage::Double:
+        return m_doubles[row];
+    case Storage::Bool:
+        return boolAt(row);
+    case Storage::Text:
+        return textAt(row).toString();
+    case Storage::Variant:
+        return m_variants[row];
+    case Storage::Unset:
+    default:
+        return QVariant();
+    }
+}
+
+void ColumnData::reserve(int rows)
+{
+    m_validity.reserve((rows + 63) / 64);
+    switch (m_storage) {
+    case Storage::Int64:
+        m_ints.reserve(rows);
+        break;
+    case Storage::Double:
+        m_doubles.reserve(rows);
+        break;
+    case Storage::Bool:
+        m_bools.reserve((rows + 63) / 64);
+        break;
+    case Storage::Text:
+        m_textEnds.reserve(rows);
+        break;
+    case Storage::Variant:
+        m_variants.reserve(rows);
+        break;
+    case Storage::Unset:
+        break;
+    }
+}
+
+void ColumnData::pushValidity(bool valid)
+{
+    if ((m_size & 63) == 0) {
+        m_validity.push_back(0);
+    }
+    if (valid) {
+        m_validity.back() |= quint64(1) << (m_size & 63);
+    }
+    ++m_size;
+}
+
+void ColumnData::settle(Storage storage)
+{
+    // Rows so far were all NULL; give them their slots in the new buffer.
+    m_storage = storage;
+    switch (storage) {
+    case Storage::Int64:
+        m_ints.assign(m_size, 0);
+        break;
+    case Storage::Double:
+        m_doubles.assign(m_size, 0.0);
+        break;
+    case Storage::Bool:
+        m_bools.assign((m_size + 63) / 64, 0);
+        break;
+    case Storage::Text:
+        m_textEnds.assign(m_size, 0);
+        break;
+    case Storage::Variant:
+        m_variants.assign(m_size, QVariant());
+        break;
+    case Storage::Unset:
+        break;
+    }
+}
+
+void ColumnData::widen()
+{
+    std::vector<QVariant> variants;
+    variants.reserve(m_size);
+    for (int row = 0; row < m_size; ++row) {
+        variants.push_back(value(row));
+    }
+    std::vector<qint64>().swap(m_ints);
+    std::vector<double>().swap(m_doubles);
+    std::vector<quint64>().swap(m_bools);
+    std::vector<qsizetype>().swap(m_textEnds);
+    m_text = QString();
+    m_variants = std::move(variants);
+    m_storage = Storage::Variant;
+}
+
+void ColumnData::appendNull()
+{
+    switch (m_storage) {
+    case Storage::Int64:
+        m_ints.push_back(0);
+        break;
+    case Storage::Double:
+        m_doubles.push_back(0.0);
+        break;
+    case Storage::Bool:
+        if ((m_size & 63) == 0) {
+            m_bools.push_back(0);
+        }
+        break;
+    case Storage::Text:
+        m_textEnds.push_back(m_text.size());
+        break;
+    case Storage::Variant:
+        m_variants.emplace_back();
+        break;
+    case Storage::Unset:
+        break;
+    }
+    pushValidity(false);
+}
+
+void ColumnData::appendInt64(qint64 value)
+{
+    if (m_storage == Storage::Unset) {
+        settle(Storage::Int64);
+    }
+    if (m_storage != Storage::Int64) {
+        appendValue(static_cast<qlonglong>(value));
+        return;
+    }
+    m_ints.push_back(value);
+    pushValidity(true);
+}
+
+void ColumnData::appendDouble(double value)
+{
+    if (m_storage == Storage::Unset) {
+        settle(Storage::Double);
+    }
+    if (m_storage != Storage::Double) {
+        appendValue(value);
+        return;
+    }
+    m_doubles.push_back(value);
+    pushValidity(true);
+}
+
+void ColumnData::appendBool(bool value)
+{
+    if (m_storage == Storage::Unset) {
+        settle(Storage::Bool);
+    }
+    if (m_storage != Storage::Bool) {
+        appendValue(value);
+        return;
+    }
+    if ((m_size & 63) == 0) {
+        m_bools.push_back(0);
+    }
+    if (value) {
+        m_bools.back() |= quint64(1) << (m_size & 63);
+    }
+    pushValidity(true);
+}
+
+void ColumnData::appendText(QStringView value)
+{
+    if (m_storage == Storage::Unset) {
+        settle(Storage::Text);
+    }
+    if (m_storage != Storage::Text) {
+        appendValue(value.toString());
+        return;
+    }
+    m_text.append(value);
+    m_textEnds.push_back(m_text.size());
+    pushValidity(true);
+}
+
+void ColumnData::appendUtf8(const char* data, int length)
+{
+    if (m_storage == Storage::Unset) {
+        settle(Storage::Text);
+    }
+    if (m_storage != Storage::Text) {
+        appendValue(QString::fromUtf8(data, length));
+        return;
+    }
+    // Decoded straight into the blob: UTF-16 never needs more units than UTF-8 bytes.
+    const qsizetype start = m_text.size();
+    m_text.resize(start + length);
+    QStringDecoder decoder(QStringDecoder::Utf8, QStringDecoder::Flag::Stateless);
+    const QChar* end = decoder.appendToBuffer(m_text.data() + start, QByteArrayView(data, length));
+    m_text.resize(end - m_text.constData());
+    m_textEnds.push_back(m_text.size());
+    pushValidity(true);
+}
+
+void ColumnData::appendValue(const QVariant& value)
+{
+    if (value.isNull()) {
+        appendNull();
+        return;
+    }
+    const Storage wanted = storageFor(value.typeId());
+    if (m_storage == Storage::Unset) {
+        settle(wanted);
+    } else if (m_storage != Storage::Variant && m_storage != wanted) {
+        widen();
+    }
+    switch (m_storage) {
+    case Storage::Int64:
+        appendInt64(value.toLongLong());
+        break;
+    case Storage::Double:
+        appendDouble(value.toDouble());
+        break;
+    case Storage::Bool:
+        appendBool(value.toBool());
+        break;
+    case Storage::Text:
+        appendText(value.toString());
+        break;
+    case Storage::Variant:
+    case Storage::Unset:
+        m_variants.push_back(value);
+        pushValidity(true);
+        break;
+    }
+}
+
+int DatasetPage::rowCount() const
+{
+    return isColumnar() ? columnData.front().size() : static_cast<int>(rows.size());
+}
+
+QVariant DatasetPage::value(int row, int column) const
+{
+    if (isColumnar()) {
+        if (column < 0 || column >= static_cast<int>(columnData.size())) {
+            return QVariant();
+        }
+        return columnData[column].value(row);
+    }
+    if (row < 0 || row >= static_cast<int>(rows.size())) {
+        return QVariant();
+    }
+    const auto& values = rows[row];
+    return column >= 0 && column < static_cast<int>(values.size()) ? values[column] : QVariant();
+}
+
+}
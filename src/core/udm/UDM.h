@@ -1,9 +1,12 @@
 #pragma once
+#include <QMetaType>
 #include <QString>
 #include <QStringList>
+#include <QStringView>
 #include <QVariant>
 #include <vector>
 #include <map>
+#include <memory>
 
 namespace Sofa::Core {
 
@@ -35,6 +38,7 @@ struct Column {
 struct TableSchema {
     QString schema;
     QString name;
+    quint32 oid = 0; // driver object id (pg_class OID for Postgres); 0 when unknown
     QString primaryKeyConstraintName;
     std::vector<Column> columns;
 };
@@ -57,7 +61,29 @@ struct TableIndex {
 
 struct CatalogTable {
     QString name;
+    quint32 oid = 0;
     bool hasPrimaryKey = false;
+    QString kind;                // driver relation kind (Postgres relkind: r, p, v, f)
+    long long estimatedRows = -1;  // planner statistics; -1 when unknown
+    long long estimatedBytes = -1; // -1 when unknown or not stored (views)
+};
+
+enum class CountStrategy {
+    Estimated, // planner statistics only, never scans the table
+    Exact
+};
+
+struct RowCount {
+    long long total = -1; // -1 when unknown
+    bool estimated = false;
+};
+
+// Guards against runaway queries. 0 means no limit (for the timeout: the
+// server/role default).
+struct QueryLimits {
+    int statementTimeoutMs = 0;
+    long long maxRows = 0;
+    long long maxBytes = 0; // raw value bytes received, before decoding to QVariant
 };
 
 struct DatasetRequest {
@@ -68,15 +94,93 @@ struct DatasetRequest {
     QString sortColumn;
     bool sortAscending = true;
     QString filter;
+    bool withCount = false; // also fill DatasetPage::totalRows with an estimate (filter applied)
+    QueryLimits limits;
+};
+
+// One result column stored column-major: a typed buffer plus a validity
+// bitmap, instead of a QVariant per cell. Null rows keep their slot in the
+// buffer so row i is always at index i.
+//
+// A column created as Unset takes the storage of its first non-null value.
+// A value the storage can't hold (a string in an Int64 column, say) moves the
+// whole column to Variant storage, so appendValue() never loses data.
+class ColumnData {
+public:
+    enum class Storage : quint8 {
+        Unset,
+        Int64,
+        Double,
+        Bool,
+        Text,   // UTF-16 blob with one end offset per row
+        Variant // anything else (dates, bytes, ...)
+    };
+
+    explicit ColumnData(Storage storage = Storage::Unset) : m_storage(storage) {}
+
+    // Storage that holds values of this QMetaType id without conversion.
+    static Storage storageFor(int metaTypeId);
+
+    Storage storage() const { return m_storage; }
+    int size() const { return m_size; }
+    bool isNull(int row) const { return !((m_validity[row >> 6] >> (row & 63)) & 1); }
+
+    // Typed reads; only meaningful for a non-null row of the matching storage.
+    qint64 int64At(int row) const { return m_ints[row]; }
+    double doubleAt(int row) const { return m_doubles[row]; }
+    bool boolAt(int row) const { return (m_bools[row >> 6] >> (row & 63)) & 1; }
+    QStringView textAt(int row) const;
+    // Any storage; an invalid QVariant for NULL.
+    QVariant value(int row) const;
+
+    void reserve(int rows);
+    void appendNull();
+    void appendInt64(qint64 value);
+    void appendDouble(double value);
+    void appendBool(bool value);
+    void appendText(QStringView value);
+    void appendUtf8(const char* data, int length);
+    void appendValue(const QVariant& value);
+
+private:
+    void pushValidity(bool valid);
+    void settle(Storage storage);
+    void widen();
+
+    Storage m_storage = Storage::Unset;
+    int m_size = 0;
+    std::vector<quint64> m_validity;
+    std::vector<qint64> m_ints;
+    std::vector<double> m_doubles;
+    std::vector<quint64> m_bools;
+    std::vector<qsizetype> m_textEnds;
+    QString m_text;
+    std::vector<QVariant> m_variants;
 };
 
 struct DatasetPage {
     std::vector<Column> columns; // Schema for this dataset
+    // Values row by row, or column by column in columnData (one entry per
+    // column) when the producer builds a columnar page; never both. Read them
+    // through rowCount()/value() to accept either.
     std::vector<std::vector<QVariant>> rows;
+    std::vector<ColumnData> columnData;
     QString nextCursor;
     bool hasMore = false;
     QString warning; // warnings from DB
     long long executionTimeMs = 0;
+    long long totalRows = -1; // only when DatasetRequest::withCount was set
+    bool totalRowsEstimated = false;
+
+    bool isColumnar() const { return !columnData.empty(); }
+    int rowCount() const;
+    QVariant value(int row, int column) const;
 };
 
+// A finished page handed from a worker to the GUI thread: immutable, so every
+// holder (the result map, QML, DataGridEngine) shares the same values.
+using DatasetPagePtr = std::shared_ptr<const DatasetPage>;
+
 }
+
+Q_DECLARE_METATYPE(Sofa::Core::DatasetPagePtr)
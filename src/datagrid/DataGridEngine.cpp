@@ -3,11 +3,160 @@
 #include <QStringList>
 #include <QVariantList>
 #include <QJsonValue>
+#include <QCollator>
+#include <QDate>
+#include <QDateTime>
+#include <QTime>
 #include <QDebug>
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
 
 namespace Sofa::DataGrid {
 namespace {
+QVariant cellFromVariant(const QVariant& val, bool isNull)
+{
+    if (isNull) {
+        return QVariant();
+    }
+    if (val.userType() == QMetaType::QJsonValue) {
+        QJsonValue jv = val.toJsonValue();
+        if (jv.isNull() || jv.isUndefined()) {
+            return QVariant();
+        }
+        return jv.toVariant();
+    }
+    return val;
+}
+
+bool isNumberType(int typeId)
+{
+    switch (typeId) {
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isIntegerType(int typeId)
+{
+    switch (typeId) {
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+        return true;
+    default:
+        return false;
+    }
+}
+
+template <typename T>
+int compareOrdered(const T& a, const T& b)
+{
+    return (b < a) - (a < b);
+}
+
+// NaN sorts after every number and equal to itself, so the order stays total.
+int compareDoubles(double a, double b)
+{
+    if (std::isnan(a) || std::isnan(b)) {
+        return compareOrdered(std::isnan(a), std::isnan(b));
+    }
+    return compareOrdered(a, b);
+}
+
+// Exact order of an integer against a double: converting the integer would
+// round it above 2^53 and make it equal to doubles it is not equal to.
+template <typename Int>
+int compareIntegerToDouble(Int value, double number)
+{
+    // Int covers [lowest, end); both bounds are exact as doubles.
+    const double end = std::ldexp(1.0, std::numeric_limits<Int>::digits);
+    const double lowest = std::numeric_limits<Int>::is_signed ? -end : 0.0;
+    if (std::isnan(number) || number >= end) return -1;
+    if (number < lowest) return 1;
+    const double whole = std::floor(number);
+    const Int wholeValue = static_cast<Int>(whole);
+    if (value != wholeValue) {
+        return compareOrdered(value, wholeValue);
+    }
+    return whole < number ? -1 : 0;
+}
+
+int compareIntegerVariantToDouble(const QVariant& value, double number)
+{
+    if (value.typeId() == QMetaType::ULongLong) {
+        return compareIntegerToDouble(value.toULongLong(), number);
+    }
+    return compareIntegerToDouble(value.toLongLong(), number);
+}
+
+// Numbers by exact value, whatever mix of integer and floating-point types.
+int compareNumbers(const QVariant& a, const QVariant& b)
+{
+    const bool integerA = isIntegerType(a.typeId());
+    const bool integerB = isIntegerType(b.typeId());
+    if (integerA && integerB) {
+        const bool unsignedA = a.typeId() == QMetaType::ULongLong;
+        const bool unsignedB = b.typeId() == QMetaType::ULongLong;
+        if (unsignedA || unsignedB) {
+            // Negative values first; the rest fit an unsigned compare.
+            const bool negativeA = !unsignedA && a.toLongLong() < 0;
+            const bool negativeB = !unsignedB && b.toLongLong() < 0;
+            if (negativeA || negativeB) {
+                return negativeA && negativeB ? compareOrdered(a.toLongLong(), b.toLongLong()) : (negativeA ? -1 : 1);
+            }
+            return compareOrdered(a.toULongLong(), b.toULongLong());
+        }
+        return compareOrdered(a.toLongLong(), b.toLongLong());
+    }
+    if (integerA) {
+        return compareIntegerVariantToDouble(a, b.toDouble());
+    }
+    if (integerB) {
+        return -compareIntegerVariantToDouble(b, a.toDouble());
+    }
+    return compareDoubles(a.toDouble(), b.toDouble());
+}
+
+// Non-null cells: numbers, booleans and dates by value, anything else as
+// case-insensitive locale text.
+int compareValues(const QVariant& a, const QVariant& b, const QCollator& collator)
+{
+    const int typeA = a.typeId();
+    const int typeB = b.typeId();
+    if (isNumberType(typeA) && isNumberType(typeB)) {
+        return compareNumbers(a, b);
+    }
+    if (typeA == typeB) {
+        switch (typeA) {
+        case QMetaType::Bool:
+            return compareOrdered(a.toBool(), b.toBool());
+        case QMetaType::QDate:
+            return compareOrdered(a.toDate(), b.toDate());
+        case QMetaType::QTime:
+            return compareOrdered(a.toTime(), b.toTime());
+        case QMetaType::QDateTime:
+            return compareOrdered(a.toDateTime(), b.toDateTime());
+        default:
+            break;
+        }
+    }
+    return collator.compare(a.toString(), b.toString());
+}
+
 QString fallbackTypeLabel(Sofa::Core::DataType type)
 {
     switch (type) {
@@ -47,21 +196,233 @@ void DataGridEngine::setSchema(const Sofa::Core::TableSchema& schema)
 
 void DataGridEngine::setData(const std::vector<std::vector<QVariant>>& rows)
 {
-    m_rows = rows;
+    auto page = std::make_shared<Sofa::Core::DatasetPage>();
+    page->columnData.assign(m_schema.columns.size(), Sofa::Core::ColumnData());
+    for (const auto& row : rows) {
+        for (size_t c = 0; c < page->columnData.size(); ++c) {
+            page->columnData[c].appendValue(c < row.size() ? row[c] : QVariant());
+        }
+    }
+    setPage(std::move(page));
+}
+
+void DataGridEngine::setPage(Sofa::Core::DatasetPagePtr page)
+{
+    m_pages.clear();
+    m_pageEnds.clear();
+    m_order.clear();
+    m_rowCount = 0;
+    appendPage(std::move(page));
+}
+
+void DataGridEngine::appendPage(Sofa::Core::DatasetPagePtr page)
+{
+    const int rows = page ? page->rowCount() : 0;
+    if (rows > 0) {
+        m_pages.push_back(std::move(page));
+        if (!m_order.empty()) {
+            m_order.resize(m_rowCount + rows);
+            std::iota(m_order.begin() + m_rowCount, m_order.end(), m_rowCount);
+        }
+        m_rowCount += rows;
+        m_pageEnds.push_back(m_rowCount);
+    }
     emit dataChanged();
 }
 
+Sofa::Core::DatasetPagePtr DataGridEngine::pageFromVariant(const QVariantMap& data) const
+{
+    const QVariant handle = data.value("page");
+    if (handle.metaType() == QMetaType::fromType<Sofa::Core::DatasetPagePtr>()) {
+        return handle.value<Sofa::Core::DatasetPagePtr>();
+    }
+
+    // Rows built in QML (or by the synchronous AppContext calls).
+    const QVariantList rows = data["rows"].toList();
+    const QVariantList nulls = data["nulls"].toList();
+    auto page = std::make_shared<Sofa::Core::DatasetPage>();
+    page->columnData.assign(m_schema.columns.size(), Sofa::Core::ColumnData());
+    for (int r = 0; r < rows.size(); ++r) {
+        const QVariantList rowList = rows[r].toList();
+        const QVariantList nullRowList = r < nulls.size() ? nulls[r].toList() : QVariantList();
+        for (int c = 0; c < static_cast<int>(page->columnData.size()); ++c) {
+            const bool isNull = c < nullRowList.size() && nullRowList[c].toBool();
+            page->columnData[c].appendValue(c < rowList.size() ? cellFromVariant(rowList[c], isNull) : QVariant());
+        }
+    }
+    return page;
+}
+
+std::pair<const Sofa::Core::DatasetPage*, int> DataGridEngine::locate(int row) const
+{
+    const int stored = m_order.empty() ? row : m_order[row];
+    if (m_pages.size() == 1) {
+        return { m_pages.front().get(), stored };
+    }
+    const auto it = std::upper_bound(m_pageEnds.begin(), m_pageEnds.end(), stored);
+    const size_t index = static_cast<size_t>(it - m_pageEnds.begin());
+    const int start = index == 0 ? 0 : m_pageEnds[index - 1];
+    return { m_pages[index].get(), stored - start };
+}
+
 void DataGridEngine::clear()
 {
-    m_rows.clear();
+    m_pages.clear();
+    m_pageEnds.clear();
+    m_order.clear();
+    m_rowCount = 0;
     m_schema.columns.clear();
     emit dataChanged();
     emit layoutChanged();
 }
 
+void DataGridEngine::sortByColumn(int column, bool ascending)
+{
+    if (column < 0 || column >= columnCount() || m_rowCount == 0) {
+        return;
+    }
+
+    // Where each arrival row's cell lives, resolved once instead of per comparison.
+    struct Cell {
+        const Sofa::Core::ColumnData* data = nullptr; // null for row-major pages
+        const Sofa::Core::DatasetPage* page = nullptr;
+        int row = 0;
+        bool isNull = true;
+    };
+    std::vector<Cell> cells;
+    cells.reserve(m_rowCount);
+    for (const auto& page : m_pages) {
+        const bool columnar = column < static_cast<int>(page->columnData.size());
+        for (int r = 0; r < page->rowCount(); ++r) {
+            Cell cell;
+            cell.page = page.get();
+            cell.row = r;
+            if (columnar) {
+                cell.data = &page->columnData[column];
+                cell.isNull = cell.data->isNull(r);
+            } else {
+                cell.isNull = page->value(r, column).isNull();
+            }
+            cells.push_back(cell);
+        }
+    }
+
+    // Numeric columns can arrive as text (numeric is decoded to a string) or
+    // differ in storage between pages: parse once. Whole numbers also keep
+    // their exact value, since a double can't tell bigints apart above 2^53.
+    const bool numericColumn = m_schema.columns[column].isNumeric;
+    std::vector<double> numbers;
+    std::vector<qint64> integers;
+    std::vector<bool> isInteger;
+    if (numericColumn) {
+        numbers.resize(cells.size(), std::numeric_limits<double>::quiet_NaN());
+        integers.resize(cells.size(), 0);
+        isInteger.resize(cells.size(), false);
+        for (size_t i = 0; i < cells.size(); ++i) {
+            const Cell& cell = cells[i];
+            if (cell.isNull) continue;
+            if (cell.data && cell.data->storage() == Sofa::Core::ColumnData::Storage::Int64) {
+                integers[i] = cell.data->int64At(cell.row);
+                isInteger[i] = true;
+                numbers[i] = static_cast<double>(integers[i]);
+                continue;
+            }
+            if (cell.data && cell.data->storage() == Sofa::Core::ColumnData::Storage::Double) {
+                numbers[i] = cell.data->doubleAt(cell.row);
+                continue;
+            }
+            const QVariant value = cell.page->value(cell.row, column);
+            bool ok = false;
+            // Unsigned values past the qint64 range are kept as doubles.
+            if (isIntegerType(value.typeId())
+                && (value.typeId() != QMetaType::ULongLong
+                    || value.toULongLong() <= static_cast<quint64>(std::numeric_limits<qint64>::max()))) {
+                integers[i] = value.toLongLong();
+                isInteger[i] = true;
+                numbers[i] = static_cast<double>(integers[i]);
+                continue;
+            }
+            if (value.typeId() == QMetaType::ULongLong) {
+                numbers[i] = static_cast<double>(value.toULongLong());
+                continue;
+            }
+            const QString text = value.toString();
+            const qint64 integer = text.toLongLong(&ok);
+            if (ok) {
+                integers[i] = integer;
+                isInteger[i] = true;
+                numbers[i] = static_cast<double>(integer);
+                continue;
+            }
+            const double number = text.toDouble(&ok);
+            if (ok) numbers[i] = number;
+        }
+    }
+
+    QCollator collator;
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    auto compareRows = [&](int a, int b) {
+        const Cell& x = cells[a];
+        const Cell& y = cells[b];
+        if (x.isNull || y.isNull) {
+            return x.isNull == y.isNull ? 0 : (x.isNull ? 1 : -1);
+        }
+        if (x.data && y.data && x.data->storage() == y.data->storage()) {
+            switch (x.data->storage()) {
+            case Sofa::Core::ColumnData::Storage::Int64:
+                return compareOrdered(x.data->int64At(x.row), y.data->int64At(y.row));
+            case Sofa::Core::ColumnData::Storage::Double:
+                return compareDoubles(x.data->doubleAt(x.row), y.data->doubleAt(y.row));
+            case Sofa::Core::ColumnData::Storage::Bool:
+                return compareOrdered(x.data->boolAt(x.row), y.data->boolAt(y.row));
+            case Sofa::Core::ColumnData::Storage::Text:
+                if (!numericColumn) {
+                    return collator.compare(x.data->textAt(x.row), y.data->textAt(y.row));
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        // Integers and fractional values compare exactly, so mixing them
+        // keeps a strict weak ordering even past 2^53.
+        if (numericColumn && (isInteger[a] || !std::isnan(numbers[a])) && (isInteger[b] || !std::isnan(numbers[b]))) {
+            if (isInteger[a] && isInteger[b]) {
+                return compareOrdered(integers[a], integers[b]);
+            }
+            if (isInteger[a]) {
+                return compareIntegerToDouble(integers[a], numbers[b]);
+            }
+            if (isInteger[b]) {
+                return -compareIntegerToDouble(integers[b], numbers[a]);
+            }
+            return compareOrdered(numbers[a], numbers[b]);
+        }
+        return compareValues(x.page->value(x.row, column), y.page->value(y.row, column), collator);
+    };
+
+    std::vector<int> order(m_rowCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        const int cmp = compareRows(a, b);
+        return ascending ? cmp < 0 : cmp > 0;
+    });
+    m_order = std::move(order);
+    emit dataChanged();
+}
+
+void DataGridEngine::clearSort()
+{
+    if (m_order.empty()) {
+        return;
+    }
+    m_order.clear();
+    emit dataChanged();
+}
+
 int DataGridEngine::rowCount() const
 {
-    return static_cast<int>(m_rows.size());
+    return m_rowCount;
 }
 
 int DataGridEngine::columnCount() const
@@ -102,11 +463,9 @@ void DataGridEngine::setColumnDisplayWidth(int index, int width)
 
 QVariant DataGridEngine::getData(int row, int col) const
 {
-    if (row >= 0 && row < m_rows.size()) {
-        const auto& r = m_rows[row];
-        if (col >= 0 && col < r.size()) {
-            return r[col];
-        }
+    if (row >= 0 && row < m_rowCount && col >= 0 && col < columnCount()) {
+        const auto [page, pageRow] = locate(row);
+        return page->value(pageRow, col);
     }
     return QVariant();
 }
@@ -191,10 +550,11 @@ bool DataGridEngine::getColumnIsMultilineInput(int index) const
 QVariantList DataGridEngine::getRow(int row) const
 {
     QVariantList list;
-    if (row >= 0 && row < m_rows.size()) {
-        const auto& r = m_rows[row];
-        for (const auto& val : r) {
-            list.append(val);
+    if (row >= 0 && row < m_rowCount) {
+        const auto [page, pageRow] = locate(row);
+        list.reserve(columnCount());
+        for (int c = 0; c < columnCount(); ++c) {
+            list.append(page->value(pageRow, c));
         }
     }
     return list;
@@ -280,56 +640,32 @@ void DataGridEngine::loadFromVariant(const QVariantMap& data)
     
     qInfo() << "\x1b[36m📏 DataGrid Layout\x1b[0m Cols:" << schema.columns.size() << "TotalWidth:" << totalWidth();
     
-    QVariantList rows = data["rows"].toList();
-    QVariantList nulls = data["nulls"].toList();
-    qInfo() << "\x1b[35m🧪 DataGrid rows payload\x1b[0m total:" << rows.size();
-    std::vector<std::vector<QVariant>> newRows;
-    int rowIndex = 0;
-    for (const auto& r : rows) {
-        QVariantList rowList = r.toList();
-        QVariantList nullRowList;
-        if (rowIndex < nulls.size()) {
-            nullRowList = nulls[rowIndex].toList();
-        }
-        std::vector<QVariant> newRow;
-        int colIndex = 0;
-        for (const auto& val : rowList) {
-            QVariant finalVal = val;
-            if (colIndex < nullRowList.size() && nullRowList[colIndex].toBool()) {
-                finalVal = QVariant();
-            } else if (val.userType() == QMetaType::QJsonValue) {
-                QJsonValue jv = val.toJsonValue();
-                if (jv.isNull() || jv.isUndefined()) {
-                    finalVal = QVariant();
-                } else {
-                    finalVal = jv.toVariant();
-                }
-            }
-            newRow.push_back(finalVal);
-            colIndex++;
-        }
-        newRows.push_back(newRow);
-        
-        if (rowIndex < 3) {
-            QStringList debugVals;
-            for (const auto& v : newRow) {
-                QString valStr = v.toString();
-                QString display;
-                if (v.isNull()) display = "NULL";
-                else if (valStr.isEmpty()) display = "EMPTY";
-                else if (v.userType() == QMetaType::QString && valStr.trimmed().isEmpty()) display = "WHITESPACE";
-                else display = valStr;
-                QString suffix;
-                if (v.userType() == QMetaType::QString) {
-                    suffix = " len=" + QString::number(valStr.size());
-                }
-                debugVals << (QString(v.typeName()) + "(" + (v.isNull() ? "null" : "valid") + "):" + display + suffix);
+    setPage(pageFromVariant(data));
+    
+    for (int rowIndex = 0; rowIndex < std::min(m_rowCount, 3); ++rowIndex) {
+        QStringList debugVals;
+        for (int c = 0; c < columnCount(); ++c) {
+            const QVariant v = getData(rowIndex, c);
+            QString valStr = v.toString();
+            QString display;
+            if (v.isNull()) display = "NULL";
+            else if (valStr.isEmpty()) display = "EMPTY";
+            else if (v.userType() == QMetaType::QString && valStr.trimmed().isEmpty()) display = "WHITESPACE";
+            else display = valStr;
+            QString suffix;
+            if (v.userType() == QMetaType::QString) {
+                suffix = " len=" + QString::number(valStr.size());
             }
-            qInfo() << "\x1b[35m🧪 DataGrid row\x1b[0m" << rowIndex << "cols:" << rowList.size() << debugVals.join(" | ");
+            debugVals << (QString(v.typeName()) + "(" + (v.isNull() ? "null" : "valid") + "):" + display + suffix);
         }
-        rowIndex++;
+        qInfo() << "\x1b[35m🧪 DataGrid row\x1b[0m" << rowIndex << debugVals.join(" | ");
     }
-    setData(newRows);
-    qInfo() << "\x1b[32m✅ DataGrid\x1b[0m colunas:" << columns.size() << "linhas:" << rows.size() << "rowsStored:" << newRows.size();
+    qInfo() << "\x1b[32m✅ DataGrid\x1b[0m colunas:" << columns.size() << "linhas:" << m_rowCount << "páginas:" << m_pages.size();
 }
+
+void DataGridEngine::appendFromVariant(const QVariantMap& data)
+{
+    appendPage(pageFromVariant(data));
+}
+
 }
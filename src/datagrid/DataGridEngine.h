@@ -2,6 +2,7 @@
 #include <QObject>
 #include <vector>
 #include <memory>
+#include <utility>
 #include <QVariantMap>
 #include <QVariantList>
 #include <QString>
@@ -18,10 +19,21 @@ public:
     explicit DataGridEngine(QObject* parent = nullptr);
     
     // Data Management
+    // Results from AppContext carry their values as a shared DatasetPage
+    // ("page"), which is adopted as is; "rows"/"nulls" lists are still parsed.
     Q_INVOKABLE void loadFromVariant(const QVariantMap& data);
+    // Adds the rows of a streamed batch, keeping the current columns.
+    Q_INVOKABLE void appendFromVariant(const QVariantMap& data);
     void setSchema(const Sofa::Core::TableSchema& schema);
     void setData(const std::vector<std::vector<QVariant>>& rows);
+    void setPage(Sofa::Core::DatasetPagePtr page);
+    void appendPage(Sofa::Core::DatasetPagePtr page);
     Q_INVOKABLE void clear();
+
+    // Reorders the loaded rows for display (NULLs last when ascending); the
+    // pages stay untouched. Rows appended later go after the sorted ones.
+    Q_INVOKABLE void sortByColumn(int column, bool ascending);
+    Q_INVOKABLE void clearSort();
     
     // Accessors
     int rowCount() const;
@@ -49,8 +61,16 @@ signals:
     void layoutChanged();
     
 private:
+    Sofa::Core::DatasetPagePtr pageFromVariant(const QVariantMap& data) const;
+    // The page holding display row `row` and the row's index within it.
+    std::pair<const Sofa::Core::DatasetPage*, int> locate(int row) const;
+
     Sofa::Core::TableSchema m_schema;
-    std::vector<std::vector<QVariant>> m_rows;
+    // Loaded pages in arrival order, shared with whoever produced them.
+    std::vector<Sofa::Core::DatasetPagePtr> m_pages;
+    std::vector<int> m_pageEnds; // row count up to and including each page
+    std::vector<int> m_order;    // display row -> arrival row; empty when unsorted
+    int m_rowCount = 0;
 };
 
 }
@@ -14,99 +14,31 @@ Rectangle {
     
     // --- Logic ---
 
-    function appendSchema(targetModel, schemaName) {
-        targetModel.append({
-            "type": "schema",
-            "name": schemaName,
-            "expanded": false,
-            "tables": []
-        })
-    }
-
-    function refresh() {
-        schemaModel.clear()
-        hiddenSchemaModel.clear()
-        
-        // Safety check
-        if (currentConnectionId === -1) return
-
-        var list = App.getSchemas()
-        for (var i = 0; i < list.length; i++) {
-            appendSchema(schemaModel, list[i])
-        }
-        
-        var hiddenList = App.getHiddenSchemas()
-        if (hiddenList.length > 0) {
-            for (var j = 0; j < hiddenList.length; j++) {
-                appendSchema(hiddenSchemaModel, hiddenList[j])
-            }
-            schemaModel.append({
-                "type": "group",
-                "name": "Hidden Schemas",
-                "expanded": false
-            })
-        }
-        
-        // Auto-expand "public" schema if present
-        for (var i = 0; i < schemaModel.count; i++) {
-            var item = schemaModel.get(i)
-            if (item.type === "schema" && item.name === "public") {
-                toggleSchemaAt(schemaModel, i)
-                break
-            }
-        }
-    }
-    
-    function toggleSchemaAt(model, index) {
-        var item = model.get(index)
-        if (item.expanded) {
-            item.expanded = false
-        } else {
-            // Fetch tables
-            var tables = App.getTables(item.name)
-            var rows = []
-            for (var i = 0; i < tables.length; i++) {
-                var tableData = tables[i]
-                if (typeof tableData === "string") {
-                    rows.push({
-                        "name": tableData,
-                        "hasPrimaryKey": false
-                    })
-                } else {
-                    rows.push({
-                        "name": tableData.name || "",
-                        "hasPrimaryKey": !!tableData.hasPrimaryKey
-                    })
-                }
-            }
-            item.tables = rows
-            item.expanded = true
-        }
-    }
-
-    function toggleGroupAt(index) {
-        var item = schemaModel.get(index)
-        if (item) {
-            item.expanded = !item.expanded
-        }
-    }
-    
+    // The tree lives in App.catalogModel (C++): only visible rows get a
+    // delegate, and a schema's tables are requested when it is first expanded.
     Connections {
         target: App
         function onConnectionOpened(id) {
             currentConnectionId = id
-            refresh()
         }
         function onConnectionClosed() {
             currentConnectionId = -1
-            schemaModel.clear()
+        }
+    }
+
+    Connections {
+        target: App.catalogModel
+        // Auto-expand "public" when a connection's schemas first show up
+        function onSchemasLoaded(initial) {
+            if (!initial) return
+            var row = treeView.rowAtIndex(App.catalogModel.schemaIndex("public"))
+            if (row !== -1) treeView.expand(row)
         }
     }
 
     Component.onCompleted: {
         if (App.activeConnectionId !== -1) {
             currentConnectionId = App.activeConnectionId
-            refresh()
         }
     }
 
@@ -156,7 +88,7 @@ Rectangle {
     readonly property color connectionAccentColor: App.activeConnectionId === -1 ? Theme.accent : getAvatarColor(activeConnectionName, activeConnectionColor)
 
     component ExplorerRow : Rectangle {
-        id: row
+        id: explorerRow
         property string label
         property string icon
         property bool isExpanded: false
@@ -204,10 +136,10 @@ Rectangle {
                     anchors.centerIn: parent
                     visible: !iconRoot.isSvg
                     text: icon
-                    color: row.iconColor
+                    color: explorerRow.iconColor
                     font.pixelSize: 12
                     horizontalAlignment: Text.AlignHCenter
-                    opacity: row.iconOpacity
+                    opacity: explorerRow.iconOpacity
                 }
                 
                 Item {
@@ -230,8 +162,8 @@ Rectangle {
                         anchors.fill: svgIcon
                         source: svgIcon
                         visible: iconRoot.isSvg
-                        color: row.iconColor
-                        opacity: row.iconOpacity
+                        color: explorerRow.iconColor
+                        opacity: explorerRow.iconOpacity
                     }
                 }
             }
@@ -239,7 +171,7 @@ Rectangle {
             // Label
             Text {
                 text: label
-                color: row.isDimmed ? Theme.textSecondary : Theme.textPrimary
+                color: explorerRow.isDimmed ? Theme.textSecondary : Theme.textPrimary
                 font.pixelSize: 13
                 Layout.fillWidth: true
                 elide: Text.ElideRight
@@ -251,7 +183,7 @@ Rectangle {
             anchors.fill: parent
             hoverEnabled: true
             cursorShape: Qt.PointingHandCursor
-            onClicked: row.clicked()
+            onClicked: explorerRow.clicked()
         }
     }
 
@@ -293,105 +225,54 @@ Rectangle {
                         anchors.fill: parent
                         hoverEnabled: true
                         cursorShape: Qt.PointingHandCursor
-                        onClicked: root.refresh()
+                        onClicked: App.catalogModel.reload()
                     }
                 }
             }
         }
         
         // Content
-        ListView {
+        TreeView {
             id: treeView
             Layout.fillWidth: true
             Layout.fillHeight: true
             visible: currentConnectionId !== -1
             clip: true
-            model: schemaModel
+            model: App.catalogModel
             boundsBehavior: Flickable.StopAtBounds
+            columnWidthProvider: function(column) { return treeView.width }
             
-            delegate: Column {
-                id: schemaDelegate
-                property string schemaName: model.name
-                property bool isGroup: model.type === "group"
-                property bool isExpanded: model.expanded
-                property var tableList: model.tables
-                width: ListView.view.width
-                
-                // 1. Schema / Group Row
-                ExplorerRow {
-                    label: schemaDelegate.isGroup ? "Hidden Schemas" : model.name
-                    icon: schemaDelegate.isGroup ? "assets/eye-slash-solid-full.svg" : "assets/folder-tree-solid-full.svg" 
-                    iconColor: schemaDelegate.isGroup ? "#FFF9E6" : root.connectionAccentColor
-                    iconOpacity: schemaDelegate.isGroup ? 0.7 : 1.0
-                    isExpandable: true
-                    isExpanded: schemaDelegate.isExpanded
-                    level: 0
-                    isDimmed: schemaDelegate.isGroup
-                    onClicked: {
-                        if (schemaDelegate.isGroup) root.toggleGroupAt(index)
-                        else root.toggleSchemaAt(schemaModel, index)
-                    }
-                }
-                
-                // 2. Tables (for regular Schema)
-                Repeater {
-                    model: (!schemaDelegate.isGroup && isExpanded) ? tableList : null
-                    delegate: ExplorerRow {
-                        label: name
-                        icon: "assets/table-list-solid-full.svg"
-                        iconColor: "#FFFFFF"
-                        iconOpacity: 0.7
-                        level: 1
-                        onClicked: {
-                            console.log("\u001b[35m🗂️ Abrindo tabela\u001b[0m", schemaDelegate.schemaName + "." + name)
-                            root.tableClicked(schemaDelegate.schemaName, name)
-                        }
-                    }
-                }
+            delegate: ExplorerRow {
+                id: node
+                required property TreeView treeView
+                required property bool expanded
+                required property bool hasChildren
+                required property int depth
+                required property int row
+                required property string name
+                required property string nodeType
+                required property string schema
+                required property bool hidden
+                readonly property bool isGroup: nodeType === "group"
+                readonly property bool isTable: nodeType === "table"
 
-                // 3. Hidden Schemas (for Group)
-                Column {
-                    width: parent.width
-                    visible: schemaDelegate.isGroup && isExpanded
-                    
-                    Repeater {
-                        model: hiddenSchemaModel
-                        delegate: Column {
-                            id: hiddenSchemaDelegate
-                            property string schemaName: name
-                            width: parent.width
-                            property bool isExpanded: expanded
-                            property var tableList: tables
-                            
-                            // Hidden Schema Row
-                            ExplorerRow {
-                                label: name
-                                icon: "assets/folder-tree-solid-full.svg"
-                                iconColor: Theme.textSecondary
-                                isExpandable: true
-                                isExpanded: hiddenSchemaDelegate.isExpanded
-                                level: 1
-                                isDimmed: true
-                                onClicked: root.toggleSchemaAt(hiddenSchemaModel, index)
-                            }
-                            
-                            // Tables in Hidden Schema
-                            Repeater {
-                                model: isExpanded ? tableList : null
-                                delegate: ExplorerRow {
-                                    label: name
-                                    icon: "assets/table-list-solid-full.svg"
-                                    iconColor: "#FFFFFF"
-                                    iconOpacity: 0.7
-                                    level: 2
-                                    isDimmed: true
-                                    onClicked: {
-                                        console.log("\u001b[35m🗂️ Abrindo tabela oculta\u001b[0m", hiddenSchemaDelegate.schemaName + "." + name)
-                                        root.tableClicked(hiddenSchemaDelegate.schemaName, name)
-                                    }
-                                }
-                            }
-                        }
+                label: name
+                icon: isGroup ? "assets/eye-slash-solid-full.svg" : (isTable ? "assets/table-list-solid-full.svg" : "assets/folder-tree-solid-full.svg")
+                iconColor: isGroup ? "#FFF9E6" : (isTable ? "#FFFFFF" : (hidden ? Theme.textSecondary : root.connectionAccentColor))
+                iconOpacity: (isGroup || isTable) ? 0.7 : 1.0
+                isExpandable: hasChildren
+                isExpanded: expanded
+                level: depth
+                isDimmed: hidden
+                onClicked: {
+                    if (!isTable) {
+                        treeView.toggleExpanded(row)
+                    } else if (hidden) {
+                        console.log("\u001b[35m🗂️ Abrindo tabela oculta\u001b[0m", schema + "." + name)
+                        root.tableClicked(schema, name)
+                    } else {
+                        console.log("\u001b[35m🗂️ Abrindo tabela\u001b[0m", schema + "." + name)
+                        root.tableClicked(schema, name)
                     }
                 }
             }
@@ -469,7 +350,4 @@ Rectangle {
             }
         }
     }
-    
-    ListModel { id: schemaModel }
-    ListModel { id: hiddenSchemaModel }
 }
@@ -0,0 +1,174 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+import sofa.ui
+
+// Quick open (Ctrl+P): fuzzy search over the active connection's tables,
+// columns and indexes, answered by App.catalogSearch.
+Popup {
+    id: root
+    width: 560
+    readonly property real searchAreaHeight: 40
+    readonly property real dividerHeight: 1
+    readonly property real listAreaHeight: Math.min(resultsList.contentHeight, 400)
+    height: searchAreaHeight + dividerHeight + listAreaHeight
+    x: (parent.width - width) / 2
+    y: 40
+    padding: 0
+    modal: true
+    focus: true
+    closePolicy: Popup.CloseOnEscape | Popup.CloseOnPressOutside
+
+    // kind: "table", "column" or "index"
+    signal objectSelected(string kind, string schema, string table)
+
+    background: Rectangle {
+        color: Theme.surface
+        border.color: Theme.border
+        border.width: 1
+        radius: 6
+    }
+
+    function selectCurrent() {
+        var item = resultsList.currentItem
+        if (!item) return
+        root.objectSelected(item.kind, item.schema, item.table)
+        root.close()
+    }
+
+    function kindIcon(kind) {
+        if (kind === "column") return "assets/hashtag-solid-full.svg"
+        if (kind === "index") return "assets/key-solid-full.svg"
+        return "assets/table-list-solid-full.svg"
+    }
+
+    onOpened: {
+        filterInput.text = ""
+        App.catalogSearch.query = ""
+        // Schemas the explorer hasn't opened yet are indexed in the background.
+        App.catalogSearch.loadCatalog()
+        filterInput.forceActiveFocus()
+    }
+
+    ColumnLayout {
+        width: parent.width
+        spacing: 0
+
+        // Search Input
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.preferredHeight: root.searchAreaHeight
+            color: "transparent"
+
+            TextField {
+                id: filterInput
+                anchors.fill: parent
+                anchors.margins: 6
+                placeholderText: "Go to table, column or index..."
+                color: Theme.textPrimary
+                font.pixelSize: 14
+                background: Rectangle {
+                    color: Theme.background
+                    border.color: Theme.border
+                    radius: 4
+                }
+
+                onTextChanged: {
+                    App.catalogSearch.query = text
+                    resultsList.currentIndex = resultsList.count > 0 ? 0 : -1
+                }
+
+                Keys.onDownPressed: resultsList.incrementCurrentIndex()
+                Keys.onUpPressed: resultsList.decrementCurrentIndex()
+                Keys.onEnterPressed: root.selectCurrent()
+                Keys.onReturnPressed: root.selectCurrent()
+            }
+        }
+
+        Rectangle {
+            Layout.fillWidth: true
+            height: root.dividerHeight
+            color: Theme.border
+        }
+
+        ListView {
+            id: resultsList
+            Layout.fillWidth: true
+            Layout.preferredHeight: root.listAreaHeight
+            model: App.catalogSearch
+            clip: true
+            boundsBehavior: Flickable.StopAtBounds
+            highlightMoveDuration: 0
+
+            delegate: Rectangle {
+                id: resultRow
+                required property int index
+                required property string name
+                required property string kind
+                required property string schema
+                required property string table
+                required property string text
+                width: resultsList.width
+                height: 40
+                color: ListView.isCurrentItem || hoverHandler.hovered ? Theme.surfaceHighlight : "transparent"
+
+                HoverHandler {
+                    id: hoverHandler
+                }
+
+                MouseArea {
+                    anchors.fill: parent
+                    cursorShape: Qt.PointingHandCursor
+                    onClicked: {
+                        resultsList.currentIndex = resultRow.index
+                        root.selectCurrent()
+                    }
+                }
+
+                RowLayout {
+                    anchors.fill: parent
+                    anchors.leftMargin: 12
+                    anchors.rightMargin: 12
+                    spacing: 10
+
+                    Image {
+                        Layout.preferredWidth: 14
+                        Layout.preferredHeight: 14
+                        source: root.kindIcon(resultRow.kind)
+                        sourceSize.width: 14
+                        sourceSize.height: 14
+                        opacity: 0.7
+                    }
+
+                    ColumnLayout {
+                        Layout.fillWidth: true
+                        Layout.alignment: Qt.AlignVCenter
+                        spacing: 0
+
+                        Text {
+                            text: resultRow.name
+                            color: Theme.textPrimary
+                            font.pixelSize: 13
+                            Layout.fillWidth: true
+                            elide: Text.ElideRight
+                        }
+
+                        Text {
+                            text: resultRow.text
+                            color: Theme.textSecondary
+                            font.pixelSize: 11
+                            Layout.fillWidth: true
+                            elide: Text.ElideMiddle
+                        }
+                    }
+
+                    Text {
+                        text: resultRow.kind
+                        color: Theme.textSecondary
+                        font.pixelSize: 11
+                    }
+                }
+            }
+        }
+    }
+}
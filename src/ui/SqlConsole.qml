@@ -1,5 +1,6 @@
 import QtQuick
 import QtQuick.Controls
+import QtQuick.Dialogs
 import QtQuick.Layouts
 import sofa.ui
 import sofa.datagrid 1.0
@@ -12,12 +13,15 @@ Item {
     property bool gridControlsVisible: true
     property string statusText: "Ready"
     property string errorMessage: ""
-    property string requestTag: "sql"
+    property string requestTag: ""
+    property string exportRequestTag: ""
+    property bool exporting: false
     property string queryText: "SELECT * FROM users LIMIT 10;"
     property int sortColumnIndex: -1
     property bool sortAscending: true
     property bool sortActive: false
     property var lastResult: ({})
+    property int streamedRows: 0
     readonly property color activeConnectionColor: {
         var id = App.activeConnectionId
         if (id === -1) return Theme.accent
@@ -31,6 +35,12 @@ Item {
     }
     signal queryTextEdited(string text)
 
+    // Closing the tab must not leave its statement running on the server.
+    Component.onDestruction: {
+        if (root.requestTag.length > 0) App.cancelRequest(root.requestTag, false)
+        if (root.exporting) App.cancelRequest(root.exportRequestTag, false)
+    }
+
     function setQueryText(text) {
         if (root.queryText !== text) {
             root.queryText = text
@@ -43,87 +53,6 @@ Item {
         root.sortActive = false
     }
 
-    function parseDateMs(value) {
-        if (value === null || value === undefined) return NaN
-        var parsed = Date.parse(String(value))
-        return isNaN(parsed) ? NaN : parsed
-    }
-
-    function compareCellValues(a, b, ascending) {
-        var aNull = (a === null || a === undefined)
-        var bNull = (b === null || b === undefined)
-        if (aNull || bNull) {
-            if (aNull && bNull) return 0
-            if (ascending) return aNull ? 1 : -1
-            return aNull ? -1 : 1
-        }
-
-        if (typeof a === "number" && typeof b === "number") {
-            return ascending ? (a - b) : (b - a)
-        }
-
-        if (typeof a === "boolean" && typeof b === "boolean") {
-            if (a === b) return 0
-            var boolCmp = a ? 1 : -1
-            return ascending ? boolCmp : -boolCmp
-        }
-
-        var aDate = parseDateMs(a)
-        var bDate = parseDateMs(b)
-        if (!isNaN(aDate) && !isNaN(bDate)) {
-            return ascending ? (aDate - bDate) : (bDate - aDate)
-        }
-
-        var aText = String(a).toLocaleLowerCase()
-        var bText = String(b).toLocaleLowerCase()
-        var textCmp = aText.localeCompare(bText)
-        return ascending ? textCmp : -textCmp
-    }
-
-    function sortLocalResult(columnIndex, ascending) {
-        if (!root.lastResult || !root.lastResult.columns || columnIndex < 0) {
-            return null
-        }
-
-        var rows = root.lastResult.rows ? root.lastResult.rows.slice(0) : []
-        var nulls = root.lastResult.nulls ? root.lastResult.nulls.slice(0) : []
-        var zipped = []
-        for (var i = 0; i < rows.length; i++) {
-            zipped.push({
-                row: rows[i],
-                nullRow: i < nulls.length ? nulls[i] : []
-            })
-        }
-
-        zipped.sort(function(left, right) {
-            var leftRow = left.row || []
-            var rightRow = right.row || []
-            var leftNullRow = left.nullRow || []
-            var rightNullRow = right.nullRow || []
-            var leftVal = columnIndex < leftRow.length ? leftRow[columnIndex] : null
-            var rightVal = columnIndex < rightRow.length ? rightRow[columnIndex] : null
-            var leftIsNull = (columnIndex < leftNullRow.length && leftNullRow[columnIndex] === true) || leftVal === null || leftVal === undefined
-            var rightIsNull = (columnIndex < rightNullRow.length && rightNullRow[columnIndex] === true) || rightVal === null || rightVal === undefined
-            return compareCellValues(leftIsNull ? null : leftVal, rightIsNull ? null : rightVal, ascending)
-        })
-
-        var sortedRows = []
-        var sortedNulls = []
-        for (var j = 0; j < zipped.length; j++) {
-            sortedRows.push(zipped[j].row)
-            sortedNulls.push(zipped[j].nullRow)
-        }
-
-        return {
-            "columns": root.lastResult.columns,
-            "rows": sortedRows,
-            "nulls": sortedNulls,
-            "executionTime": root.lastResult.executionTime,
-            "warning": root.lastResult.warning,
-            "hasMore": root.lastResult.hasMore
-        }
-    }
-    
     // SplitView for Editor (top) and Results (bottom)
     SplitView {
         anchors.fill: parent
@@ -167,11 +96,34 @@ Item {
                             enabled: root.running
                             onClicked: {
                                 if (root.running) {
-                                    App.cancelActiveQuery()
+                                    App.cancelRequest(root.requestTag)
                                 }
                             }
                         }
                         
+                        AppButton {
+                            text: root.exporting ? "Stop export" : "Export"
+                            isOutline: true
+                            accentColor: root.activeConnectionColor
+                            enabled: root.exporting || queryEditor.text.trim().length > 0
+                            onClicked: {
+                                if (root.exporting) {
+                                    App.cancelRequest(root.exportRequestTag)
+                                    return
+                                }
+                                exportFileDialog.open()
+                            }
+
+                            FileDialog {
+                                id: exportFileDialog
+                                title: "Export query result"
+                                fileMode: FileDialog.SaveFile
+                                defaultSuffix: "csv"
+                                nameFilters: ["CSV files (*.csv)", "JSON Lines (*.jsonl *.ndjson)", "SQL INSERT statements (*.sql)"]
+                                onAccepted: root.runExport(selectedFile)
+                            }
+                        }
+
                         Label {
                             text: "(Cmd+Enter)"
                             color: Theme.textSecondary
@@ -200,14 +152,27 @@ Item {
                         padding: 10
                         text: root.queryText
                         
-                        Keys.onPressed: (event) => {
+                        // Streams the whole result of the editor's statement to a file; it never
+    // goes through the grid, so the row limits don't apply.
+    function runExport(fileUrl) {
+        var path = fileUrl.toString()
+        var lower = path.toLowerCase()
+        var format = lower.endsWith(".jsonl") || lower.endsWith(".ndjson") ? "jsonl"
+            : lower.endsWith(".sql") ? "sql" : "csv"
+        root.errorMessage = ""
+        root.statusText = "Exporting..."
+        root.exportRequestTag = "export:" + Date.now()
+        root.exporting = App.exportAsync({ sql: queryEditor.text }, path, { format: format }, root.exportRequestTag)
+    }
+
+    Keys.onPressed: (event) => {
                             if ((event.key === Qt.Key_Return || event.key === Qt.Key_Enter) && (event.modifiers & Qt.ControlModifier || event.modifiers & Qt.MetaModifier)) {
                                 runQuery();
                                 event.accepted = true;
                             }
                             if (event.key === Qt.Key_Escape) {
                                 if (root.running) {
-                                    App.cancelActiveQuery();
+                                    App.cancelRequest(root.requestTag);
                                     event.accepted = true;
                                 }
                             }
@@ -256,19 +221,18 @@ Item {
                         sortedColumnIndex: root.sortActive ? root.sortColumnIndex : -1
                         sortAscending: root.sortAscending
                         onSortRequested: (columnIndex, ascending) => {
-                            var sorted = root.sortLocalResult(columnIndex, ascending)
-                            if (!sorted) return
+                            if (!root.lastResult || !root.lastResult.columns || columnIndex < 0) return
                             root.sortColumnIndex = columnIndex
                             root.sortAscending = ascending
                             root.sortActive = true
-                            gridEngine.loadFromVariant(sorted)
+                            gridEngine.sortByColumn(columnIndex, ascending)
                         }
                     }
 
                     Rectangle {
                         anchors.fill: parent
                         color: "transparent"
-                        visible: root.running || root.errorMessage.length > 0
+                        visible: (root.running && root.streamedRows === 0) || root.errorMessage.length > 0
 
                         Text {
                             anchors.centerIn: parent
@@ -323,8 +287,9 @@ Item {
         root.resetSortState()
         root.errorMessage = ""
         root.empty = false
+        root.streamedRows = 0
         root.statusText = "Running..."
-        root.requestTag = "sql"
+        root.requestTag = "sql:" + Date.now()
         var ok = App.runQueryAsync(query, root.requestTag)
         if (!ok) {
             root.running = false
@@ -340,7 +305,7 @@ Item {
         }
         if (event.key === Qt.Key_Escape) {
             if (root.running) {
-                App.cancelActiveQuery();
+                App.cancelRequest(root.requestTag);
                 event.accepted = true;
             }
         }
@@ -351,22 +316,48 @@ Item {
         function onSqlStarted(tag) {
             if (tag !== root.requestTag) return;
             root.running = true
+            root.streamedRows = 0
             root.statusText = "Running..."
             root.errorMessage = ""
         }
+        function onSqlBatch(tag, batch) {
+            if (tag !== root.requestTag) return;
+            if (batch.reset) {
+                root.lastResult = batch
+                root.resetSortState()
+                root.streamedRows = batch.rowCount || 0
+                gridEngine.loadFromVariant(batch)
+            } else {
+                root.streamedRows += batch.rowCount || 0
+                gridEngine.appendFromVariant(batch)
+            }
+            root.empty = root.streamedRows === 0
+            root.statusText = "Running... " + root.streamedRows + " rows"
+        }
         function onSqlFinished(tag, result) {
             if (tag !== root.requestTag) return;
             root.running = false
             root.errorMessage = ""
-            root.lastResult = result
-            root.resetSortState()
-            if (result && result.rows && result.rows.length === 0) {
-                root.empty = true
+            if (result.streamed) {
+                // Rows already arrived through onSqlBatch.
+                root.lastResult.executionTime = result.executionTime
+                root.lastResult.warning = result.warning
+                root.lastResult.hasMore = result.hasMore
+                root.empty = result.rowCount === 0
             } else {
-                root.empty = false
+                root.lastResult = result
+                root.resetSortState()
+                if (result && result.rowCount === 0) {
+                    root.empty = true
+                } else {
+                    root.empty = false
+                }
+                gridEngine.loadFromVariant(result)
             }
-            gridEngine.loadFromVariant(result)
             var msg = "Done."
+            if (result.streamed) {
+                msg += " Rows: " + result.rowCount + (result.hasMore ? "+" : "");
+            }
             if (result.executionTime) {
                 msg += " Time: " + result.executionTime + "ms";
             }
@@ -393,5 +384,25 @@ Item {
             root.errorMessage = "Query cancelada."
             root.statusText = "Canceled"
         }
+        function onExportProgress(tag, progress) {
+            if (tag !== root.exportRequestTag) return;
+            root.statusText = "Exporting... " + Math.round(progress.rows) + " rows · " + Math.round(progress.rowsPerSecond) + " rows/s"
+        }
+        function onExportFinished(tag, result) {
+            if (tag !== root.exportRequestTag) return;
+            root.exporting = false
+            root.statusText = "Exported " + result.rows + " rows in " + Math.round(result.executionTime) + " ms to " + result.filePath
+        }
+        function onExportError(tag, error) {
+            if (tag !== root.exportRequestTag) return;
+            root.exporting = false
+            root.errorMessage = error
+            root.statusText = "Export failed: " + error
+        }
+        function onExportCanceled(tag) {
+            if (tag !== root.exportRequestTag) return;
+            root.exporting = false
+            root.statusText = "Export canceled"
+        }
     }
 }